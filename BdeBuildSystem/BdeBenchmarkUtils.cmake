@@ -0,0 +1,189 @@
+include_guard(GLOBAL)
+
+#[[.rst:
+BdeBenchmarkUtils
+-----------------
+This module provide a set of function to generate benchmark drivers for BDE
+components.
+
+A benchmark driver ``<component>.b.cpp`` is a Google Benchmark program.  It is
+built (with optimization forced on) into the ``<component>.b`` executable in
+the ``benchmarks`` directory of the build and added as a test labeled
+``benchmark``.  The test runs the driver through ``bbs_benchmark``, which
+writes the results to ``benchmarks/<component>.json`` and, if
+``BBS_BENCHMARK_BASELINE_DIR`` contains a ``<component>.json`` baseline, fails
+when a benchmark is more than ``BBS_BENCHMARK_THRESHOLD`` percent slower than
+its baseline.  The benchmark drivers are not built by ``all.t``, use the
+``all.b`` (or ``<package>.b``) target and run them with ``ctest -L benchmark``.
+#]]
+
+find_file(BBS_BENCHMARK_PATH bbs_benchmark.py
+          PATHS "${CMAKE_CURRENT_LIST_DIR}/scripts")
+
+if (NOT BBS_BENCHMARK_PATH)
+    message(FATAL_ERROR "Failed to find bbs_benchmark")
+endif()
+
+set(BBS_BENCHMARK ${Python3_EXECUTABLE} ${BBS_BENCHMARK_PATH} CACHE INTERNAL "")
+
+if (MSVC)
+    set(_bbs_benchmark_opt_flags "/O2")
+else()
+    set(_bbs_benchmark_opt_flags "-O2")
+endif()
+
+set(BBS_BENCHMARK_OPT_FLAGS "${_bbs_benchmark_opt_flags}" CACHE STRING
+    "Compiler flags forcing the optimization of the benchmark drivers in non-optimized builds")
+
+set(BBS_BENCHMARK_BASELINE_DIR "" CACHE PATH
+    "Directory of the '<component>.json' baseline results the benchmarks are compared against")
+
+set(BBS_BENCHMARK_THRESHOLD "10" CACHE STRING
+    "Slowdown in percent over the baseline reported as a benchmark regression")
+
+set(BBS_BENCHMARK_REPETITIONS "5" CACHE STRING
+    "Number of repetitions of each benchmark, the median of which is reported")
+
+#[[.rst:
+.. command:: bbs_add_bde_style_benchmark
+
+Add the benchmark [executable] ``target.b`` as a test and create ctest labels
+for it.  Every test gets the ``benchmark`` label and the ``<label>.b`` label
+for each of the ``LABELS`` (but not the ``LABELS`` themselves, so that the
+benchmarks are not selected with the tests), and runs serially, so that the
+measurements are not disturbed by other tests.
+
+.. code-block:: cmake
+
+   bbs_add_bde_style_benchmark(target
+                              [ WORKING_DIRECTORY     dir       ]
+                              [ EXTRA_ARGS            args ...  ]
+                              [ LABELS                label ... ]
+                             )
+
+#]]
+function(bbs_add_bde_style_benchmark target)
+    cmake_parse_arguments(""
+                          ""
+                          "WORKING_DIRECTORY"
+                          "EXTRA_ARGS;LABELS"
+                          ${ARGN})
+    bbs_assert_no_unparsed_args("")
+
+    if (NOT _WORKING_DIRECTORY)
+        set(_WORKING_DIRECTORY "${CMAKE_CURRENT_BINARY_DIR}")
+    endif()
+
+    set(args --json "${CMAKE_BINARY_DIR}/benchmarks/${target}.json"
+             --repetitions ${BBS_BENCHMARK_REPETITIONS}
+             --threshold ${BBS_BENCHMARK_THRESHOLD})
+    if (BBS_BENCHMARK_BASELINE_DIR)
+        list(APPEND args --baseline "${BBS_BENCHMARK_BASELINE_DIR}/${target}.json")
+    endif()
+
+    add_test(NAME ${target}.b
+             COMMAND ${BBS_BENCHMARK} ${args} ${_EXTRA_ARGS} $<TARGET_FILE:${target}.b>
+             WORKING_DIRECTORY ${_WORKING_DIRECTORY})
+
+    # 'bbs_benchmark' exits with 77 if the driver was not built.
+    set_tests_properties(${target}.b PROPERTIES RUN_SERIAL TRUE
+                                                SKIP_RETURN_CODE 77)
+
+    # Only the '.b' labels are added, so that selecting the tests of a UOR or
+    # a component (e.g. 'ctest -L ^bdl$') does not run the benchmarks.
+    set_property(TEST ${target}.b APPEND PROPERTY LABELS benchmark)
+    foreach (label ${_LABELS})
+        set_property(TEST ${target}.b APPEND PROPERTY LABELS "${label}.b")
+    endforeach()
+endfunction()
+
+#[[.rst:
+.. command:: bbs_add_component_benchmarks
+
+Generate build targets [executables] for the specified ``BENCHMARK_SOURCES``,
+add them as benchmark tests and generate the ``<target>.b`` and ``all.b``
+build targets.  The drivers are linked with the ``target``, the ``TEST_DEPS``
+and the Google Benchmark library (``benchmark``).  Unless the build type is
+optimized, they are compiled with ``BBS_BENCHMARK_OPT_FLAGS``; the code of the
+``target`` itself is only optimized in an optimized build.
+
+.. code-block:: cmake
+
+   bbs_add_component_benchmarks(target
+                                BENCHMARK_SOURCES source1.b.cpp [source2.b.cpp ...]
+                                [ WORKING_DIRECTORY      dir            ]
+                                [ EXTRA_ARGS             arg        ... ]
+                                [ LABELS                 label      ... ]
+                                [ TEST_DEPS              lib1 lib2  ... ]
+                               )
+
+#]]
+function(bbs_add_component_benchmarks target)
+    cmake_parse_arguments(PARSE_ARGV 1
+                          ""
+                          ""
+                          "WORKING_DIRECTORY"
+                          "EXTRA_ARGS;LABELS;BENCHMARK_SOURCES;TEST_DEPS")
+    bbs_assert_no_unparsed_args("")
+
+    if (NOT _BENCHMARK_SOURCES)
+        message(FATAL_ERROR "No sources for the benchmark ${target}")
+    endif()
+
+    bbs_profile_begin(bbs_add_component_benchmarks ${target})
+
+    get_property(build_type_reported GLOBAL PROPERTY _BBS_BENCHMARK_BUILD_TYPE_REPORTED)
+    if (NOT build_type_reported AND CMAKE_BUILD_TYPE MATCHES "^(Debug|)$")
+        message(STATUS "Benchmarks are built against non-optimized libraries (CMAKE_BUILD_TYPE: '${CMAKE_BUILD_TYPE}')")
+        set_property(GLOBAL PROPERTY _BBS_BENCHMARK_BUILD_TYPE_REPORTED TRUE)
+    endif()
+
+    set(benchmark_targets ${${target}_BENCHMARK_TARGETS})
+
+    foreach(benchmark_src ${_BENCHMARK_SOURCES})
+        get_filename_component(benchmark_name ${benchmark_src} NAME_WE)
+        if (BDE_TEST_REGEX AND NOT ${benchmark_name} MATCHES "${BDE_TEST_REGEX}")
+            # Generate benchmark target only for matching test regex, if any.
+            continue()
+        endif()
+
+        add_executable(${benchmark_name}.b EXCLUDE_FROM_ALL ${benchmark_src})
+        set_target_properties(
+            ${benchmark_name}.b
+            PROPERTIES
+            RUNTIME_OUTPUT_DIRECTORY "${CMAKE_BINARY_DIR}/benchmarks")
+
+        # Explicitly adding flags here because we do not want those flags to be
+        # PUBLIC for standalone libraries.
+        bbs_add_target_bde_flags(${benchmark_name}.b PRIVATE)
+        bbs_add_target_thread_flags(${benchmark_name}.b PRIVATE)
+        target_compile_options(${benchmark_name}.b PRIVATE
+            $<$<NOT:$<OR:$<CONFIG:Release>,$<CONFIG:RelWithDebInfo>,$<CONFIG:MinSizeRel>>>:${BBS_BENCHMARK_OPT_FLAGS}>)
+
+        target_link_libraries(${benchmark_name}.b PUBLIC ${target} ${_TEST_DEPS} benchmark)
+        bbs_import_target_dependencies(${benchmark_name}.b ${_TEST_DEPS})
+
+        bbs_add_bde_style_benchmark(${benchmark_name}
+                                    WORKING_DIRECTORY "${_WORKING_DIRECTORY}"
+                                    EXTRA_ARGS        "${_EXTRA_ARGS}"
+                                    LABELS            "${_LABELS}"
+                                                      "${benchmark_name}")
+
+        if (NOT TARGET ${target}.b)
+            add_custom_target(${target}.b)
+        endif()
+
+        if (NOT TARGET all.b)
+            add_custom_target(all.b)
+        endif()
+
+        add_dependencies(${target}.b ${benchmark_name}.b)
+        add_dependencies(all.b ${benchmark_name}.b)
+
+        list(APPEND benchmark_targets ${benchmark_name}.b)
+    endforeach()
+
+    set(${target}_BENCHMARK_TARGETS "${benchmark_targets}" PARENT_SCOPE)
+
+    bbs_profile_end()
+endfunction()
@@ -15,3 +15,4 @@ include(${CMAKE_CURRENT_LIST_DIR}/BdeInternalTargets.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/BdeTargetUtils.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/BdeTestDriverUtils.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/BdeGtestDriverUtils.cmake)
+include(${CMAKE_CURRENT_LIST_DIR}/BdeBenchmarkUtils.cmake)
@@ -43,3 +43,149 @@ function(bbs_build_tests_with_all)
         add_custom_target(all.t ALL)
     endif()
 endfunction()
+
+# :: BBS_PROFILE_CONFIGURE ::
+# -----------------------------------------------------------------------------
+# When this option is set, the configuration steps wrapped in
+# 'bbs_profile_begin'/'bbs_profile_end' are timed.  At the end of the
+# configuration a summary ranked by total time is printed and written to
+# 'bbs_configure_profile.txt', and the individual timings are written to
+# 'bbs_configure_profile.json' (Chrome trace event format, to be loaded in
+# chrome://tracing or https://ui.perfetto.dev) in the top level build
+# directory.
+option(BBS_PROFILE_CONFIGURE "Report the time spent in the BDE CMake functions during configuration" OFF)
+
+if (BBS_PROFILE_CONFIGURE AND CMAKE_VERSION VERSION_LESS 3.23)
+    message(WARNING "BBS_PROFILE_CONFIGURE requires CMake 3.23 or later, disabling profiling")
+    set(BBS_PROFILE_CONFIGURE OFF)
+endif()
+
+# :: bbs_profile_begin ::
+# -----------------------------------------------------------------------------
+# This function starts timing a configuration step identified by the specified
+# 'name' (usually the name of the function being profiled) and the optionally
+# specified 'detail' (usually the UOR, package or target being processed).
+# Each call must be matched by a call to 'bbs_profile_end'.  This function does
+# nothing unless 'BBS_PROFILE_CONFIGURE' is set.
+function(bbs_profile_begin name)
+    if (NOT BBS_PROFILE_CONFIGURE)
+        return()
+    endif()
+
+    string(TIMESTAMP now "%s%f" UTC)
+    set_property(GLOBAL APPEND PROPERTY _BBS_PROFILE_STACK "${now}|${name}|${ARGV1}")
+endfunction()
+
+# :: bbs_profile_end ::
+# -----------------------------------------------------------------------------
+# This function stops timing the configuration step started by the last
+# unmatched call to 'bbs_profile_begin' and records it.
+function(bbs_profile_end)
+    if (NOT BBS_PROFILE_CONFIGURE)
+        return()
+    endif()
+
+    string(TIMESTAMP now "%s%f" UTC)
+
+    get_property(stack GLOBAL PROPERTY _BBS_PROFILE_STACK)
+    if (NOT stack)
+        message(FATAL_ERROR "bbs_profile_end called without bbs_profile_begin")
+    endif()
+    list(POP_BACK stack entry)
+    set_property(GLOBAL PROPERTY _BBS_PROFILE_STACK "${stack}")
+
+    string(REGEX MATCH "^([0-9]+)\\|([^|]*)\\|(.*)$" entry "${entry}")
+    math(EXPR duration "${now} - ${CMAKE_MATCH_1}")
+    set_property(GLOBAL APPEND PROPERTY _BBS_PROFILE_EVENTS
+                 "${CMAKE_MATCH_1}|${duration}|${CMAKE_MATCH_2}|${CMAKE_MATCH_3}")
+endfunction()
+
+# Format the specified 'usec' duration in seconds with millisecond precision.
+function(_bbs_profile_format_time usec result)
+    math(EXPR msec "${usec} / 1000")
+    math(EXPR sec "${msec} / 1000")
+    math(EXPR msec "${msec} % 1000")
+    string(LENGTH "${msec}" len)
+    if (len EQUAL 1)
+        set(msec "00${msec}")
+    elseif (len EQUAL 2)
+        set(msec "0${msec}")
+    endif()
+    set(${result} "${sec}.${msec}s" PARENT_SCOPE)
+endfunction()
+
+# Write the profiling report once all the deferred calls (e.g., the dependency
+# imports) have been executed.
+function(_bbs_profile_write_report)
+    cmake_language(DEFER DIRECTORY ${CMAKE_SOURCE_DIR} GET_CALL_IDS pending)
+    if (pending)
+        cmake_language(DEFER DIRECTORY ${CMAKE_SOURCE_DIR} CALL _bbs_profile_write_report)
+        return()
+    endif()
+
+    get_property(events GLOBAL PROPERTY _BBS_PROFILE_EVENTS)
+
+    set(names "")
+    set(ranked_steps "")
+    set(trace_events "")
+    foreach(event ${events})
+        string(REGEX MATCH "^([0-9]+)\\|([0-9]+)\\|([^|]*)\\|(.*)$" event "${event}")
+        set(start    ${CMAKE_MATCH_1})
+        set(duration ${CMAKE_MATCH_2})
+        set(name     ${CMAKE_MATCH_3})
+        set(detail   ${CMAKE_MATCH_4})
+
+        if (NOT DEFINED total_${name})
+            list(APPEND names ${name})
+            set(total_${name} 0)
+            set(count_${name} 0)
+        endif()
+        math(EXPR total_${name} "${total_${name}} + ${duration}")
+        math(EXPR count_${name} "${count_${name}} + 1")
+
+        if (detail)
+            list(APPEND ranked_steps "${duration}|${name}(${detail})")
+        else()
+            list(APPEND ranked_steps "${duration}|${name}")
+        endif()
+
+        string(REPLACE "\\" "\\\\" detail "${detail}")
+        string(REPLACE "\"" "\\\"" detail "${detail}")
+        list(APPEND trace_events
+             "{\"name\":\"${name}\",\"cat\":\"bbs\",\"ph\":\"X\",\"ts\":${start},\"dur\":${duration},\"pid\":1,\"tid\":1,\"args\":{\"detail\":\"${detail}\"}}")
+    endforeach()
+
+    set(ranked_names "")
+    foreach(name ${names})
+        list(APPEND ranked_names "${total_${name}}|${name}")
+    endforeach()
+    list(SORT ranked_names COMPARE NATURAL ORDER DESCENDING)
+    list(SORT ranked_steps COMPARE NATURAL ORDER DESCENDING)
+
+    set(report "Configuration profile (inclusive times)\n\n")
+    foreach(entry ${ranked_names})
+        string(REGEX MATCH "^([0-9]+)\\|(.*)$" entry "${entry}")
+        _bbs_profile_format_time(${CMAKE_MATCH_1} total)
+        string(APPEND report "  ${total}\t${count_${CMAKE_MATCH_2}}x\t${CMAKE_MATCH_2}\n")
+    endforeach()
+
+    string(APPEND report "\nSlowest steps\n\n")
+    list(SUBLIST ranked_steps 0 25 ranked_steps)
+    foreach(entry ${ranked_steps})
+        string(REGEX MATCH "^([0-9]+)\\|(.*)$" entry "${entry}")
+        _bbs_profile_format_time(${CMAKE_MATCH_1} total)
+        string(APPEND report "  ${total}\t${CMAKE_MATCH_2}\n")
+    endforeach()
+
+    string(JOIN ",\n" trace_events ${trace_events})
+    file(WRITE ${CMAKE_BINARY_DIR}/bbs_configure_profile.json
+         "{\"traceEvents\":[\n${trace_events}\n]}\n")
+    file(WRITE ${CMAKE_BINARY_DIR}/bbs_configure_profile.txt "${report}")
+
+    message(STATUS "${report}")
+    message(STATUS "Configuration profile written to ${CMAKE_BINARY_DIR}/bbs_configure_profile.json")
+endfunction()
+
+if (BBS_PROFILE_CONFIGURE)
+    cmake_language(DEFER DIRECTORY ${CMAKE_SOURCE_DIR} CALL _bbs_profile_write_report)
+endif()
@@ -3,7 +3,7 @@ include_guard(GLOBAL)
 function(bbs_emit_pkgconfig_file)
     set(singleValueArgs TARGET PKG VERSION PREFIX LIBDIR INCLUDEDIR COMPONENT)
     set(multiValueArgs DEPS UOR_DEPS OPTIONS)
-    cmake_parse_arguments(args "" "${singleValueArgs}" "${multiValueArgs}" ${ARGN})
+    cmake_parse_arguments(args "STATIC_ARCHIVE" "${singleValueArgs}" "${multiValueArgs}" ${ARGN})
 
     if (WIN32)
         # pkg-config files cannot be used on Windows
@@ -59,6 +59,9 @@ function(bbs_emit_pkgconfig_file)
         get_property( TARGET_NAME TARGET ${args_TARGET} PROPERTY NAME  )
         bbs_uor_to_pc_name( ${TARGET_NAME} PC_NAME )
 
+        # Shared variants of UORs use the UOR name as output name
+        get_property( LIB_NAME TARGET ${args_TARGET} PROPERTY OUTPUT_NAME )
+
         get_property( UOR_LINK_LIBRARIES
                       TARGET ${args_TARGET}
                       PROPERTY LINK_LIBRARIES )
@@ -96,10 +99,33 @@ function(bbs_emit_pkgconfig_file)
            string(APPEND PKG_OPTIONS " ${o}")
         endforeach(o)
 
+        # Link options required by the library itself (e.g. '-flto' for an
+        # archive of link-time optimized objects).
+        get_property( INTERFACE_LINK_OPTIONS
+                      TARGET ${args_TARGET}
+                      PROPERTY INTERFACE_LINK_OPTIONS )
+        foreach( o ${INTERFACE_LINK_OPTIONS} )
+           if (NOT o MATCHES "\\$<")
+               string(APPEND PKG_LIBS " ${o}")
+           endif()
+        endforeach(o)
+
     endif()
 
     set(PKG_DESCRIPTION ${TARGET_NAME})
 
+    if (NOT LIB_NAME)
+        set(LIB_NAME ${TARGET_NAME})
+    endif()
+
+    if (args_STATIC_ARCHIVE)
+        # Reference the archive by path, the '-l' flag would resolve to the
+        # shared library installed next to it.
+        set(PKG_LIB_FLAGS "\${pc_sysrootdir}\${libdir}/${CMAKE_STATIC_LIBRARY_PREFIX}${LIB_NAME}${CMAKE_STATIC_LIBRARY_SUFFIX}")
+    else()
+        set(PKG_LIB_FLAGS "-L\${libdir} -l${LIB_NAME}")
+    endif()
+
     if (args_VERSION)
         set(PKG_VERSION "${args_VERSION}")
     else(args_VERSION)
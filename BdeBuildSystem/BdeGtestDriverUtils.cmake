@@ -8,9 +8,28 @@ BdeGtestDriverUtils
 This module provide a set of function to generate Gtest-style tests for BDE components.
 #]]
 
+option(BBS_RUNTEST_GTEST
+       "Run the tests of gtest drivers in parallel batches through the BDE test runner"
+       OFF)
+
+set(BBS_RUNTEST_GTEST_BATCH_SIZE "" CACHE STRING
+    "Maximum number of tests of a gtest driver run by one process with BBS_RUNTEST_GTEST (runner default if empty)")
+
 #[[.rst:
 .. command:: bbs_add_bde_style_gtest
 
+Add the gtest [executable] ``target.t`` as a test and create ctest labels for
+it.  The ``COST`` property is set as in ``bbs_add_bde_style_test``.
+
+If ``BBS_RUNTEST_GTEST`` is ``ON`` the test runs the driver through the BDE
+test runner, which enumerates the tests of the driver with
+``--gtest_list_tests``, runs them in batches of consecutive tests (at most
+``BBS_RUNTEST_GTEST_BATCH_SIZE`` per process) in parallel across the runner
+jobs and merges their XML reports into the ``--junit`` file, if any.
+``EXTRA_ARGS`` are then passed to the test runner and the ``PROCESSORS``
+property is set as in ``bbs_add_bde_style_test``.  Otherwise the driver runs
+all its tests in one process.
+
 .. code-block:: cmake
 
    bbs_add_bde_style_gtest(target
@@ -34,9 +53,27 @@ function(bbs_add_bde_style_gtest target)
         set(_WORKING_DIRECTORY "${CMAKE_CURRENT_BINARY_DIR}")
     endif()
 
-    add_test(NAME ${target}.t
-             COMMAND $<TARGET_FILE:${target}.t>
-             WORKING_DIRECTORY ${_WORKING_DIRECTORY})
+    if (BBS_RUNTEST_GTEST)
+        _bbs_get_runtest_jobs("${_EXTRA_ARGS}" jobs_args jobs)
+
+        set(batch_args "")
+        if (BBS_RUNTEST_GTEST_BATCH_SIZE)
+            set(batch_args --gtest-batch-size ${BBS_RUNTEST_GTEST_BATCH_SIZE})
+        endif()
+
+        add_test(NAME ${target}.t
+                 COMMAND ${BBS_RUNTEST} --gtest ${jobs_args} ${batch_args} ${_EXTRA_ARGS}
+                         $<TARGET_FILE:${target}.t>
+                 WORKING_DIRECTORY ${_WORKING_DIRECTORY})
+        set_property(TEST ${target}.t PROPERTY PROCESSORS ${jobs})
+    else()
+        add_test(NAME ${target}.t
+                 COMMAND $<TARGET_FILE:${target}.t>
+                 WORKING_DIRECTORY ${_WORKING_DIRECTORY})
+    endif()
+
+    # Start the slowest tests first (see 'bbs_add_bde_style_test').
+    _bbs_set_test_cost(${target}.t)
 
     foreach (label ${_LABELS})
         set_property(TEST ${target}.t APPEND PROPERTY LABELS ${label} "${label}.t")
@@ -48,6 +85,8 @@ endfunction()
 
 Generate build targets [executables] for the specified ``GTEST_SOURCES``, add
 them as BDE tests and generate necessary build dependencies and test labels.
+Unless ``BBS_RUNTEST_GTEST`` is ``ON``, each test of the drivers is also added
+as a ctest test of its own (``gtest_discover_tests``).
 
 .. code-block:: cmake
 
@@ -112,12 +151,17 @@ function(bbs_add_component_gtests target)
 
         if (BDE_BUILD_TARGET_FUZZ)
             target_link_libraries(${gtest_target_name}.t PRIVATE "-fsanitize=fuzzer")
+            _bbs_add_fuzz_target()
         endif()
 
-        gtest_discover_tests(${gtest_target_name}.t
-                             DISCOVERY_TIMEOUT 60
-                             EXTRA_ARGS        "${_EXTRA_ARGS}"
-                            )
+        # With BBS_RUNTEST_GTEST the test runner runs the tests of the driver,
+        # which ctest would otherwise run a second time as discovered tests.
+        if (NOT BBS_RUNTEST_GTEST)
+            gtest_discover_tests(${gtest_target_name}.t
+                                 DISCOVERY_TIMEOUT 60
+                                 EXTRA_ARGS        "${_EXTRA_ARGS}"
+                                )
+        endif()
 
 
         set(test_src_labels ${gtest_name})
@@ -78,6 +78,92 @@ if( NOT WIN32)
   _bbs_pcimport_initialize()
 endif()
 
+#
+# Snapshot mode: every imported target is also written to a generated CMake
+# file in the build tree along with the timestamp of the .pc file it was
+# read from.  The next configuration reloads the snapshot into the import
+# cache and only re-reads the .pc files that changed since (or all of them if
+# the pkg-config search paths changed).
+#
+option( BBS_USE_PKGCONFIG_SNAPSHOT "Reuse the imported pkg-config targets snapshot until a .pc file changes" OFF )
+
+set( _bbs_pcimport_snapshot_file ${CMAKE_BINARY_DIR}/CMakeFiles/bbs_pkgconfig/snapshot.cmake )
+if ( CMAKE_VERSION VERSION_LESS 3.23 )
+  set( _bbs_pcimport_timestamp_format "%Y%m%d%H%M%S" )
+else()
+  set( _bbs_pcimport_timestamp_format "%Y%m%d%H%M%S%f" )
+endif()
+
+#
+# Load the entry for the given target from the snapshot into the import cache
+# if its .pc file is unchanged, otherwise drop the cached target.
+#
+function( _bbs_pcimport_load_snapshot_entry targetname )
+  set( fields VERSION LOCATION LINK_LIBRARIES INCLUDE_DIRECTORIES
+              COMPILE_DEFINITIONS COMPILE_OPTIONS REQUIRES )
+  cmake_parse_arguments( PARSE_ARGV 1 "entry" "" "PCFILE;TIMESTAMP;${fields}" "" )
+
+  if ( _bbs_pcimport_snapshot_key STREQUAL _bbs_pcimport_snapshot_current_key )
+    file( TIMESTAMP "${entry_PCFILE}" timestamp "${_bbs_pcimport_timestamp_format}" )
+  else()
+    set( timestamp "" )
+  endif()
+
+  if ( NOT timestamp OR NOT timestamp STREQUAL entry_TIMESTAMP )
+    message( VERBOSE "Dropping snapshot of ${targetname}: ${entry_PCFILE} changed" )
+    unset( _pcimport_${targetname}_cached CACHE )
+    return()
+  endif()
+
+  set( _pcimport_${targetname}_cached TRUE CACHE INTERNAL "" )
+  set( _pcimport_${targetname}_pcfile ${entry_PCFILE} CACHE INTERNAL "" )
+  foreach( field ${fields} )
+    string( TOLOWER ${field} var )
+    if ( entry_${field} )
+      set( _pcimport_${targetname}_${var} "${entry_${field}}" CACHE INTERNAL "" )
+    else()
+      unset( _pcimport_${targetname}_${var} CACHE )
+    endif()
+  endforeach()
+endfunction()
+
+#
+# Append the cached import information of the given target to the snapshot
+#
+function( _bbs_pcimport_snapshot_target targetname )
+  if ( NOT _pcimport_${targetname}_pcfile )
+    return()
+  endif()
+
+  file( TIMESTAMP "${_pcimport_${targetname}_pcfile}" timestamp "${_bbs_pcimport_timestamp_format}" )
+  set( entry "_bbs_pcimport_load_snapshot_entry( ${targetname}\n" )
+  string( APPEND entry "  PCFILE [==[${_pcimport_${targetname}_pcfile}]==]\n" )
+  string( APPEND entry "  TIMESTAMP [==[${timestamp}]==]\n" )
+  foreach( field VERSION LOCATION LINK_LIBRARIES INCLUDE_DIRECTORIES
+                 COMPILE_DEFINITIONS COMPILE_OPTIONS REQUIRES )
+    string( TOLOWER ${field} var )
+    string( APPEND entry "  ${field} [==[${_pcimport_${targetname}_${var}}]==]\n" )
+  endforeach()
+  string( APPEND entry ")\n" )
+  file( APPEND ${_bbs_pcimport_snapshot_file} "${entry}" )
+endfunction()
+
+if ( BBS_USE_PKGCONFIG_SNAPSHOT AND PKG_CONFIG_EXECUTABLE AND NOT WIN32 )
+  set( _bbs_pcimport_snapshot_current_key "${_importpc_pcpath}" )
+  foreach( installation ${PKG_CONFIG_INSTALLATION_NAMES} )
+    string( APPEND _bbs_pcimport_snapshot_current_key
+            "|${${installation}_PKG_CONFIG_SYSROOT_DIR}|${${installation}_PKG_CONFIG_PATH}" )
+  endforeach()
+
+  if ( EXISTS ${_bbs_pcimport_snapshot_file} )
+    include( ${_bbs_pcimport_snapshot_file} )
+  endif()
+
+  file( WRITE ${_bbs_pcimport_snapshot_file}
+        "# Generated by BdeImportPkgConfigTargets.cmake, do not edit.\n"
+        "set( _bbs_pcimport_snapshot_key [==[${_bbs_pcimport_snapshot_current_key}]==] )\n" )
+endif()
+
 function( bbs_import_pkgconfig_targets )
   if (WIN32 OR NOT PKG_CONFIG_EXECUTABLE)
     message(STATUS "Skipping pkg-config dependency resolution")
@@ -127,6 +213,10 @@ function( _bbs_pcimport_add_package pkgname pkgcallchain )
   else()
     _bbs_pcimport_import_pkgconfig_target( ${pkgname} "${pkgcallchain}" )
   endif()
+
+  if ( BBS_USE_PKGCONFIG_SNAPSHOT AND TARGET ${pkgname} )
+    _bbs_pcimport_snapshot_target( ${pkgname} )
+  endif()
 endfunction()
 
 #
@@ -463,6 +553,7 @@ endmacro()
 #
 macro( _bbs_pcimport_cache_target targetname requires_list )
   set( _pcimport_${targetname}_cached TRUE CACHE INTERNAL "" )
+  set( _pcimport_${targetname}_pcfile ${${targetname}_pcfile} CACHE INTERNAL "" )
 
   get_target_property(prop ${targetname} TYPE )
   if ( NOT "${prop}" STREQUAL INTERFACE_LIBRARY )
@@ -24,6 +24,63 @@ macro(_bbs_init_bde_options)
     set_property(CACHE BDE_BUILD_TARGET_ASSERT_LEVEL PROPERTY STRINGS default AOPT ADBG ASAFE ANONE)
     set(BDE_BUILD_TARGET_REVIEW_LEVEL default CACHE STRING "Review level")
     set_property(CACHE BDE_BUILD_TARGET_REVIEW_LEVEL PROPERTY STRINGS default ROPT RDBG RSAFE RNONE)
+    # Profile-guided optimization (handled by the toolchains)
+    set(BDE_BUILD_TARGET_PGO "" CACHE STRING "Profile-guided optimization stage")
+    set_property(CACHE BDE_BUILD_TARGET_PGO PROPERTY STRINGS "" GENERATE USE)
+    set(BDE_BUILD_TARGET_PGO_DIR "" CACHE PATH "Directory of the profile data")
+    # Link-time optimization
+    set(BDE_BUILD_TARGET_LTO "" CACHE STRING "Link-time optimization mode")
+    set_property(CACHE BDE_BUILD_TARGET_LTO PROPERTY STRINGS "" FULL THIN)
+    set(BBS_THINLTO_CACHE_DIR "${CMAKE_BINARY_DIR}/thinlto-cache" CACHE PATH
+        "Directory of the ThinLTO cache")
+endmacro()
+
+# Set up the link-time optimization of the targets with the
+# INTERPROCEDURAL_OPTIMIZATION property: CMake archives their objects with the
+# LTO-capable archiver of the compiler ('gcc-ar', 'llvm-ar').  Set
+# '_BBS_LTO_LINK_OPTIONS' to the options required to link the archives.
+macro(_bbs_setup_lto)
+    set(_BBS_LTO_LINK_OPTIONS)
+    if (BDE_BUILD_TARGET_LTO)
+        if (NOT BDE_BUILD_TARGET_LTO MATCHES "^(FULL|THIN)$")
+            message(FATAL_ERROR
+                    "Invalid BDE_BUILD_TARGET_LTO: '${BDE_BUILD_TARGET_LTO}' (expected FULL or THIN).")
+        endif()
+
+        include(CheckIPOSupported)
+        check_ipo_supported(RESULT _bbs_ipo_supported OUTPUT _bbs_ipo_output LANGUAGES CXX)
+        if (NOT _bbs_ipo_supported)
+            message(FATAL_ERROR "Link-time optimization is not supported: ${_bbs_ipo_output}")
+        endif()
+
+        if (CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+            string(TOLOWER ${BDE_BUILD_TARGET_LTO} _bbs_lto_mode)
+            foreach(lang C CXX)
+                set(CMAKE_${lang}_COMPILE_OPTIONS_IPO "-flto=${_bbs_lto_mode}")
+                if (BDE_BUILD_TARGET_LTO STREQUAL "THIN")
+                    if (APPLE)
+                        list(APPEND CMAKE_${lang}_LINK_OPTIONS_IPO
+                             "-Wl,-cache_path_lto,${BBS_THINLTO_CACHE_DIR}")
+                    else()
+                        list(APPEND CMAKE_${lang}_LINK_OPTIONS_IPO
+                             "-Wl,--plugin-opt=cache-dir=${BBS_THINLTO_CACHE_DIR}")
+                    endif()
+                endif()
+            endforeach()
+            set(_BBS_LTO_LINK_OPTIONS "-flto=${_bbs_lto_mode}")
+        elseif (CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+            if (BDE_BUILD_TARGET_LTO STREQUAL "THIN")
+                message(STATUS "gcc has no ThinLTO, using its parallel link-time optimization")
+            endif()
+            set(_BBS_LTO_LINK_OPTIONS ${CMAKE_CXX_COMPILE_OPTIONS_IPO})
+            list(REMOVE_ITEM _BBS_LTO_LINK_OPTIONS "-fno-fat-lto-objects")
+        endif()
+
+        if (CMAKE_CXX_COMPILER_ID MATCHES "^(GNU|Clang)$" AND NOT CMAKE_CXX_COMPILER_AR)
+            message(FATAL_ERROR "Link-time optimization requires an LTO-capable archiver ('gcc-ar' or 'llvm-ar')")
+        endif()
+        message(STATUS "Link-time optimization: ${BDE_BUILD_TARGET_LTO} (archiver: ${CMAKE_CXX_COMPILER_AR})")
+    endif()
 endmacro()
 
 # Add thread related options to the target
@@ -105,6 +162,18 @@ function(bbs_add_target_bde_flags target scope)
         endif()
     endforeach()
 
+    # Link-time optimization.  The objects of an LTO archive contain only the
+    # intermediate representation, so its users must link with LTO as well.
+    if (BDE_BUILD_TARGET_LTO)
+        get_target_property(target_type ${target} TYPE)
+        if (NOT target_type STREQUAL "INTERFACE_LIBRARY")
+            set_property(TARGET ${target} PROPERTY INTERPROCEDURAL_OPTIMIZATION ON)
+        endif()
+        if (target_type STREQUAL "STATIC_LIBRARY")
+            target_link_options(${target} INTERFACE ${_BBS_LTO_LINK_OPTIONS})
+        endif()
+    endif()
+
     # Fuzzer
     if (BDE_BUILD_TARGET_FUZZ)
         target_compile_definitions(
@@ -187,3 +256,4 @@ function(bbs_add_target_bde_flags target scope)
 endfunction()
 
 _bbs_init_bde_options()
+_bbs_setup_lto()
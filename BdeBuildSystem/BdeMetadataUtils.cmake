@@ -4,8 +4,27 @@ include_guard(GLOBAL)
 BdeMetadataUtils
 ----------------
 This module provide a set of function to parse BDE metadata files.
+
+The content of each package (the lists of components and of the header,
+source and test driver files found for them) is stored in a metadata index
+file in the build directory.  Subsequent configurations reuse the index of a
+package as long as neither its ``.mem``, ``.dep`` and ``.t.dep`` files nor the
+listing of its directory changed, so only modified packages are re-scanned.
+Setting the ``BBS_USE_METADATA_INDEX`` option to ``OFF`` forces a re-scan of
+all packages on every configuration.
 #]]
 
+option(BBS_USE_METADATA_INDEX "Reuse the cached package metadata index on reconfigure" ON)
+
+# Bump this version when the content of the metadata index changes.
+set(_BBS_METADATA_INDEX_VERSION 2)
+set(_BBS_METADATA_UTILS_FILE ${CMAKE_CURRENT_LIST_FILE})
+if (CMAKE_VERSION VERSION_LESS 3.23)
+    set(_BBS_METADATA_TIMESTAMP_FORMAT "%Y%m%d%H%M%S")
+else()
+    set(_BBS_METADATA_TIMESTAMP_FORMAT "%Y%m%d%H%M%S%f")
+endif()
+
 #[[.rst:
 .. command:: bbs_read_metadata
 
@@ -36,6 +55,7 @@ the parent scope:
     * <package>_TEST_SOURCES
     * <package>_GTEST_SOURCES
     * <package>_SPLIT_TEST_SOURCES
+    * <package>_BENCHMARK_SOURCES
     * <package>_METADATA_DIR
 
 .. code-block:: cmake
@@ -67,6 +87,7 @@ variables in the parent scope:
     * <group>_TEST_SOURCES
     * <group>_GTEST_SOURCES
     * <group>_SPLIT_TEST_SOURCES
+    * <group>_BENCHMARK_SOURCES
     * <group>_METADATA_DIRS
 #]]
 function(bbs_read_metadata)
@@ -87,6 +108,8 @@ function(bbs_read_metadata)
         get_filename_component(_SOURCE_DIR ${_SOURCE_DIR} ABSOLUTE)
     endif()
 
+    bbs_profile_begin(bbs_read_metadata "${_PACKAGE}${_GROUP}")
+
     if (_PACKAGE)
         bbs_read_package_metadata(${_PACKAGE} ${_SOURCE_DIR})
     elseif (_GROUP)
@@ -96,6 +119,8 @@ function(bbs_read_metadata)
                                 PRIVATE_PACKAGES "${_PRIVATE_PACKAGES}")
     endif()
 
+    bbs_profile_end()
+
 endfunction()
 
 # reads the package metadata in the given directory
@@ -103,13 +128,22 @@ macro(bbs_read_package_metadata pkg dir)
     set(_meta_dir ${dir}/package)
     set(${pkg}_METADATA_DIRS ${_meta_dir})
 
-    unset(mems)
+    _bbs_load_package_metadata_index(${pkg} ${dir})
 
-    _bbs_read_bde_metadata(${_meta_dir}/${pkg}.mem mems)
-    _bbs_set_bde_component_lists(${dir} ${pkg} mems)
+    foreach(_var COMPONENTS INCLUDE_DIRS INCLUDE_FILES
+                 SOURCE_DIRS SOURCE_FILES
+                 TEST_SOURCES GTEST_SOURCES SPLIT_TEST_SOURCES BENCHMARK_SOURCES)
+        list(APPEND ${pkg}_${_var} ${_bbs_index_${_var}})
+        set(${pkg}_${_var} ${${pkg}_${_var}} PARENT_SCOPE)
+    endforeach()
+
+    if (NOT ${pkg}_MAIN_SOURCE)
+        set(${pkg}_MAIN_SOURCE ${_bbs_index_MAIN_SOURCE})
+    endif()
+    set(${pkg}_MAIN_SOURCE ${${pkg}_MAIN_SOURCE} PARENT_SCOPE)
 
     if (EXISTS ${_meta_dir}/${pkg}.dep)
-        _bbs_read_bde_metadata(${_meta_dir}/${pkg}.dep ${pkg}_DEPENDS)
+        list(APPEND ${pkg}_DEPENDS ${_bbs_index_DEPENDS})
         set(${pkg}_DEPENDS ${${pkg}_DEPENDS} PARENT_SCOPE)
 
         bbs_uor_to_pc_list("${${pkg}_DEPENDS}" ${pkg}_PCDEPS)
@@ -118,7 +152,7 @@ macro(bbs_read_package_metadata pkg dir)
 
 
     if (EXISTS ${_meta_dir}/${pkg}.t.dep)
-        _bbs_read_bde_metadata(${_meta_dir}/${pkg}.t.dep ${pkg}_TEST_DEPENDS)
+        list(APPEND ${pkg}_TEST_DEPENDS ${_bbs_index_TEST_DEPENDS})
         set(${pkg}_TEST_DEPENDS ${${pkg}_TEST_DEPENDS} PARENT_SCOPE)
 
         bbs_uor_to_pc_list("${${pkg}_TEST_DEPENDS}" ${pkg}_TEST_PCDEPS)
@@ -128,6 +162,86 @@ macro(bbs_read_package_metadata pkg dir)
     set(${pkg}_METADATA_DIRS ${${pkg}_METADATA_DIRS} PARENT_SCOPE)
 endmacro()
 
+# sets the '_bbs_index_<var>' variables to the content of the package found in
+# the metadata index, re-scanning the package if its index is out of date
+macro(_bbs_load_package_metadata_index pkg dir)
+    set(_index_file ${CMAKE_BINARY_DIR}/CMakeFiles/bbs_metadata/${pkg}.cmake)
+
+    # The directory timestamp changes whenever a file is added to, removed
+    # from or renamed in the package directory.
+    set(_index_key "${_BBS_METADATA_INDEX_VERSION}|${dir}")
+    foreach(_file ${_BBS_METADATA_UTILS_FILE}
+                  ${dir}
+                  ${dir}/package
+                  ${dir}/package/${pkg}.mem
+                  ${dir}/package/${pkg}.dep
+                  ${dir}/package/${pkg}.t.dep)
+        file(TIMESTAMP ${_file} _timestamp "${_BBS_METADATA_TIMESTAMP_FORMAT}")
+        string(APPEND _index_key "|${_timestamp}")
+    endforeach()
+
+    unset(_bbs_index_KEY)
+    if (BBS_USE_METADATA_INDEX AND EXISTS ${_index_file})
+        include(${_index_file})
+    endif()
+
+    if (_bbs_index_KEY STREQUAL _index_key)
+        message(TRACE "Using metadata index for package ${pkg}")
+        foreach(_file ${dir}/package/${pkg}.mem
+                      ${dir}/package/${pkg}.dep
+                      ${dir}/package/${pkg}.t.dep)
+            if (EXISTS ${_file})
+                bbs_track_file(${_file})
+            endif()
+        endforeach()
+    else()
+        message(TRACE "Scanning metadata for package ${pkg}")
+        _bbs_write_package_metadata_index(${pkg} ${dir} ${_index_file} "${_index_key}")
+        include(${_index_file})
+    endif()
+
+    foreach(_warning IN LISTS _bbs_index_WARNINGS)
+        message(WARNING "${_warning}")
+    endforeach()
+endmacro()
+
+# scans the metadata and the directory of the package and writes the result
+# to the specified 'index_file'
+function(_bbs_write_package_metadata_index pkg dir index_file key)
+    set(_meta_dir ${dir}/package)
+    set(index_vars COMPONENTS INCLUDE_DIRS INCLUDE_FILES
+                   SOURCE_DIRS SOURCE_FILES MAIN_SOURCE
+                   TEST_SOURCES GTEST_SOURCES SPLIT_TEST_SOURCES BENCHMARK_SOURCES
+                   DEPENDS TEST_DEPENDS)
+
+    # Only collect what is found in this package.
+    foreach(var ${index_vars})
+        unset(${pkg}_${var})
+    endforeach()
+    unset(mems)
+    set(_bbs_metadata_warnings "")
+
+    _bbs_read_bde_metadata(${_meta_dir}/${pkg}.mem mems)
+    _bbs_set_bde_component_lists(${dir} ${pkg} mems)
+
+    if (EXISTS ${_meta_dir}/${pkg}.dep)
+        _bbs_read_bde_metadata(${_meta_dir}/${pkg}.dep ${pkg}_DEPENDS)
+    endif()
+
+    if (EXISTS ${_meta_dir}/${pkg}.t.dep)
+        _bbs_read_bde_metadata(${_meta_dir}/${pkg}.t.dep ${pkg}_TEST_DEPENDS)
+    endif()
+
+    set(content "# Generated by BdeMetadataUtils.cmake, do not edit.\n")
+    string(APPEND content "set(_bbs_index_KEY [==[${key}]==])\n")
+    foreach(var ${index_vars})
+        string(APPEND content "set(_bbs_index_${var} [==[${${pkg}_${var}}]==])\n")
+    endforeach()
+    string(APPEND content "set(_bbs_index_WARNINGS [==[${_bbs_metadata_warnings}]==])\n")
+
+    file(WRITE ${index_file} "${content}")
+endfunction()
+
 macro(bbs_read_group_metadata group dir)
     cmake_parse_arguments(""
                           ""
@@ -170,7 +284,7 @@ macro(bbs_read_group_metadata group dir)
             bbs_read_package_metadata(${pkg} ${_SOURCE_DIR}/${pkg})
             set(propagate_properties COMPONENTS INCLUDE_DIRS INCLUDE_FILES
                                      SOURCE_DIRS SOURCE_FILES
-                                     TEST_SOURCES GTEST_SOURCES SPLIT_TEST_SOURCES
+                                     TEST_SOURCES GTEST_SOURCES SPLIT_TEST_SOURCES BENCHMARK_SOURCES
                                      METADATA_DIRS)
 
             # Private packages do not propagate their include files to the group
@@ -193,7 +307,7 @@ macro(bbs_read_group_metadata group dir)
 
     foreach(var PACKAGES DEPENDS PCDEPS TEST_DEPENDS TEST_PCDEPS COMPONENTS
                 INCLUDE_DIRS INCLUDE_FILES SOURCE_DIRS SOURCE_FILES
-                TEST_SOURCES GTEST_SOURCES SPLIT_TEST_SOURCES METADATA_DIRS)
+                TEST_SOURCES GTEST_SOURCES SPLIT_TEST_SOURCES BENCHMARK_SOURCES METADATA_DIRS)
         set(${group}_${var} ${${group}_${var}} PARENT_SCOPE)
     endforeach()
 endmacro()
@@ -245,7 +359,7 @@ macro(_bbs_set_bde_component_lists dir package mems)
                 list(APPEND ${package}_SOURCE_FILES ${dir}/${mem})
                 continue() # Not strictly needed, but speeds thing up
             else()
-                message(WARNING "Unrecognized entry in .mem file: ${mem}")
+                list(APPEND _bbs_metadata_warnings "Unrecognized entry in .mem file: ${mem}")
             endif()
         endif()
 
@@ -272,6 +386,11 @@ macro(_bbs_set_bde_component_lists dir package mems)
                 list(APPEND ${package}_SPLIT_TEST_SOURCES ${dir}/${mem}.xt.cpp)
             endif()
 
+            # Benchmark drivers are independent of the test driver
+            if (EXISTS ${dir}/${mem}.b.cpp)
+                list(APPEND ${package}_BENCHMARK_SOURCES ${dir}/${mem}.b.cpp)
+            endif()
+
             # finding numbered and forwarding header tests
             file(GLOB numbered_tests "${dir}/${mem}.*.t.cpp")
             foreach(ntest IN LISTS numbered_tests)
@@ -290,7 +409,7 @@ macro(_bbs_set_bde_component_lists dir package mems)
         endif()
 
         if (NOT component_found)
-            message(WARNING "No source files for component ${mem} found")
+            list(APPEND _bbs_metadata_warnings "No source files for component ${mem} found")
         endif()
     endforeach()
 
@@ -298,11 +417,4 @@ macro(_bbs_set_bde_component_lists dir package mems)
     if (NOT ${package}_MAIN_SOURCE AND EXISTS ${dir}/${package}.m.cpp)
         list(APPEND ${package}_MAIN_SOURCE ${dir}/${package}.m.cpp)
     endif()
-
-    # propagate the lists to the caller
-    foreach(var COMPONENTS INCLUDE_DIRS INCLUDE_FILES
-                SOURCE_DIRS SOURCE_FILES MAIN_SOURCE
-                TEST_SOURCES GTEST_SOURCES SPLIT_TEST_SOURCES)
-        set(${package}_${var} ${${package}_${var}} PARENT_SCOPE)
-    endforeach()
 endmacro()
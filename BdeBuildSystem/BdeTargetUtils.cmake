@@ -30,6 +30,9 @@ if(NOT DEFINED SIM_CPP11)
     endif()
 endif()
 
+set(BBS_CPP11_CACHE_DIR "${CMAKE_BINARY_DIR}/sim_cpp11_cache" CACHE PATH
+    "Directory where sim_cpp11_features records which cpp03 files are up to date (empty to disable)")
+
 option(BBS_USE_WAFSTYLEOUT "Use waf-style output wrapper" OFF)
 if (BBS_USE_WAFSTYLEOUT)
     find_file(WAF_STYLE_OUT
@@ -53,6 +56,9 @@ else()
     set_property(GLOBAL PROPERTY BBS_CMD_WRAPPER "")
 endif()
 
+option(BBS_BUILD_SHARED_VARIANT
+       "Also build a shared library from the objects of each static UOR" OFF)
+
 if(NOT DEFINED CHECK_CYCLES)
     find_file(CHECK_CYCLES
               "check_cycles.py"
@@ -93,33 +99,68 @@ endfunction()
 # listed pcdeps are already transitively provided by another pcdep, so those
 # redundant entries can be removed from the target's link list and allowed to
 # arrive in the correct order via their provider's INTERFACE_LINK_LIBRARIES.
+#
+# The result is memoized per target in the '_BBS_TRANSITIVE_LINK_DEPS_<target>'
+# global property and reused for any target reached by a later traversal.  A
+# result is not memoized if the traversal met a library name that is not (yet)
+# a target, since importing it later could extend the reachability set.
 function(_bbs_get_transitive_link_deps target_name result_var)
+    get_property(_memoized GLOBAL PROPERTY _BBS_TRANSITIVE_LINK_DEPS_${target_name} SET)
+    if (_memoized)
+        get_property(_result GLOBAL PROPERTY _BBS_TRANSITIVE_LINK_DEPS_${target_name})
+        set(${result_var} "${_result}" PARENT_SCOPE)
+        return()
+    endif()
+
     set(_queue "${target_name}")
-    set(_visited "")
+    set(_visited_${target_name} TRUE)
     set(_result "")
+    set(_complete TRUE)
     while(_queue)
         list(POP_FRONT _queue _current)
-        if (_current IN_LIST _visited)
+
+        get_property(_memoized GLOBAL PROPERTY _BBS_TRANSITIVE_LINK_DEPS_${_current} SET)
+        if (_memoized)
+            get_property(_deps GLOBAL PROPERTY _BBS_TRANSITIVE_LINK_DEPS_${_current})
+            foreach(_dep ${_deps})
+                if (NOT _visited_${_dep})
+                    set(_visited_${_dep} TRUE)
+                    list(APPEND _result "${_dep}")
+                endif()
+            endforeach()
             continue()
         endif()
-        list(APPEND _visited "${_current}")
+
         if (TARGET ${_current})
             get_target_property(_deps ${_current} INTERFACE_LINK_LIBRARIES)
             if (_deps)
                 foreach(_dep ${_deps})
-                    if (_dep AND TARGET ${_dep} AND NOT _dep IN_LIST _visited)
-                        list(APPEND _queue "${_dep}")
-                        list(APPEND _result "${_dep}")
+                    if (NOT _dep)
+                        continue()
+                    elseif (TARGET ${_dep})
+                        if (NOT _visited_${_dep})
+                            set(_visited_${_dep} TRUE)
+                            list(APPEND _queue "${_dep}")
+                            list(APPEND _result "${_dep}")
+                        endif()
+                    elseif (NOT _dep MATCHES "^(-|/|\\$<)")
+                        set(_complete FALSE)
                     endif()
                 endforeach()
             endif()
         endif()
     endwhile()
+
+    if (_complete)
+        set_property(GLOBAL PROPERTY _BBS_TRANSITIVE_LINK_DEPS_${target_name} "${_result}")
+    endif()
     set(${result_var} "${_result}" PARENT_SCOPE)
 endfunction()
 
 # Try to find an external dependency passed via arguments
 function(_bbs_defer_target_import target)
+    bbs_profile_begin(_bbs_defer_target_import ${target})
+
     bbs_load_conan_build_info()
 
     foreach(dep ${ARGN})
@@ -195,6 +236,8 @@ function(_bbs_defer_target_import target)
             endif()
         endif()
     endif()
+
+    bbs_profile_end()
 endfunction()
 
 #[[.rst:
@@ -232,14 +275,14 @@ endfunction()
 #[[.rst:
 .. command:: bbs_configure_target_tests
 
-  Configure tests from the specified sources and
+  Configure tests (and benchmarks) from the specified sources and
   add the target as their main build dependency.
 #]]
 function(bbs_configure_target_tests target)
     cmake_parse_arguments(""
                           ""
                           ""
-                          "TEST_SOURCES;SOURCES;GTEST_SOURCES;SPLIT_SOURCES;TEST_DEPS;LABELS"
+                          "TEST_SOURCES;SOURCES;GTEST_SOURCES;SPLIT_SOURCES;BENCHMARK_SOURCES;TEST_DEPS;LABELS"
                           ${ARGN})
     bbs_assert_no_unparsed_args("")
 
@@ -273,6 +316,16 @@ function(bbs_configure_target_tests target)
                                 LABELS        ${_LABELS})
         set(${target}_TEST_TARGETS "${${target}_TEST_TARGETS}" PARENT_SCOPE)
     endif()
+    if (_BENCHMARK_SOURCES)
+        # Benchmarks are not part of the "all" tests.
+        set(benchmark_labels ${_LABELS})
+        list(REMOVE_ITEM benchmark_labels "all")
+        bbs_add_component_benchmarks(${target}
+                                     BENCHMARK_SOURCES ${_BENCHMARK_SOURCES}
+                                     TEST_DEPS         ${_TEST_DEPS}
+                                     LABELS            ${benchmark_labels})
+        set(${target}_BENCHMARK_TARGETS "${${target}_BENCHMARK_TARGETS}" PARENT_SCOPE)
+    endif()
 endfunction()
 
 #[[.rst:
@@ -363,7 +416,9 @@ function (bbs_install_target target)
         OR _target_type STREQUAL "SHARED_LIBRARY"
         OR _target_type STREQUAL "INTERFACE_LIBRARY")
 
-        foreach(p ${${uor_name}_PACKAGES})
+        # Standalone packages have an object library only when building the
+        # shared variant.
+        foreach(p ${${uor_name}_PACKAGES} ${uor_name})
             if (TARGET ${p}-iface)
                 install(TARGETS ${p}-iface
                         EXPORT  ${uor_name}Targets)
@@ -372,6 +427,16 @@ function (bbs_install_target target)
 
         install(TARGETS ${target}
                 EXPORT  ${uor_name}Targets)
+
+        if (TARGET ${uor_name}-shared)
+            install(TARGETS ${uor_name}-shared
+                    EXPORT  ${uor_name}Targets
+                    LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR}
+                    COMPONENT ${_COMPONENT})
+            install(TARGETS ${uor_name}-shared
+                    LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR}
+                    COMPONENT ${_COMPONENT}-all)
+        endif()
         install(EXPORT  ${uor_name}Targets
                 DESTINATION ${CMAKE_INSTALL_LIBDIR}/cmake/${uor_name}
                 COMPONENT ${_COMPONENT})
@@ -413,7 +478,10 @@ endfunction()
 #[[.rst:
 .. command:: bbs_emit_pkg_config
 
-  Emit package config for the target
+  Emit package config for the target.  If the target has a shared variant
+  (see ``BBS_BUILD_SHARED_VARIANT``), a ``<pc_name>-shared.pc`` file is
+  emitted for it as well, and the static ``.pc`` file references the archive
+  explicitly so that the linker does not pick up the shared library instead.
 #]]
 function (bbs_emit_pkg_config target)
     cmake_parse_arguments(PARSE_ARGV 1
@@ -430,10 +498,21 @@ function (bbs_emit_pkg_config target)
         string(REPLACE "_" "-" _COMPONENT ${uor_name})
     endif()
 
+    set(static_archive_option)
+    if (TARGET ${uor_name}-shared)
+        set(static_archive_option STATIC_ARCHIVE)
+
+        bbs_emit_pkgconfig_file(TARGET ${uor_name}-shared
+                                PREFIX "${CMAKE_INSTALL_PREFIX}"
+                                VERSION "${BB_BUILDID_PKG_VERSION}"
+                                COMPONENT ${_COMPONENT})
+    endif()
+
     bbs_emit_pkgconfig_file(TARGET ${target}
                             PREFIX "${CMAKE_INSTALL_PREFIX}"
                             VERSION "${BB_BUILDID_PKG_VERSION}" # todo: add real version
-                            COMPONENT ${_COMPONENT})
+                            COMPONENT ${_COMPONENT}
+                            ${static_archive_option})
 endfunction()
 
 #.rst:
@@ -468,7 +547,10 @@ endfunction()
 #.rst:
 # .. command:: bbs_generate_cpp03_sources
 #
-# Generate cpp03 source files.
+# Generate cpp03 source files.  With ``IMMEDIATE`` the files are also
+# generated at configuration time, by a single run of ``sim_cpp11_features``
+# processing all of them in parallel (``--jobs``).  The runs share the cache in
+# ``BBS_CPP11_CACHE_DIR``, so that the files that are up to date are skipped.
 function (bbs_generate_cpp03_sources srcFiles)
     cmake_parse_arguments(PARSE_ARGV 1
                           ""
@@ -480,26 +562,29 @@ function (bbs_generate_cpp03_sources srcFiles)
     if(SIM_CPP11)
         get_property(cmd_wrapper GLOBAL PROPERTY BBS_CMD_WRAPPER)
 
-        foreach(srcFile ${srcFiles})
-            if(${srcFile} MATCHES "_cpp03\.")
-                set(cpp11VerifyOption "")
-                set(cpp11Operation "generation")
+        set(cpp11VerifyOption "")
+        set(cpp11Operation "generation")
 
-                if(BBS_CPP11_VERIFY_NO_CHANGE)
-                    set(cpp11VerifyOption "--verify-no-change")
-                    set(cpp11Operation "validation")
-                endif()
+        if(BBS_CPP11_VERIFY_NO_CHANGE)
+            set(cpp11VerifyOption "--verify-no-change")
+            set(cpp11Operation "validation")
+        endif()
+
+        set(cpp11CacheOption "")
+        if(BBS_CPP11_CACHE_DIR)
+            set(cpp11CacheOption --cache-dir "${BBS_CPP11_CACHE_DIR}")
+        endif()
+
+        set(cpp11SrcFiles)
 
+        foreach(srcFile ${srcFiles})
+            if(${srcFile} MATCHES "_cpp03\.")
                 string(REPLACE "_cpp03." "." cpp11SrcFile ${srcFile})
                 message(TRACE "sim_cpp11 ${cpp11Operation}: ${cpp11SrcFile} -> ${srcFile}")
 
-                set(command ${cmd_wrapper} "${Python3_EXECUTABLE}" "${SIM_CPP11}" ${cpp11VerifyOption} "${cpp11SrcFile}")
+                set(command ${cmd_wrapper} "${Python3_EXECUTABLE}" "${SIM_CPP11}" ${cpp11VerifyOption} ${cpp11CacheOption} "${cpp11SrcFile}")
 
-                if (_IMMEDIATE)
-                    execute_process(
-                        COMMAND ${command}
-                        COMMAND_ERROR_IS_FATAL ANY)
-                endif()
+                list(APPEND cpp11SrcFiles "${cpp11SrcFile}")
 
                 add_custom_command(
                     OUTPUT    "${srcFile}"
@@ -507,13 +592,35 @@ function (bbs_generate_cpp03_sources srcFiles)
                     DEPENDS   "${cpp11SrcFile}")
             endif()
         endforeach()
+
+        if (_IMMEDIATE AND cpp11SrcFiles)
+            # Starting the interpreter once per file dominates the run time of
+            # small files: process them all in one run, one job per CPU.
+            list(LENGTH cpp11SrcFiles cpp11SrcCount)
+            set(fileList "${CMAKE_CURRENT_BINARY_DIR}/sim_cpp11_features.files")
+            string(REPLACE ";" "\n" fileListContent "${cpp11SrcFiles}")
+            file(WRITE "${fileList}" "${fileListContent}\n")
+
+            bbs_profile_begin(sim_cpp11_features "${cpp11SrcCount} files")
+            execute_process(
+                COMMAND ${cmd_wrapper} "${Python3_EXECUTABLE}" "${SIM_CPP11}"
+                        ${cpp11VerifyOption} ${cpp11CacheOption}
+                        --jobs 0 --file-list "${fileList}"
+                COMMAND_ERROR_IS_FATAL ANY)
+            bbs_profile_end()
+        endif()
     endif()
 endfunction()
 
 #.rst:
 # .. command:: bbs_check_cycles_target
 #
-# Generate custom target to check uor cycles.
+# Generate custom target to check uor cycles.  The ``check_cycles`` target
+# checks all the UORs of the build in a single run, so that cycles between
+# UORs are found as well.  The ``levelize`` target reports the levels of the
+# components of all the UORs, the critical path of the build (weighted by the
+# compile times in ``.ninja_log``) and the headers triggering the largest
+# rebuilds, and writes ``levelize.json`` and ``levelize.dot``.
 function (bbs_emit_check_cycles target)
     if(CHECK_CYCLES)
         get_property(cmd_wrapper GLOBAL PROPERTY BBS_CMD_WRAPPER)
@@ -534,10 +641,88 @@ function (bbs_emit_check_cycles target)
             DEPENDS "${file_list_path}"
         )
 
+        # The response files of all UORs are listed in one file, which is
+        # rewritten by the first UOR of each configuration.
+        set(all_lists_path "${CMAKE_BINARY_DIR}/CMakeFiles/check_cycles.lists.txt")
         if (NOT TARGET check_cycles)
-            add_custom_target(check_cycles)
+            file(WRITE "${all_lists_path}" "${file_list_path}\n")
+            add_custom_target(check_cycles
+                COMMAND   ${cmd_wrapper} "${Python3_EXECUTABLE}" "${CHECK_CYCLES}" --file-lists "${all_lists_path}"
+                DEPENDS "${all_lists_path}"
+            )
+
+            get_filename_component(scripts_dir "${CHECK_CYCLES}" DIRECTORY)
+            add_custom_target(levelize
+                COMMAND   ${cmd_wrapper} "${Python3_EXECUTABLE}" "${scripts_dir}/levelize.py"
+                          --file-lists "${all_lists_path}"
+                          --ninja-log "${CMAKE_BINARY_DIR}/.ninja_log"
+                          --json "${CMAKE_BINARY_DIR}/levelize.json"
+                          --dot "${CMAKE_BINARY_DIR}/levelize.dot"
+                DEPENDS "${all_lists_path}"
+            )
+        else()
+            file(APPEND "${all_lists_path}" "${file_list_path}\n")
         endif()
-        add_dependencies(check_cycles ${uor_name}.check_cycles)
+    endif()
+endfunction()
+
+# Create the '<uor>-shared' library from the object libraries the static UOR
+# 'target' is composed of, so that the sources are compiled only once.  The
+# object libraries are switched to position independent code and dependencies
+# that have a shared variant in this build tree are linked as shared.
+function(_bbs_setup_shared_uor_variant target)
+    get_target_property(uor_name ${target} NAME)
+    set(shared_target ${uor_name}-shared)
+
+    add_library(${shared_target} SHARED)
+    set_target_properties(${shared_target}
+                          PROPERTIES
+                          OUTPUT_NAME ${uor_name}
+                          LINKER_LANGUAGE CXX
+                          POSITION_INDEPENDENT_CODE ON)
+
+    bbs_add_target_bde_flags(${shared_target} PRIVATE)
+    bbs_add_target_thread_flags(${shared_target} PRIVATE)
+
+    get_target_property(link_libs ${target} LINK_LIBRARIES)
+    get_target_property(iface_libs ${target} INTERFACE_LINK_LIBRARIES)
+
+    set(shared_deps)
+    foreach(lib ${link_libs} ${iface_libs})
+        if (lib MATCHES "^\\$<")
+            continue()
+        endif()
+
+        if (lib IN_LIST link_libs)
+            set(scope PUBLIC)
+        else()
+            set(scope INTERFACE)
+        endif()
+
+        if (TARGET ${lib})
+            get_target_property(lib_type ${lib} TYPE)
+            if (lib_type STREQUAL "OBJECT_LIBRARY")
+                set_target_properties(${lib}
+                                      PROPERTIES
+                                      POSITION_INDEPENDENT_CODE ON)
+            endif()
+        endif()
+
+        if (TARGET ${lib}-shared)
+            set(lib ${lib}-shared)
+        endif()
+
+        if (NOT lib IN_LIST shared_deps)
+            list(APPEND shared_deps ${lib})
+            target_link_libraries(${shared_target} ${scope} ${lib})
+        endif()
+    endforeach()
+
+    bbs_import_target_dependencies(${shared_target} ${shared_deps})
+
+    bbs_uor_to_pc_name(${uor_name} pc_name)
+    if (NOT TARGET ${pc_name}-shared)
+        add_library(${pc_name}-shared ALIAS ${shared_target})
     endif()
 endfunction()
 
@@ -551,6 +736,11 @@ endfunction()
 #  * CUSTOM_PACKAGES  list of packages that provide their custom CML
 #  * PRIVATE_PACKAGES  list of packages that provide implementation details
 #    headers for those packages should not be installed.
+#
+#  If ``BBS_BUILD_SHARED_VARIANT`` is set, the sources of a static library UOR
+#  are compiled once into position independent OBJECT libraries, from which
+#  both the static library and a ``<uor>-shared`` shared library (with the
+#  same output name) are linked.
 function(bbs_setup_target_uor target)
     cmake_parse_arguments(PARSE_ARGV 1
                           ""
@@ -564,6 +754,8 @@ function(bbs_setup_target_uor target)
 
     message(VERBOSE "Processing target \"${target}\"")
 
+    bbs_profile_begin(bbs_setup_target_uor ${uor_name})
+
     # Use the current source directory if none is specified
     if (NOT _SOURCE_DIR)
         set(_SOURCE_DIR ${CMAKE_CURRENT_SOURCE_DIR})
@@ -593,6 +785,11 @@ function(bbs_setup_target_uor target)
     # Check if the target is a library or executable
     get_target_property(_target_type ${target} TYPE)
 
+    set(build_shared_variant FALSE)
+    if (BBS_BUILD_SHARED_VARIANT AND _target_type STREQUAL "STATIC_LIBRARY")
+        set(build_shared_variant TRUE)
+    endif()
+
     if (   _target_type STREQUAL "STATIC_LIBRARY"
         OR _target_type STREQUAL "SHARED_LIBRARY"
         OR _target_type STREQUAL "OBJECT_LIBRARY")
@@ -682,16 +879,19 @@ function(bbs_setup_target_uor target)
                     endif()
 
                     # Generating cpp03 headers, implementation and test files if any
+                    bbs_profile_begin(bbs_generate_cpp03_sources ${pkg})
                     bbs_generate_cpp03_sources("${${pkg}_INCLUDE_FILES}")
                     bbs_generate_cpp03_sources("${${pkg}_SOURCE_FILES}")
                     bbs_generate_cpp03_sources("${${pkg}_TEST_SOURCES}")
                     bbs_generate_cpp03_sources("${${pkg}_SPLIT_TEST_SOURCES}" IMMEDIATE)
+                    bbs_profile_end()
 
                     if (NOT _SKIP_TESTS)
                         bbs_configure_target_tests(${pkg}
                                                    TEST_SOURCES  ${${pkg}_TEST_SOURCES}
                                                    GTEST_SOURCES ${${pkg}_GTEST_SOURCES}
                                                    SPLIT_SOURCES ${${pkg}_SPLIT_TEST_SOURCES}
+                                                   BENCHMARK_SOURCES ${${pkg}_BENCHMARK_SOURCES}
                                                    TEST_DEPS     ${${pkg}_DEPENDS}
                                                                  ${${pkg}_TEST_DEPENDS}
                                                                  ${${uor_name}_PCDEPS}
@@ -713,7 +913,19 @@ function(bbs_setup_target_uor target)
             if (NOT _SKIP_TESTS)
                 set(import_test_deps ON)
                 set(import_gtest_deps ON)
+                set(import_benchmark_deps ON)
                 foreach(pkg ${${uor_name}_PACKAGES})
+                    if (${pkg}_BENCHMARK_TARGETS)
+                        if (NOT TARGET ${target}.b)
+                            add_custom_target(${target}.b)
+                        endif()
+                        add_dependencies(${target}.b ${${pkg}_BENCHMARK_TARGETS})
+                        if (import_benchmark_deps)
+                            # Import the benchmark library only once and only if we have benchmarks
+                            bbs_import_target_dependencies(${target} benchmark)
+                            set(import_benchmark_deps OFF)
+                        endif()
+                    endif()
                     if (${pkg}_TEST_TARGETS)
                         if (NOT TARGET ${target}.t)
                             add_custom_target(${target}.t)
@@ -739,7 +951,23 @@ function(bbs_setup_target_uor target)
             # Configure standalone library ( no packages ) and tests from BDE metadata
             message(VERBOSE "Adding library for ${target}")
             set_target_properties(${target} PROPERTIES LINKER_LANGUAGE CXX)
-            target_sources(${target} PRIVATE ${${uor_name}_SOURCE_FILES})
+            if (build_shared_variant)
+                # The sources are compiled once into an OBJECT library that
+                # is shared by the static and the shared library.
+                message(TRACE "Adding OBJECT library ${uor_name}-iface")
+                add_library(${uor_name}-iface
+                            OBJECT ${${uor_name}_SOURCE_FILES})
+                set_target_properties(${uor_name}-iface PROPERTIES LINKER_LANGUAGE CXX)
+                bbs_add_target_include_dirs(${uor_name}-iface PUBLIC ${${uor_name}_INCLUDE_DIRS})
+
+                bbs_add_target_bde_flags(${uor_name}-iface PRIVATE)
+                bbs_add_target_thread_flags(${uor_name}-iface PRIVATE)
+
+                target_link_libraries(${uor_name}-iface PRIVATE ${${uor_name}_PCDEPS})
+                target_link_libraries(${target} PUBLIC ${uor_name}-iface)
+            else()
+                target_sources(${target} PRIVATE ${${uor_name}_SOURCE_FILES})
+            endif()
             bbs_add_target_include_dirs(${target} PUBLIC ${${uor_name}_INCLUDE_DIRS})
 
             target_link_libraries(${target} PUBLIC ${${uor_name}_PCDEPS})
@@ -752,6 +980,7 @@ function(bbs_setup_target_uor target)
                                            TEST_SOURCES  ${${uor_name}_TEST_SOURCES}
                                            GTEST_SOURCES ${${uor_name}_GTEST_SOURCES}
                                            SPLIT_SOURCES ${${uor_name}_SPLIT_TEST_SOURCES}
+                                           BENCHMARK_SOURCES ${${uor_name}_BENCHMARK_SOURCES}
                                            TEST_DEPS     ${${uor_name}_PCDEPS}
                                                          ${${uor_name}_TEST_PCDEPS}
                                            LABELS        "all" ${target})
@@ -761,9 +990,16 @@ function(bbs_setup_target_uor target)
                 if (${target}_GTEST_SOURCES)
                     bbs_import_target_dependencies(${target} gtest)
                 endif()
+                if (${target}_BENCHMARK_TARGETS)
+                    bbs_import_target_dependencies(${target} benchmark)
+                endif()
             endif()
         endif()
 
+        if (build_shared_variant)
+            _bbs_setup_shared_uor_variant(${target})
+        endif()
+
         # Generating .pc file. This will be a noop in non-Bloomberg build env (TODO:fix)
         if (NOT _NO_EMIT_PKG_CONFIG_FILE)
             bbs_emit_pkg_config(${target})
@@ -869,6 +1105,7 @@ function(bbs_setup_target_uor target)
                                        TEST_SOURCES  ${${uor_name}_TEST_SOURCES}
                                        GTEST_SOURCES ${${uor_name}_GTEST_SOURCES}
                                        SPLIT_SOURCES ${${uor_name}_SPLIT_TEST_SOURCES}
+                                       BENCHMARK_SOURCES ${${uor_name}_BENCHMARK_SOURCES}
                                        TEST_DEPS     ${${uor_name}_PCDEPS}
                                                      ${${uor_name}_TEST_PCDEPS}
                                        LABELS        "all" ${target})
@@ -882,6 +1119,13 @@ function(bbs_setup_target_uor target)
             if (${lib_target}_TEST_TARGETS)
                 bbs_import_target_dependencies(${lib_target} ${${uor_name}_TEST_PCDEPS})
             endif()
+            if (${lib_target}_BENCHMARK_TARGETS)
+                if (NOT TARGET ${target}.b)
+                    add_custom_target(${target}.b)
+                endif()
+                add_dependencies(${target}.b ${lib_target}.b)
+                bbs_import_target_dependencies(${lib_target} benchmark)
+            endif()
         endif()
     else()
         # Not a library or an application
@@ -893,6 +1137,8 @@ function(bbs_setup_target_uor target)
         _target_type STREQUAL "EXECUTABLE")
         bbs_install_target(${target})
     endif()
+
+    bbs_profile_end()
 endfunction()
 
 function(bbs_setup_header_only_pkg pkg)
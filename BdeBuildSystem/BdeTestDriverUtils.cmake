@@ -27,6 +27,27 @@ endif()
 
 set(BBS_RUNTEST "${BBS_RUNTEST}" CACHE INTERNAL "")
 
+find_file(BBS_FUZZ_PATH bbs_fuzz.py
+          PATHS "${CMAKE_CURRENT_LIST_DIR}/scripts")
+
+if (NOT BBS_FUZZ_PATH)
+    message(FATAL_ERROR "Failed to find bbs_fuzz")
+endif()
+
+set(BBS_FUZZ ${Python3_EXECUTABLE} ${BBS_FUZZ_PATH} CACHE INTERNAL "")
+
+set(BBS_FUZZ_MAX_TOTAL_TIME "60" CACHE STRING
+    "Time budget in seconds of each fuzz-enabled test driver run by the 'fuzz' target")
+
+set(BBS_FUZZ_ARGS "" CACHE STRING
+    "Additional arguments of bbs_fuzz for the 'fuzz' target (e.g. '--jobs 8;--merge')")
+
+set(BBS_RUNTEST_JOBS "" CACHE STRING
+    "Number of test cases runtest runs in parallel for each test driver (runtest default if empty)")
+
+set(BBS_TEST_COST_DATA "" CACHE STRING
+    "List of files with recorded test durations (e.g. the CTestCostData.txt of another build) used to set the COST of the tests")
+
 find_file(BBS_SPLIT_TEST_PATH bde_xt_cpp_splitter.py
           PATHS "${CMAKE_CURRENT_LIST_DIR}/scripts/bde_xt_cpp_splitter")
 
@@ -43,11 +64,183 @@ else()
     message(FATAL_ERROR "Failed to find test split generator")
 endif()
 
+set(BBS_XT_SPLIT_PARTS "table" CACHE STRING
+    "How the test cases of xt test drivers are assigned to parts: 'table' follows the PARTS definition, 'auto' bin-packs them by cost")
+set_property(CACHE BBS_XT_SPLIT_PARTS PROPERTY STRINGS table auto)
+
+set(BBS_XT_SPLIT_NUM_PARTS "" CACHE STRING
+    "Number of parts of the xt test drivers in 'auto' parts mode (number of parts of the PARTS definition if empty)")
+
+set(BBS_XT_SPLIT_MAX_PART_COST "" CACHE STRING
+    "Create the fewest parts costing at most this many seconds in 'auto' parts mode")
+
+set(BBS_XT_SPLIT_COST_FILE "" CACHE FILEPATH
+    "File with the measured compile and run times of the xt test cases used in 'auto' parts mode")
+
+option(BBS_XT_SPLIT_SHARED_CODE
+       "Compile the SHARED CODE blocks of xt test drivers once into an object library linked into all the parts"
+       OFF)
+
+# Add the 'fuzz' target running a libFuzzer campaign on the fuzz-enabled test
+# drivers of the build, keeping the corpora and the failing inputs in the
+# 'fuzz' directory of the build.  The target is only added to fuzz builds.
+function(_bbs_add_fuzz_target)
+    if (NOT BDE_BUILD_TARGET_FUZZ OR TARGET fuzz)
+        return()
+    endif()
+
+    add_custom_target(fuzz
+        COMMAND ${BBS_FUZZ} run
+                --max-total-time ${BBS_FUZZ_MAX_TOTAL_TIME}
+                --json "${CMAKE_BINARY_DIR}/fuzz/report.json"
+                ${BBS_FUZZ_ARGS}
+                "${CMAKE_BINARY_DIR}/tests"
+        WORKING_DIRECTORY "${CMAKE_BINARY_DIR}"
+        USES_TERMINAL
+        COMMENT "Fuzzing the test drivers")
+    add_dependencies(fuzz all.t)
+endfunction()
+
+# Return in the specified 'result' the arguments selecting the parts mode of the
+# test splitter.
+function(_bbs_get_split_test_args result)
+    set(args "")
+    if (BBS_XT_SPLIT_PARTS STREQUAL "auto")
+        list(APPEND args --parts auto)
+        if (BBS_XT_SPLIT_NUM_PARTS)
+            list(APPEND args --num-parts ${BBS_XT_SPLIT_NUM_PARTS})
+        endif()
+        if (BBS_XT_SPLIT_MAX_PART_COST)
+            list(APPEND args --max-part-cost ${BBS_XT_SPLIT_MAX_PART_COST})
+        endif()
+        if (BBS_XT_SPLIT_COST_FILE)
+            list(APPEND args --cost-file ${BBS_XT_SPLIT_COST_FILE})
+        endif()
+    elseif (NOT BBS_XT_SPLIT_PARTS STREQUAL "table")
+        message(FATAL_ERROR "Invalid BBS_XT_SPLIT_PARTS: '${BBS_XT_SPLIT_PARTS}', expected 'table' or 'auto'")
+    endif()
+    if (BBS_XT_SPLIT_SHARED_CODE)
+        list(APPEND args --shared-code)
+    endif()
+    set(${result} ${args} PARENT_SCOPE)
+endfunction()
+
+# Return in the specified 'result' the recorded duration of the specified
+# 'test', or an empty string if there is none.  The duration files listed in
+# 'BBS_TEST_COST_DATA' are read on first use.  Each line of a duration file
+# contains a test name followed by either the number of runs and the average
+# duration (the format of the 'CTestCostData.txt' file written by ctest) or just
+# the duration in seconds.  Lines after a '---' line (the list of the failed
+# tests in 'CTestCostData.txt') are ignored.  The average of the durations
+# recorded for a test, weighted by their number of runs, is used.  Durations not
+# written as decimal numbers are ignored.
+function(_bbs_get_test_cost test result)
+    get_property(loaded GLOBAL PROPERTY _BBS_TEST_COST_DATA_LOADED)
+    if (NOT loaded)
+        set_property(GLOBAL PROPERTY _BBS_TEST_COST_DATA_LOADED TRUE)
+        foreach(cost_file ${BBS_TEST_COST_DATA})
+            get_filename_component(cost_file "${cost_file}" ABSOLUTE BASE_DIR ${CMAKE_BINARY_DIR})
+            if (NOT EXISTS "${cost_file}")
+                continue()
+            endif()
+
+            message(VERBOSE "Reading test durations from ${cost_file}")
+            file(STRINGS "${cost_file}" lines)
+            foreach(line IN LISTS lines)
+                if (line STREQUAL "---")
+                    break()
+                endif()
+
+                if (line MATCHES "^([^ ]+) +([0-9]+) +([0-9.eE+-]+)$")
+                    set(name ${CMAKE_MATCH_1})
+                    set(runs ${CMAKE_MATCH_2})
+                    set(cost ${CMAKE_MATCH_3})
+                elseif (line MATCHES "^([^ ]+) +([0-9.eE+-]+)$")
+                    set(name ${CMAKE_MATCH_1})
+                    set(runs 1)
+                    set(cost ${CMAKE_MATCH_2})
+                else()
+                    continue()
+                endif()
+
+                # CMake only has integer arithmetic: sum the durations in
+                # milliseconds.
+                if (runs EQUAL 0 OR NOT cost MATCHES "^([0-9]*)(\\.([0-9]*))?$")
+                    continue()
+                endif()
+                set(seconds "${CMAKE_MATCH_1}")
+                string(SUBSTRING "${CMAKE_MATCH_3}000" 0 3 millis)
+                math(EXPR cost_ms "0${seconds} * 1000 + 1${millis} - 1000")
+
+                get_property(sum GLOBAL PROPERTY _BBS_TEST_COST_SUM_${name})
+                get_property(count GLOBAL PROPERTY _BBS_TEST_COST_RUNS_${name})
+                math(EXPR sum "0${sum} + ${cost_ms} * ${runs}")
+                math(EXPR count "0${count} + ${runs}")
+                set_property(GLOBAL PROPERTY _BBS_TEST_COST_SUM_${name} ${sum})
+                set_property(GLOBAL PROPERTY _BBS_TEST_COST_RUNS_${name} ${count})
+            endforeach()
+        endforeach()
+    endif()
+
+    set(cost "")
+    get_property(sum GLOBAL PROPERTY _BBS_TEST_COST_SUM_${test})
+    get_property(count GLOBAL PROPERTY _BBS_TEST_COST_RUNS_${test})
+    if (count)
+        math(EXPR cost_ms "${sum} / ${count}")
+        math(EXPR seconds "${cost_ms} / 1000")
+        math(EXPR millis "1000 + ${cost_ms} % 1000")
+        string(SUBSTRING "${millis}" 1 3 millis)
+        set(cost "${seconds}.${millis}")
+    endif()
+    set(${result} "${cost}" PARENT_SCOPE)
+endfunction()
+
+# Set the COST property of the specified 'test' from its recorded duration, so
+# that ctest starts the slowest tests first.
+function(_bbs_set_test_cost test)
+    _bbs_get_test_cost(${test} cost)
+    if (cost)
+        set_property(TEST ${test} PROPERTY COST ${cost})
+    endif()
+endfunction()
+
+# Find the number of jobs the test runner will use with the specified
+# 'extra_args'.  Set 'jobs_args_var' to the arguments to pass to the test
+# runner and 'jobs_var' to the number of jobs.
+function(_bbs_get_runtest_jobs extra_args jobs_args_var jobs_var)
+    set(jobs_args "")
+    set(jobs 2)
+    if (BBS_RUNTEST_JOBS)
+        set(jobs_args -j ${BBS_RUNTEST_JOBS})
+        set(jobs ${BBS_RUNTEST_JOBS})
+    endif()
+    set(prev_arg "")
+    foreach(arg ${extra_args})
+        if (prev_arg STREQUAL "-j" OR prev_arg STREQUAL "--jobs")
+            set(jobs ${arg})
+        elseif (arg MATCHES "^(-j|--jobs=)([0-9]+)$")
+            set(jobs ${CMAKE_MATCH_2})
+        endif()
+        set(prev_arg ${arg})
+    endforeach()
+    set(${jobs_args_var} ${jobs_args} PARENT_SCOPE)
+    set(${jobs_var} ${jobs} PARENT_SCOPE)
+endfunction()
+
 #[[.rst:
 .. command:: bbs_add_bde_style_test
 
 Add the [executable] ``target`` as a BDE test and create ctest labels for it.
 
+The ``COST`` property of the test is set from the durations recorded in the
+files listed in ``BBS_TEST_COST_DATA`` (for example the ``CTestCostData.txt``
+file written by ctest in another build directory) so that ctest starts the
+slowest test drivers first.  The average recorded duration is used.  Without
+such files ctest tracks the cost of the tests itself.  The ``PROCESSORS``
+property of the test is set to the number of test cases run in parallel by the
+test runner, that is the value of the ``--jobs`` option passed in
+``EXTRA_ARGS``, or ``BBS_RUNTEST_JOBS``, or the runner default of 2.
+
 .. code-block:: cmake
 
    bbs_add_bde_style_test(target
@@ -75,10 +268,15 @@ function(bbs_add_bde_style_test target)
         set(_TEST_VERBOSITY 0)
     endif()
 
+    _bbs_get_runtest_jobs("${_EXTRA_ARGS}" jobs_args jobs)
+
     add_test(NAME ${target}
-             COMMAND ${BBS_RUNTEST} -v ${_TEST_VERBOSITY} ${_EXTRA_ARGS} $<TARGET_FILE:${target}>
+             COMMAND ${BBS_RUNTEST} -v ${_TEST_VERBOSITY} ${jobs_args} ${_EXTRA_ARGS} $<TARGET_FILE:${target}>
              WORKING_DIRECTORY ${_WORKING_DIRECTORY})
 
+    set_property(TEST ${target} PROPERTY PROCESSORS ${jobs})
+    _bbs_set_test_cost(${target})
+
     foreach (label ${_LABELS})
         set_property(TEST ${target} APPEND PROPERTY LABELS ${label} "${label}.t")
     endforeach()
@@ -90,6 +288,19 @@ endfunction()
 Generate build targets [executables] for the specified ``TEST_SOURCES``, add them as
 BDE tests and generate necessary build dependencies and test labels.
 
+The ``SPLIT_SOURCES`` are split into parts by the test splitter.  The test
+cases are assigned to the parts following the PARTS definition of each test
+driver, unless ``BBS_XT_SPLIT_PARTS`` is ``auto``: then the test cases and
+slices are bin-packed into ``BBS_XT_SPLIT_NUM_PARTS`` parts (or into parts
+costing at most ``BBS_XT_SPLIT_MAX_PART_COST`` seconds) using the costs
+measured in ``BBS_XT_SPLIT_COST_FILE``.  If ``BBS_XT_SPLIT_SHARED_CODE`` is
+``ON`` the ``SHARED CODE`` blocks of each test driver are compiled once into the
+``<test>.shared`` object library that is linked into all of its parts.
+
+In a ``BDE_BUILD_TARGET_FUZZ`` build the test drivers are linked with libFuzzer
+and the ``fuzz`` target runs ``bbs_fuzz`` on the fuzz-enabled ones for
+``BBS_FUZZ_MAX_TOTAL_TIME`` seconds each (see ``BBS_FUZZ_ARGS``).
+
 .. code-block:: cmake
 
    bbs_add_component_tests(target
@@ -116,6 +327,8 @@ function(bbs_add_component_tests target)
         message(FATAL_ERROR "No sources for the test ${target}")
     endif()
 
+    bbs_profile_begin(bbs_add_component_tests ${target})
+
     # This function can be called few times for BDE tests, gtest and split tests.
     # We want to "continue" to populate the list set by previous calls.
     set(test_targets ${${target}_TEST_TARGETS})
@@ -155,6 +368,7 @@ function(bbs_add_component_tests target)
 
         if (BDE_BUILD_TARGET_FUZZ)
             target_link_libraries(${test_target_name}.t PRIVATE "-fsanitize=fuzzer")
+            _bbs_add_fuzz_target()
         endif()
 
         set(test_src_labels ${test_name})
@@ -213,6 +427,13 @@ function(bbs_add_component_tests target)
     set(split_cpp03_test_srcs ${_SPLIT_SOURCES})
     list(FILTER split_cpp03_test_srcs INCLUDE REGEX "_cpp03\.")
 
+    # Split all the test drivers of the package with a single invocation of the
+    # splitter that processes them in parallel.  The tests of a package group
+    # are configured per package ('target' is the package), and a standalone
+    # package is its own UOR target, so this is one batch per package.  The
+    # build time regeneration below still splits each test driver individually.
+    set(split_test_srcs)
+    set(split_batch_content "")
     foreach(test_src ${_SPLIT_SOURCES})
         # Stripping all extentions from the test source ( including numbers
         # from the numbered tests )
@@ -222,6 +443,43 @@ function(bbs_add_component_tests target)
             continue()
         endif()
 
+        # Creating output folder
+        set(td_output_dir "${CMAKE_CURRENT_BINARY_DIR}/${test_name}_split")
+
+        # remove temp file if it exists so that it will only contain what we generate
+        if(NOT EXISTS "${td_output_dir}")
+            file(MAKE_DIRECTORY "${td_output_dir}")
+        endif()
+
+        list(APPEND split_test_srcs ${test_src})
+        string(APPEND split_batch_content
+               "${test_src}\t${td_output_dir}\t${td_output_dir}/${test_name}.stamp\n")
+    endforeach()
+
+    _bbs_get_split_test_args(split_args)
+    set(split_depends)
+    if (split_args AND BBS_XT_SPLIT_COST_FILE)
+        set(split_depends ${BBS_XT_SPLIT_COST_FILE})
+        set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${BBS_XT_SPLIT_COST_FILE})
+    endif()
+
+    if (split_test_srcs)
+        set(split_batch_file "${CMAKE_CURRENT_BINARY_DIR}/CMakeFiles/${target}.xt_split.batch.txt")
+        file(WRITE "${split_batch_file}" "${split_batch_content}")
+
+        bbs_profile_begin(bde_xt_cpp_splitter ${target})
+        execute_process(
+            COMMAND ${BBS_SPLIT_TEST} ${split_args} --batch-file ${split_batch_file}
+            WORKING_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}
+            COMMAND_ERROR_IS_FATAL ANY)
+        bbs_profile_end()
+    endif()
+
+    foreach(test_src ${split_test_srcs})
+        # Stripping all extentions from the test source ( including numbers
+        # from the numbered tests )
+        get_filename_component(test_name ${test_src} NAME_WE)
+
         # Stripping last 2 extentions from the test source (.xt.cpp)
         get_filename_component(test_target_name ${test_src} NAME_WLE)
         get_filename_component(test_target_name ${test_target_name} NAME_WLE)
@@ -233,21 +491,12 @@ function(bbs_add_component_tests target)
             set(test_has_cpp03 FALSE)
         endif()
 
-        # Creating output folder
+        # Output folder (created above)
         set(td_output_dir "${CMAKE_CURRENT_BINARY_DIR}/${test_name}_split")
 
-        # remove temp file if it exists so that it will only contain what we generate
-        if(NOT EXISTS "${td_output_dir}")
-            file(MAKE_DIRECTORY "${td_output_dir}")
-        endif()
-
         set(stamp_file ${td_output_dir}/${test_name}.stamp)
 
-        set(command ${BBS_SPLIT_TEST} -o ${td_output_dir} -s ${test_name}.stamp ${test_src})
-        execute_process(
-            COMMAND ${command}
-            WORKING_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}
-            COMMAND_ERROR_IS_FATAL ANY)
+        set(command ${BBS_SPLIT_TEST} ${split_args} -o ${td_output_dir} -s ${test_name}.stamp ${test_src})
 
         file(STRINGS ${stamp_file} td_cpp_files)
 
@@ -256,6 +505,13 @@ function(bbs_add_component_tests target)
             list(APPEND outputs ${td_output_dir}/${split_test})
         endforeach()
 
+        # The splitter always writes the shared translation unit in shared code
+        # mode (empty if the test driver has no shared code).
+        set(shared_src "${td_output_dir}/${test_name}.shared.t.cpp")
+        if (BBS_XT_SPLIT_SHARED_CODE)
+            list(APPEND outputs ${shared_src})
+        endif()
+
         if( ${CMAKE_VERSION} VERSION_GREATER_EQUAL 3.27.0)
             set(command_extra_flags DEPENDS_EXPLICIT_ONLY)
             set(configure_dependency ${stamp_file})
@@ -269,6 +525,7 @@ function(bbs_add_component_tests target)
             COMMAND ${command}
             WORKING_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}
             MAIN_DEPENDENCY ${test_src}
+            DEPENDS ${split_depends}
             ${command_extra_flags})
         set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${configure_dependency})
 
@@ -289,6 +546,17 @@ function(bbs_add_component_tests target)
             add_custom_target(all.t)
         endif()
 
+        set(shared_target "")
+        if (BBS_XT_SPLIT_SHARED_CODE AND NOT ${test_name} MATCHES "_cpp03")
+            set(shared_target ${test_name}.shared)
+            add_library(${shared_target} OBJECT EXCLUDE_FROM_ALL ${shared_src})
+
+            bbs_add_target_bde_flags(${shared_target} PRIVATE)
+            bbs_add_target_thread_flags(${shared_target} PRIVATE)
+
+            target_link_libraries(${shared_target} PUBLIC ${target} ${_TEST_DEPS})
+        endif()
+
         # Processing individual tests and adding them to the target test
         foreach(split_test ${td_cpp_files})
             get_filename_component(split_target_name ${split_test} NAME_WLE)
@@ -309,8 +577,13 @@ function(bbs_add_component_tests target)
 
                 target_link_libraries(${split_target_name}.t PUBLIC ${target} ${_TEST_DEPS})
 
+                if (shared_target)
+                    target_link_libraries(${split_target_name}.t PRIVATE ${shared_target})
+                endif()
+
                 if (BDE_BUILD_TARGET_FUZZ)
                     target_link_libraries(${split_target_name}.t PRIVATE "-fsanitize=fuzzer")
+                    _bbs_add_fuzz_target()
                 endif()
 
                 bbs_add_bde_style_test(${split_target_name}.t
@@ -336,4 +609,6 @@ function(bbs_add_component_tests target)
     endforeach()
 
     set(${target}_TEST_TARGETS "${test_targets}" PARENT_SCOPE)
+
+    bbs_profile_end()
 endfunction()
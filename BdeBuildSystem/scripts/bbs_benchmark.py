@@ -0,0 +1,281 @@
+"""Run a Google Benchmark driver and compare its results with a baseline.
+
+The driver is run with its results written in the JSON format of Google
+Benchmark.  Each benchmark is repeated and summarized by the median of the
+repetitions.  If a baseline file (the JSON results of an earlier run) is
+specified, each benchmark is compared with its baseline and the run fails if
+a benchmark is slower than its baseline by more than the threshold.
+
+Exit codes: 0 on success, 1 on failure or regression, and 77 (reported as
+skipped by ctest) if the benchmark driver was not built.
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+SKIP_RETURN_CODE = 77
+
+_TIME_UNIT_TO_NS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def summarize(results, metric):
+    """Return a dictionary mapping the name of each benchmark of the
+    specified Google Benchmark JSON 'results' to its time in nanoseconds.
+
+    Args:
+        results (dict): Google Benchmark JSON results.
+        metric (str): 'real_time' or 'cpu_time'.
+
+    Returns:
+        The median aggregate of each benchmark if the benchmarks were
+        repeated, and the mean of the iterations otherwise.
+    """
+    medians = {}
+    iterations = {}
+    for entry in results.get("benchmarks", []):
+        if entry.get("error_occurred"):
+            continue
+        name = entry.get("run_name", entry["name"])
+        value = entry[metric] * _TIME_UNIT_TO_NS[entry.get("time_unit", "ns")]
+        if entry.get("run_type") == "aggregate":
+            if entry.get("aggregate_name") == "median":
+                medians[name] = value
+        else:
+            iterations.setdefault(name, []).append(value)
+
+    rv = {
+        name: sum(values) / len(values) for name, values in iterations.items()
+    }
+    rv.update(medians)
+    return rv
+
+
+def compare(current, baseline, threshold):
+    """Compare the specified summaries of the current and baseline results.
+
+    Args:
+        current (dict): Benchmark name to time of the current run.
+        baseline (dict): Benchmark name to time of the baseline.
+        threshold (float): Slowdown in percent reported as a regression.
+
+    Returns:
+        A list of '(name, current, baseline, change, status)' tuples, one per
+        benchmark of either summary, where 'change' is the change in percent
+        (or None) and 'status' one of 'ok', 'REGRESSION', 'improved', 'new'
+        and 'missing'.
+    """
+    rows = []
+    for name in sorted(set(current) | set(baseline)):
+        cur = current.get(name)
+        base = baseline.get(name)
+        if base is None:
+            rows.append((name, cur, None, None, "new"))
+        elif cur is None:
+            rows.append((name, None, base, None, "missing"))
+        else:
+            change = (cur - base) / base * 100 if base else 0.0
+            if change > threshold:
+                status = "REGRESSION"
+            elif change < -threshold:
+                status = "improved"
+            else:
+                status = "ok"
+            rows.append((name, cur, base, change, status))
+    return rows
+
+
+def _format_ns(value):
+    if value is None:
+        return "-"
+    for unit, factor in (("s", 1e9), ("ms", 1e6), ("us", 1e3)):
+        if value >= factor:
+            return "%.3f%s" % (value / factor, unit)
+    return "%.1fns" % value
+
+
+def format_rows(rows):
+    width = max([len("BENCHMARK")] + [len(row[0]) for row in rows])
+    lines = [
+        "%-*s %12s %12s %9s  %s"
+        % (width, "BENCHMARK", "TIME", "BASELINE", "CHANGE", "STATUS")
+    ]
+    for name, cur, base, change, status in rows:
+        lines.append(
+            "%-*s %12s %12s %9s  %s"
+            % (
+                width,
+                name,
+                _format_ns(cur),
+                _format_ns(base),
+                "-" if change is None else "%+.1f%%" % change,
+                status,
+            )
+        )
+    return "\n".join(lines)
+
+
+def run_driver(driver, json_path, repetitions, benchmark_filter, extra_args):
+    """Run the specified benchmark driver writing its JSON results to the
+    specified path, and return its exit code."""
+    cmd = [
+        driver,
+        "--benchmark_out=%s" % json_path,
+        "--benchmark_out_format=json",
+    ]
+    if repetitions > 1:
+        cmd += [
+            "--benchmark_repetitions=%d" % repetitions,
+            "--benchmark_report_aggregates_only=true",
+        ]
+    if benchmark_filter:
+        cmd.append("--benchmark_filter=%s" % benchmark_filter)
+    cmd += extra_args
+
+    print(" ".join(cmd))
+    sys.stdout.flush()
+    return subprocess.call(cmd)
+
+
+def get_cmdline_parser():
+    parser = argparse.ArgumentParser(
+        prog="bbs_benchmark",
+        description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+    )
+    parser.add_argument("driver", help="path to the benchmark driver")
+    parser.add_argument(
+        "--json", help="file to write the results to (JSON format)"
+    )
+    parser.add_argument(
+        "--baseline",
+        help="JSON results to compare with, ignored if the file does not "
+        "exist",
+    )
+    parser.add_argument(
+        "--update-baseline",
+        action="store_true",
+        help="write the results to the baseline file instead of comparing",
+    )
+    parser.add_argument(
+        "--threshold",
+        type=float,
+        default=10.0,
+        help="slowdown in percent reported as a regression "
+        "[default: %(default)s]",
+    )
+    parser.add_argument(
+        "--metric",
+        choices=("real_time", "cpu_time"),
+        default="cpu_time",
+        help="time compared with the baseline [default: %(default)s]",
+    )
+    parser.add_argument(
+        "--repetitions",
+        type=int,
+        default=5,
+        help="number of repetitions of each benchmark, the median of which "
+        "is used [default: %(default)s]",
+    )
+    parser.add_argument(
+        "--filter", help="regular expression selecting the benchmarks"
+    )
+    parser.add_argument(
+        "--no-fail",
+        action="store_true",
+        help="report regressions without failing",
+    )
+    parser.add_argument(
+        "--driver-arg",
+        dest="driver_args",
+        action="append",
+        default=[],
+        help="additional argument of the driver, may be repeated",
+    )
+    return parser
+
+
+def main():
+    args = get_cmdline_parser().parse_args()
+
+    if not os.path.isfile(args.driver):
+        print("%s does not exist (build 'all.b')" % args.driver)
+        sys.exit(SKIP_RETURN_CODE)
+
+    temp_dir = tempfile.mkdtemp()
+    try:
+        json_path = os.path.join(temp_dir, "results.json")
+        rc = run_driver(
+            args.driver,
+            json_path,
+            args.repetitions,
+            args.filter,
+            args.driver_args,
+        )
+        if rc != 0 or not os.path.isfile(json_path):
+            print("BENCHMARK FAILED (rc %d)" % rc)
+            sys.exit(1)
+
+        if args.json:
+            json_dir = os.path.dirname(os.path.abspath(args.json))
+            if not os.path.isdir(json_dir):
+                os.makedirs(json_dir)
+            shutil.copyfile(json_path, args.json)
+
+        if args.update_baseline:
+            if not args.baseline:
+                print("--update-baseline requires --baseline")
+                sys.exit(1)
+            shutil.copyfile(json_path, args.baseline)
+            print("Updated baseline %s" % args.baseline)
+            sys.exit(0)
+
+        with open(json_path) as f:
+            current = summarize(json.load(f), args.metric)
+    finally:
+        shutil.rmtree(temp_dir, ignore_errors=True)
+
+    baseline = {}
+    if args.baseline and os.path.isfile(args.baseline):
+        with open(args.baseline) as f:
+            baseline = summarize(json.load(f), args.metric)
+    elif args.baseline:
+        print("No baseline %s" % args.baseline)
+
+    rows = compare(current, baseline, args.threshold)
+    print(format_rows(rows))
+
+    regressions = [row for row in rows if row[4] == "REGRESSION"]
+    if regressions:
+        print(
+            "%d benchmark(s) slower than the baseline by more than %g%%"
+            % (len(regressions), args.threshold)
+        )
+        if not args.no_fail:
+            sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
+
+# -----------------------------------------------------------------------------
+# Copyright 2025 Bloomberg Finance L.P.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ----------------------------- END-OF-FILE -----------------------------------
@@ -1,22 +1,25 @@
 from __future__ import annotations
 
 import argparse
+import concurrent.futures
 import logging
 import os
 
 from dataclasses import dataclass
 from pathlib import Path
 from enum import Enum
-from typing import Tuple
+from typing import List, Sequence, Tuple
 
 from lib.generateParts import generateTestcasesToPartsMapping
 from lib import (
     parseComponentName,
     generatePartsFromXtCpp,
+    generateSharedPartFromXtCpp,
     parseXtCpp,
     XtCppParseError,
     writeOutputForXtCpp,
 )
+from lib.autoParts import AutoPartsConfig
 from lib.myConstants import MY_CONTROL_COMMENT_PREFIX
 
 
@@ -52,6 +55,25 @@ def _verifyGroupsDirectoryArg(groupsDirectoryPath: str) -> str:
     return groupsDirectoryPath
 
 
+def _verifyCostFileArg(costFileName: str) -> Path:
+    _verifyTypeAndAccess(Path(costFileName), FileType.FILE, os.R_OK)
+    return Path(costFileName).resolve()
+
+
+def _positiveIntArg(text: str) -> int:
+    value = int(text)
+    if value < 1 or value > 99:
+        raise argparse.ArgumentTypeError(f"'{text}' is not a number of parts between 1 and 99")
+    return value
+
+
+def _positiveFloatArg(text: str) -> float:
+    value = float(text)
+    if value <= 0:
+        raise argparse.ArgumentTypeError(f"'{text}' is not a positive number")
+    return value
+
+
 def _verifyStampPathArg(stampFileName: str) -> str:
     stampPath = Path(stampFileName)
 
@@ -167,6 +189,11 @@ class ParsedSourcePathArg:
 
 class _XtCppPathArgAction(argparse.Action):
     def __call__(self, parser, namespace, values, option_string=None):
+        if values is None:
+            # The optional positional argument is absent (--batch-file is used)
+            setattr(namespace, self.dest, None)
+            return  # !!! RETURN
+
         if not isinstance(values, str):
             parser.error(f"Unexpected command line argument type: '{type(values)}', {values!r}")
 
@@ -238,10 +265,27 @@ def makeArgParser() -> argparse.ArgumentParser:
         "-o",
         "--outdir",
         "--output-directory",
-        required=True,
         type=_verifyOutputDirectoryArg,
         help="Write the generated test driver source file into this directory.  Also used with "
-        "--dump-help.",
+        "--dump-help.  Required unless --batch-file is used.",
+    )
+
+    mainArgParser.add_argument(
+        "-b",
+        "--batch-file",
+        type=argparse.FileType("r"),
+        help="Split every test driver listed in the specified file in one invocation.  Each "
+        "non-empty line that does not start with '#' contains the xt.cpp path, the output "
+        "directory, and the stamp file path separated by tabs (the stamp file may be empty "
+        "to use the default).  Cannot be combined with -o, -s, or an xt.cpp argument.",
+    )
+
+    mainArgParser.add_argument(
+        "-j",
+        "--jobs",
+        type=int,
+        default=0,
+        help="Number of worker processes used with --batch-file, default is the number of CPUs.",
     )
 
     mainArgParser.add_argument(
@@ -278,8 +322,46 @@ def makeArgParser() -> argparse.ArgumentParser:
     )
     mainArgParser.set_defaults(line_directives=None)
 
+    mainArgParser.add_argument(
+        "--parts",
+        choices=["table", "auto"],
+        default="table",
+        help="How test cases are assigned to parts.  'table' (the default) follows the PARTS "
+        "definition of the test driver.  'auto' bin-packs the test cases and slices into parts "
+        "of similar cost, using the costs from --cost-file.",
+    )
+    autoPartsGroup = mainArgParser.add_mutually_exclusive_group()
+    autoPartsGroup.add_argument(
+        "--num-parts",
+        type=_positiveIntArg,
+        help="The number of parts to create in 'auto' parts mode, default is the number of parts "
+        "of the PARTS definition.",
+    )
+    autoPartsGroup.add_argument(
+        "--max-part-cost",
+        type=_positiveFloatArg,
+        help="Create the fewest parts that each cost at most this many seconds in 'auto' parts "
+        "mode.",
+    )
+    mainArgParser.add_argument(
+        "--cost-file",
+        type=_verifyCostFileArg,
+        help="File with measured compile and run times of test cases used in 'auto' parts mode.  "
+        "Each line has the form 'component case[.slice] compile-seconds [run-seconds]', where "
+        "'case' may also be 'prologue' for the cost shared by every part.",
+    )
+
+    mainArgParser.add_argument(
+        "--shared-code",
+        action="store_true",
+        help="Move the code of the SHARED CODE blocks into a separate '.shared.t.cpp' "
+        "translation unit that is compiled once and linked into every part.  The file is always "
+        "written in this mode, it is empty when there are no such blocks.",
+    )
+
     mainArgParser.add_argument(
         "xtCppPath",
+        nargs="?",
         help="The path to the xt.cpp test driver file used as input.",
         action=_XtCppPathArgAction,
     )
@@ -293,69 +375,187 @@ def logCommandlineArguments(args: argparse.Namespace) -> None:
         logging.info(f"    {name} = {val}")
 
 
-@dataclass(init=False, eq=False, order=False)
-class ParsedArgs:
-    loglevel: str
+@dataclass(frozen=True)
+class SplitJob:
     xtCppPath: Path
     xtCppComponent: str
     outDirectory: Path
     stampFilePath: Path
     groupsDirsPath: Tuple[Path, ...]
     useLineDirectives: bool | None
+    autoParts: AutoPartsConfig | None
+    sharedCode: bool
+
+
+def _makeSplitJob(
+    xtCppArg: ParsedSourcePathArg,
+    outDirectory: Path,
+    stampFileName: str | None,
+    groupsDirs: Sequence[Path],
+    useLineDirectives: bool | None,
+    autoParts: AutoPartsConfig | None,
+    sharedCode: bool,
+) -> SplitJob:
+    xtCppPath = xtCppArg.filePath
+
+    stampFilePath = Path(stampFileName if stampFileName else f"{xtCppPath.name}.stamp")
+
+    # If there is no path in the stamp file argument put it into the output directory
+    if len(stampFilePath.parts) == 1:
+        stampFilePath = outDirectory / stampFilePath
+
+    # Add the 'groups' directory from the input file to the groups search path, if the path
+    # actually ends in .../groups/grp/grppkg (like .../groups/bsl/bslstl)
+    groupsDirs = list(groupsDirs)
+    resolvedPath = xtCppPath.resolve()
+    packageDir = resolvedPath.parent
+    groupDir = packageDir.parent
+    groupsDir = groupDir.parent
+
+    if groupsDir.name == "groups" and groupDir.name == xtCppArg.group:
+        groupsDirs.append(groupsDir)
+
+    return SplitJob(
+        xtCppPath,
+        xtCppArg.qualifiedComponentName,
+        outDirectory,
+        stampFilePath,
+        tuple(Path(x) for x in groupsDirs),
+        useLineDirectives,
+        autoParts,
+        sharedCode,
+    )
 
-    def __init__(self) -> None:
-        args = makeArgParser().parse_args()
 
-        logging.basicConfig(
-            format="[%(asctime)s] %(levelname)s [%(name)s.%(funcName)s:%(lineno)d] %(message)s",
-            datefmt="%Y-%m-%dT%H:%M:%S%z",
-            level=args.loglevel.upper(),
-        )
-        logging.info("Logging is now set up.")
+def _readBatchFile(
+    parser: argparse.ArgumentParser,
+    batchFile,
+    groupsDirs: Sequence[Path],
+    useLineDirectives: bool | None,
+    autoParts: AutoPartsConfig | None,
+    sharedCode: bool,
+) -> List[SplitJob]:
+    jobs: List[SplitJob] = []
+    xtCppAction = _XtCppPathArgAction(option_strings=[], dest="xtCppPath")
+
+    with batchFile:
+        for lineNumber, line in enumerate(batchFile, 1):
+            line = line.rstrip("\r\n")
+            if not line.strip() or line.lstrip().startswith("#"):
+                continue  # !!! CONTINUE
+
+            fields = line.split("\t")
+            if len(fields) == 2:
+                fields.append("")
+            if len(fields) != 3:
+                parser.error(
+                    f"{batchFile.name}:{lineNumber}: expected 'xt.cpp<TAB>outdir<TAB>stamp', "
+                    f"got {line!r}"
+                )
 
-        logCommandlineArguments(args)
+            xtCppName, outDirName, stampFileName = fields
 
-        self.loglevel = args.loglevel
+            namespace = argparse.Namespace()
+            try:
+                outDirectory = Path(_verifyOutputDirectoryArg(outDirName))
+                if stampFileName:
+                    _verifyStampPathArg(stampFileName)
+                xtCppAction(parser, namespace, xtCppName)
+            except argparse.ArgumentTypeError as e:
+                parser.error(f"{batchFile.name}:{lineNumber}: {e}")
+
+            jobs.append(
+                _makeSplitJob(
+                    namespace.xtCppPath,
+                    outDirectory,
+                    stampFileName,
+                    groupsDirs,
+                    useLineDirectives,
+                    autoParts,
+                    sharedCode,
+                )
+            )
 
-        self.useLineDirectives = args.line_directives
+    return jobs
 
-        self.xtCppPath = args.xtCppPath.filePath
-        self.xtCppComponent = args.xtCppPath.qualifiedComponentName
 
-        self.outDirectory = Path(args.outdir)
+def _initLogging(loglevel: str) -> None:
+    logging.basicConfig(
+        format="[%(asctime)s] %(levelname)s [%(name)s.%(funcName)s:%(lineno)d] %(message)s",
+        datefmt="%Y-%m-%dT%H:%M:%S%z",
+        level=loglevel.upper(),
+    )
 
-        self.stampFilePath = Path(
-            args.stampfile if args.stampfile else f"{self.xtCppPath.name}.stamp"
-        )
 
-        # If there is no path in the stamp file argument put it into the output directory
-        if len(self.stampFilePath.parts) == 1:
-            self.stampFilePath = self.outDirectory / self.stampFilePath
+@dataclass(init=False, eq=False, order=False)
+class ParsedArgs:
+    loglevel: str
+    jobs: List[SplitJob]
+    workers: int
 
-        # Add the 'groups' directory from the input file to the groups search path, if the path
-        # actually ends in .../groups/grp/grppkg (like .../groups/bsl/bslstl)
-        resolvedPath = self.xtCppPath.resolve()
-        packageDir = resolvedPath.parent
-        groupDir = packageDir.parent
-        groupsDir = groupDir.parent
+    def __init__(self) -> None:
+        parser = makeArgParser()
+        args = parser.parse_args()
 
-        if groupsDir.name == "groups" and groupDir.name == args.xtCppPath.group:
-            args.groups_directory.append(groupsDir)
+        _initLogging(args.loglevel)
+        logging.info("Logging is now set up.")
 
-        self.groupsDirsPath = tuple(Path(x) for x in args.groups_directory)
+        logCommandlineArguments(args)
+
+        self.loglevel = args.loglevel
+        self.workers = args.jobs if args.jobs > 0 else (os.cpu_count() or 1)
+
+        autoParts = None
+        if args.parts == "auto":
+            autoParts = AutoPartsConfig(args.num_parts, args.max_part_cost, args.cost_file)
+        elif args.num_parts or args.max_part_cost or args.cost_file:
+            parser.error("--num-parts, --max-part-cost, and --cost-file require --parts auto")
+
+        if args.batch_file:
+            if args.xtCppPath or args.outdir or args.stampfile:
+                parser.error("--batch-file cannot be combined with -o, -s, or an xt.cpp argument")
+
+            self.jobs = _readBatchFile(
+                parser,
+                args.batch_file,
+                args.groups_directory,
+                args.line_directives,
+                autoParts,
+                args.shared_code,
+            )
+        else:
+            if not args.xtCppPath:
+                parser.error("the xt.cpp argument is required")
+            if not args.outdir:
+                parser.error("the -o/--outdir argument is required")
+
+            self.jobs = [
+                _makeSplitJob(
+                    args.xtCppPath,
+                    Path(args.outdir),
+                    args.stampfile,
+                    args.groups_directory,
+                    args.line_directives,
+                    autoParts,
+                    args.shared_code,
+                )
+            ]
 
         lineDirectivesStr = (
-            self.useLineDirectives if self.useLineDirectives is not None else "Not Set"
-        )
-        logging.info(
-            "Effective Command Line Arguments:\n"
-            f"    Log level         : {self.loglevel}\n"
-            f"    Input xt.cpp file : {self.xtCppPath}\n"
-            f"    Output directory  : {self.outDirectory}\n"
-            f"    Stamp file        : {self.stampFilePath}\n"
-            f"    Groups search path: {', '.join([str(x) for x in self.groupsDirsPath])}\n"
-            f"    Line directives   : {lineDirectivesStr}"
+            args.line_directives if args.line_directives is not None else "Not Set"
         )
+        for job in self.jobs:
+            logging.info(
+                "Effective Command Line Arguments:\n"
+                f"    Log level         : {self.loglevel}\n"
+                f"    Input xt.cpp file : {job.xtCppPath}\n"
+                f"    Output directory  : {job.outDirectory}\n"
+                f"    Stamp file        : {job.stampFilePath}\n"
+                f"    Groups search path: {', '.join([str(x) for x in job.groupsDirsPath])}\n"
+                f"    Line directives   : {lineDirectivesStr}\n"
+                f"    Parts             : {job.autoParts or 'PARTS table'}\n"
+                f"    Shared code       : {job.sharedCode}"
+            )
 
 
 def loadXtCpp(xtCppPath: Path) -> list[str]:
@@ -363,45 +563,102 @@ def loadXtCpp(xtCppPath: Path) -> list[str]:
     return xtCppPath.read_text(encoding="ascii", errors="surrogateescape").splitlines()
 
 
-# ===== MAIN =====
-def main():
-    args = ParsedArgs()
-
-    xtCppLines = loadXtCpp(args.xtCppPath)
+def splitXtCpp(job: SplitJob) -> None:
+    xtCppLines = loadXtCpp(job.xtCppPath)
     logging.info(f"Read {len(xtCppLines)} lines.")
 
-    logging.info(f"Parsing '{args.xtCppPath}'.")
+    logging.info(f"Parsing '{job.xtCppPath}'.")
     parseResult = parseXtCpp(
-        args.xtCppPath, args.xtCppPath.name, args.xtCppComponent, xtCppLines, args.groupsDirsPath
+        job.xtCppPath,
+        job.xtCppPath.name,
+        job.xtCppComponent,
+        xtCppLines,
+        job.groupsDirsPath,
+        job.autoParts,
+        job.sharedCode,
     )
     if parseResult is None:
-        logging.info(f"No need for parts for empty file '{args.xtCppPath}'.")
+        logging.info(f"No need for parts for empty file '{job.xtCppPath}'.")
         writeOutputForXtCpp(
-            args.stampFilePath, args.outDirectory, args.xtCppComponent, [xtCppLines], []
+            job.stampFilePath,
+            job.outDirectory,
+            job.xtCppComponent,
+            [xtCppLines],
+            [],
+            [] if job.sharedCode else None,
         )
         return  # !!!RETURN!!!
 
-    logging.info(f"Generating parts' content for '{args.xtCppPath}'.")
+    sharedContents = None
+    if parseResult.sharedCode is not None:
+        logging.info(f"Generating shared content for '{job.xtCppPath}'.")
+        sharedContents = generateSharedPartFromXtCpp(
+            job.xtCppPath, parseResult, xtCppLines, job.useLineDirectives
+        )
+
+    logging.info(f"Generating parts' content for '{job.xtCppPath}'.")
     testcasesToPartsMapping = generateTestcasesToPartsMapping(parseResult)
     partsContents = generatePartsFromXtCpp(
-        args.xtCppPath,
-        args.xtCppPath.name,
-        args.xtCppComponent,
+        job.xtCppPath,
+        job.xtCppPath.name,
+        job.xtCppComponent,
         parseResult,
         testcasesToPartsMapping,
         xtCppLines,
-        args.useLineDirectives,
+        job.useLineDirectives,
     )
 
-    logging.info(f"Writing parts/stamp/mapping for '{args.xtCppPath}'.")
+    logging.info(f"Writing parts/stamp/mapping for '{job.xtCppPath}'.")
     writeOutputForXtCpp(
-        args.stampFilePath,
-        args.outDirectory,
-        args.xtCppComponent,
+        job.stampFilePath,
+        job.outDirectory,
+        job.xtCppComponent,
         partsContents,
         testcasesToPartsMapping,
+        sharedContents,
     )
 
+
+def _splitXtCppInWorker(job: SplitJob) -> str | None:
+    """Split the test driver of the specified 'job' and return the parse error message, if any,
+    so that the parent process can report errors in a deterministic order."""
+    try:
+        splitXtCpp(job)
+    except XtCppParseError as e:
+        return str(e)
+    return None
+
+
+def splitXtCppBatch(jobs: Sequence[SplitJob], workers: int, loglevel: str) -> int:
+    """Split all test drivers of the specified 'jobs' using at most 'workers' processes and
+    return the number of test drivers that failed to split.  The macro definition caches are
+    kept per worker process, so they are reused by all the test drivers a worker splits."""
+    workers = min(workers, len(jobs))
+
+    if workers <= 1:
+        errors = [_splitXtCppInWorker(job) for job in jobs]
+    else:
+        with concurrent.futures.ProcessPoolExecutor(
+            max_workers=workers, initializer=_initLogging, initargs=(loglevel,)
+        ) as executor:
+            errors = list(executor.map(_splitXtCppInWorker, jobs))
+
+    for error in errors:
+        if error is not None:
+            logging.error(error)
+
+    return sum(1 for error in errors if error is not None)
+
+
+# ===== MAIN =====
+def main():
+    args = ParsedArgs()
+
+    if len(args.jobs) == 1:
+        splitXtCpp(args.jobs[0])
+    elif splitXtCppBatch(args.jobs, args.workers, args.loglevel):
+        exit(1)
+
     return 0
 
 
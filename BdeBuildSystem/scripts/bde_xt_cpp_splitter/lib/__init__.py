@@ -4,6 +4,7 @@ from lib.xtCppParser import parse as parseXtCpp
 from lib.xtCppParser import ParseError as XtCppParseError
 
 from lib.generateParts import generateParts as generatePartsFromXtCpp
+from lib.generateParts import generateSharedPart as generateSharedPartFromXtCpp
 
 from lib.writeOutputForXtCpp import writeOutputForXtCpp
 
@@ -23,6 +24,7 @@ from lib.bdeConstants import (
 __all__ = [
     "parseComponentName",
     "generatePartsFromXtCpp",
+    "generateSharedPartFromXtCpp",
     "writeOutputForXtCpp",
     "parseXtCpp",
     "XtCppParseError",
@@ -0,0 +1,250 @@
+from __future__ import annotations
+
+import functools
+import logging
+import math
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Mapping, MutableMapping, MutableSequence, Optional, Sequence, Tuple
+
+from lib.extensionsForPy38 import removesuffix
+from lib.xtCppParseResults import OriginalTestcase, Testcase
+
+
+class AutoPartsError(ValueError):
+    pass
+
+
+@dataclass(frozen=True)
+class AutoPartsConfig:
+    """Settings of the `auto` parts mode.  At most one of `numParts` and `maxPartCost` is set,
+    when neither is the number of parts of the PARTS table of the test driver is used."""
+
+    numParts: Optional[int] = None
+    maxPartCost: Optional[float] = None
+    costFile: Optional[Path] = None
+
+
+_PROLOGUE_KEY = "prologue"
+
+CostKey = Tuple[int, Optional[int]]
+
+
+@dataclass
+class ComponentCosts:
+    """Measured costs (in seconds) of the test cases of one component."""
+
+    prologue: float
+    cases: Mapping[CostKey, float]
+
+
+def _parseCostCase(costFile: Path, lineNumber: int, text: str) -> CostKey:
+    caseText, dot, sliceText = text.partition(".")
+    try:
+        case = int(caseText)
+        slice = int(sliceText) if dot else None
+    except ValueError:
+        raise AutoPartsError(
+            f"{costFile}:{lineNumber}: Invalid test case '{text}', expected 'N', 'N.S', or "
+            f"'{_PROLOGUE_KEY}'"
+        ) from None
+    return case, slice
+
+
+@functools.lru_cache(maxsize=None)
+def readCostFile(costFile: Path) -> Mapping[str, ComponentCosts]:
+    """Read the specified cost file and return the costs of each component in it.
+
+    Each non-empty line that does not start with '#' has the form:
+
+        component case[.slice] compile-seconds [run-seconds]
+
+    where `case` is a test case number, `slice` is a slice number of a sliced test case, or
+    `case` is the word `prologue` for the cost every part pays regardless of its test cases.
+    The cost of an entry is the sum of its compile and run times.  Repeated entries overwrite
+    earlier ones, so new measurements may simply be appended.  The file is read once per process.
+    """
+    rv: MutableMapping[str, ComponentCosts] = {}
+    for lineNumber, line in enumerate(costFile.read_text().splitlines(), 1):
+        fields = line.split()
+        if not fields or fields[0].startswith("#"):
+            continue  # !!! CONTINUE !!!
+
+        if len(fields) not in (3, 4):
+            raise AutoPartsError(
+                f"{costFile}:{lineNumber}: Expected 'component case[.slice] compile-seconds "
+                f"[run-seconds]', got '{line}'"
+            )
+        try:
+            cost = sum(float(field) for field in fields[2:])
+        except ValueError:
+            raise AutoPartsError(f"{costFile}:{lineNumber}: Invalid cost in '{line}'") from None
+
+        component = rv.setdefault(fields[0], ComponentCosts(0.0, {}))
+        if fields[1] == _PROLOGUE_KEY:
+            component.prologue = cost
+        else:
+            assert isinstance(component.cases, MutableMapping)
+            component.cases[_parseCostCase(costFile, lineNumber, fields[1])] = cost
+
+    return rv
+
+
+def _estimateCosts(
+    units: Sequence[OriginalTestcase],
+    testcaseToNumSlices: Mapping[int, int],
+    componentCosts: ComponentCosts | None,
+) -> Mapping[OriginalTestcase, float]:
+    """Return the estimated cost of each unit.  A slice without a measurement gets its share of
+    the measurement of the whole test case, anything else without a measurement gets the average
+    cost of the measured units (or 1 if there are none, so the parts are balanced by count)."""
+    measured = componentCosts.cases if componentCosts else {}
+
+    rv: MutableMapping[OriginalTestcase, float] = {}
+    for unit in units:
+        key = (unit.testcaseNumber, unit.sliceNumber)
+        if key in measured:
+            rv[unit] = measured[key]
+        elif unit.hasSliceNumber and (unit.testcaseNumber, None) in measured:
+            rv[unit] = (
+                measured[(unit.testcaseNumber, None)] / testcaseToNumSlices[unit.testcaseNumber]
+            )
+
+    default = sum(rv.values()) / len(rv) if rv else 1.0
+    for unit in units:
+        rv.setdefault(unit, default)
+    return rv
+
+
+def _sortKey(unit: OriginalTestcase) -> Tuple[int, int]:
+    return unit.originalTestcaseNumberSortWeight, unit.sliceNumber or 0
+
+
+@dataclass
+class _Packing:
+    parts: Sequence[Sequence[OriginalTestcase]]
+    loads: Sequence[float]
+
+
+def _pack(
+    numParts: int,
+    units: Sequence[OriginalTestcase],
+    costs: Mapping[OriginalTestcase, float],
+    prologue: float,
+) -> _Packing:
+    """Bin-pack the specified 'units' into 'numParts' parts using the longest processing time
+    first rule.  Two slices of the same test case are never placed into the same part, as the
+    generated part has one `case` label per original test case.  Negative test cases are not
+    packed, they all go into the first part."""
+    parts: MutableSequence[MutableSequence[OriginalTestcase]] = [[] for _ in range(numParts)]
+    loads: MutableSequence[float] = [prologue] * numParts
+
+    for unit in units:
+        if unit.testcaseNumber < 0:
+            parts[0].append(unit)
+            loads[0] += costs[unit]
+
+    positiveUnits = [unit for unit in units if unit.testcaseNumber > 0]
+    for unit in sorted(positiveUnits, key=lambda u: (-costs[u], _sortKey(u))):
+        eligible = [
+            index
+            for index in range(numParts)
+            if all(elem.testcaseNumber != unit.testcaseNumber for elem in parts[index])
+        ]
+        index = min(eligible, key=lambda i: (loads[i], len(parts[i]), i))
+        parts[index].append(unit)
+        loads[index] += costs[unit]
+
+    # Number the parts in the order of their test cases, keeping the negative test cases in the
+    # first part
+    order = sorted(
+        (index for index in range(numParts) if parts[index]),
+        key=lambda i: (
+            0 if i == 0 and any(unit.testcaseNumber < 0 for unit in parts[0]) else 1,
+            min(_sortKey(unit) for unit in parts[i]),
+        ),
+    )
+    return _Packing(
+        [sorted(parts[index], key=_sortKey) for index in order], [loads[index] for index in order]
+    )
+
+
+def assignParts(
+    xtCppName: str,
+    qualifiedComponentName: str,
+    testcases: Sequence[Testcase],
+    tableNumParts: Optional[int],
+    config: AutoPartsConfig,
+) -> Sequence[Sequence[OriginalTestcase]]:
+    """Return the contents of the parts of the specified test driver, computed by bin-packing its
+    test cases and slices according to their measured costs.
+
+    The costs are looked up under the component name without the `_cpp03` suffix, so that the
+    C++03 expansion of a test driver is split the same way as the original.
+    """
+    testcaseToNumSlices = {tc.number: tc.numSlices for tc in testcases}
+    units: MutableSequence[OriginalTestcase] = []
+    for tc in testcases:
+        if tc.numSlices == 1:
+            units.append(OriginalTestcase(tc.number, None))
+        else:
+            units.extend(
+                OriginalTestcase(tc.number, sliceNumber)
+                for sliceNumber in range(1, tc.numSlices + 1)
+            )
+
+    componentCosts = None
+    if config.costFile is not None:
+        componentCosts = readCostFile(config.costFile).get(
+            removesuffix(qualifiedComponentName, "_cpp03")
+        )
+        if componentCosts is None:
+            logging.info(f"No costs for '{qualifiedComponentName}' in '{config.costFile}'.")
+    costs = _estimateCosts(units, testcaseToNumSlices, componentCosts)
+    prologue = componentCosts.prologue if componentCosts else 0.0
+
+    numPositiveUnits = sum(1 for unit in units if unit.testcaseNumber > 0)
+    minParts = max(testcaseToNumSlices.values())
+    maxParts = max(min(numPositiveUnits, 99), 1)
+    if minParts > 99:
+        raise AutoPartsError(f"{xtCppName}: A test case has more than 99 slices ({minParts})")
+
+    if config.maxPartCost is not None:
+        available = config.maxPartCost - prologue
+        total = sum(costs.values())
+        numParts = math.ceil(total / available) if available > 0 else maxParts
+        numParts = min(max(numParts, minParts, 1), maxParts)
+        packing = _pack(numParts, units, costs, prologue)
+        while max(packing.loads) > config.maxPartCost and numParts < maxParts:
+            numParts += 1
+            packing = _pack(numParts, units, costs, prologue)
+        if max(packing.loads) > config.maxPartCost:
+            logging.warning(
+                f"{xtCppName}: Cannot split into parts costing at most {config.maxPartCost:g}s, "
+                f"the most expensive of the {numParts} parts costs {max(packing.loads):g}s"
+            )
+    else:
+        numParts = config.numParts if config.numParts is not None else tableNumParts
+        if numParts is None:
+            raise AutoPartsError(
+                f"{xtCppName}: The number of parts is not specified and there is no PARTS "
+                "definition to take it from"
+            )
+        if numParts < minParts:
+            logging.info(
+                f"{xtCppName}: Using {minParts} parts instead of {numParts}, as many as the "
+                "slices of the most sliced test case"
+            )
+        numParts = min(max(numParts, minParts), maxParts)
+        packing = _pack(numParts, units, costs, prologue)
+
+    for partNumber, (part, load) in enumerate(zip(packing.parts, packing.loads), 1):
+        contents = ", ".join(
+            f"{unit.testcaseNumber}.{unit.sliceNumber}"
+            if unit.hasSliceNumber
+            else str(unit.testcaseNumber)
+            for unit in part
+        )
+        logging.info(f"{xtCppName}: Part {partNumber:02} costs {load:g}s: {contents}")
+
+    return packing.parts
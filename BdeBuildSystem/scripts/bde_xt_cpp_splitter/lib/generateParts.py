@@ -232,6 +232,23 @@ def _collapseLineDirectives(partLines: MutableSequence[str]) -> None:
         return
 
 
+def _generateFileHeader(xtCppPath: Path) -> MutableSequence[str]:
+    return [
+        "",
+        "// ============================================================================",
+        "// This is an AUTOMATICALLY GENERATED TEMPORARY source file.  If you edit it,",
+        "// the build system will just overwrite it.  Do not commit it into any source",
+        "// repository.  It is not for human consumption and its history is irrelevant.",
+        "//",
+        f'// See the original source code in: "{xtCppPath}"',
+        "//",
+        f"// This file was was generated on {datetime.datetime.utcnow().isoformat()} UTC by:",
+        f'// "{sys.argv[0]}"',
+        "// ============================================================================",
+        "",
+    ]
+
+
 def _generateParts(
     escapedXtCppPath: str,
     xtCppPath: Path,
@@ -251,6 +268,10 @@ def _generateParts(
 
     testcases: Mapping[int, Testcase] = {tc.number: tc for tc in parseResults.testcases}
 
+    conditionalBlocks = parseResults.conditionalCommonCodeBlocks
+    if parseResults.sharedCode is not None:
+        conditionalBlocks = parseResults.sharedCode.excludeFromParts(conditionalBlocks)
+
     results: MutableSequence[MutableSequence[str]] = []
     for partNumber, partContents, origToPartMapping, partToOrigMapping in zip(
         range(1, len(parseResults.parts) + 1),
@@ -258,20 +279,7 @@ def _generateParts(
         origToPartMappings,
         partToOrigMappings,
     ):
-        partLines: MutableSequence[str] = [
-            "",
-            "// ============================================================================",
-            "// This is an AUTOMATICALLY GENERATED TEMPORARY source file.  If you edit it,",
-            "// the build system will just overwrite it.  Do not commit it into any source",
-            "// repository.  It is not for human consumption and its history is irrelevant.",
-            "//",
-            f'// See the original source code in: "{xtCppPath}"',
-            "//",
-            f"// This file was was generated on {datetime.datetime.utcnow().isoformat()} UTC by:",
-            f'// "{sys.argv[0]}"',
-            "// ============================================================================",
-            "",
-        ]
+        partLines = _generateFileHeader(xtCppPath)
 
         partLines += generateTestCaseMappingTableForPart(testcasesToPartsMapping, len(results) + 1)
         partLines.append("")  # Add an empty line after the table
@@ -386,7 +394,7 @@ def _generateParts(
         if parseResults.simCpp11:
             parseResults.simCpp11.updateLines(partNumber, lines)
 
-        partLines += parseResults.conditionalCommonCodeBlocks.generateCodeForBlock(
+        partLines += conditionalBlocks.generateCodeForBlock(
             CodeBlockInterval(2, parseResults.testPrintLine.lineNumber),
             partContents,
             lines,
@@ -437,7 +445,7 @@ def _generateParts(
                 xtCppName, theCase.number, lines, appendLineDirective
             )
 
-        partLines += parseResults.conditionalCommonCodeBlocks.generateCodeForBlock(
+        partLines += conditionalBlocks.generateCodeForBlock(
             CodeBlockInterval(stopTestcasesLine, len(lines) + 1),
             partContents,
             lines,
@@ -452,15 +460,9 @@ def _generateParts(
     return results
 
 
-def generateParts(
-    xtCppPath: Path,
-    xtCppName: str,
-    qualifiedComponentName: str,
-    parseResults: ParseResult,
-    testcasesToPartsMapping: Sequence[TestcaseMapping],
-    lines: MutableSequence[str],
-    useLineDirectives: bool | None,
-) -> Sequence[Sequence[str]]:
+def _makeAppendLineDirective(
+    xtCppPath: Path, parseResults: ParseResult, useLineDirectives: bool | None
+) -> Tuple[bool, str, Callable[[MutableSequence[str], int], str]]:
 
     # In-file setting overwrites the command line argument
     if parseResults.useLineDirectives is not None:
@@ -481,6 +483,80 @@ def generateParts(
         def appendLineDirective(ls: MutableSequence[str], lineNumber: int) -> str:
             return ""
 
+    return useLineDirectives, escapedXtCppPath, appendLineDirective
+
+
+def generateSharedPart(
+    xtCppPath: Path,
+    parseResults: ParseResult,
+    lines: Sequence[str],
+    useLineDirectives: bool | None,
+) -> Sequence[str]:
+    """Generate the translation unit compiled once and linked into every part.
+
+    It contains the code before `main` including the `SHARED CODE` blocks, which are left out of
+    the parts.  All `FOR` blocks are active in it, as it is shared by all test cases.  If there are
+    no shared code blocks only the header is generated, so the build system can rely on the file
+    being there.
+    """
+    assert parseResults.sharedCode is not None
+
+    rv = _generateFileHeader(xtCppPath)
+    if not parseResults.sharedCode.blocks:
+        rv.append(f"{MY_INFO_COMMENT_PREFIX}There is no shared code in {xtCppPath.name}")
+        return rv  # !!! RETURN !!!
+
+    _, _, appendLineDirective = _makeAppendLineDirective(
+        xtCppPath, parseResults, useLineDirectives
+    )
+
+    rv += _generateSilencingOfWarnings(parseResults.silencedWarnings)
+
+    # The shared code may define functions used by only some of the parts, or by none of them in
+    # this translation unit.  Silence the unused warnings with the compiler macros, so that the
+    # shared part does not depend on 'bsls' unless the test driver does.
+    if "UNUSED" not in parseResults.silencedWarnings:
+        rv += [
+            "#if defined(__GNUC__)",
+            '    #pragma GCC diagnostic ignored "-Wunused"',
+            '    #pragma GCC diagnostic ignored "-Wunused-function"',
+            '    #pragma GCC diagnostic ignored "-Wunused-variable"',
+            "    #if defined(__clang__)",
+            '        #pragma GCC diagnostic ignored "-Wunneeded-internal-declaration"',
+            "    #endif",
+            "#endif",
+            "",
+        ]
+
+    allTestcases = [
+        OriginalTestcase(tc.number, sliceNumber)
+        for tc in parseResults.testcases
+        for sliceNumber in ([None] if tc.numSlices == 1 else range(1, tc.numSlices + 1))
+    ]
+    rv += parseResults.conditionalCommonCodeBlocks.generateCodeForBlock(
+        parseResults.sharedCode.prologueBlock, allTestcases, lines, appendLineDirective
+    )
+
+    if appendLineDirective([], 1) != "":
+        _collapseLineDirectives(rv)
+
+    return rv
+
+
+def generateParts(
+    xtCppPath: Path,
+    xtCppName: str,
+    qualifiedComponentName: str,
+    parseResults: ParseResult,
+    testcasesToPartsMapping: Sequence[TestcaseMapping],
+    lines: MutableSequence[str],
+    useLineDirectives: bool | None,
+) -> Sequence[Sequence[str]]:
+
+    useLineDirectives, escapedXtCppPath, appendLineDirective = _makeAppendLineDirective(
+        xtCppPath, parseResults, useLineDirectives
+    )
+
     parts = _generateParts(
         escapedXtCppPath,
         xtCppPath,
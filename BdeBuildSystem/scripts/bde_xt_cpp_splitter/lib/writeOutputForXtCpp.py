@@ -19,6 +19,10 @@ def _makePartPath(partNumber: int, outputDirectory: Path, qualifiedComponentName
     return (outputDirectory / _makePartFilename(partNumber, qualifiedComponentName)).resolve()
 
 
+def _makeSharedPath(outputDirectory: Path, qualifiedComponentName: str) -> Path:
+    return (outputDirectory / f"{qualifiedComponentName}.shared.t.cpp").resolve()
+
+
 def _makePartCpp03Path(partPath: Path) -> Path:
     newName = re.sub(r"(\.\d{2}\.t\.cpp)", "_cpp03\1", partPath.name)
     return partPath.with_name(newName)
@@ -80,8 +84,10 @@ def _isPartContentSame(prologue: str, lines: Sequence[str], outPath: Path) -> bo
 def _writePartFile(
     partNumber: int, outputDirectory: Path, qualifiedComponentName: str, lines: Sequence[str]
 ):
-    outPath = _makePartPath(partNumber, outputDirectory, qualifiedComponentName)
+    _writeGeneratedFile(_makePartPath(partNumber, outputDirectory, qualifiedComponentName), lines)
+
 
+def _writeGeneratedFile(outPath: Path, lines: Sequence[str]):
     cppFlag = "-*-C++-*-"
     spaces = 79 - (4 + len(outPath.name) + len(cppFlag))
     prologue = f"// {outPath.name} {' ' * spaces}{cppFlag}\n"
@@ -103,6 +109,17 @@ def _writePartFilesIfNeeded(
         _writePartFile(partNumber, outputDirectory, qualifiedComponentName, lines)
 
 
+def _writeSharedFileIfNeeded(
+    outputDirectory: Path, qualifiedComponentName: str, sharedContents: Sequence[str] | None
+) -> None:
+    sharedPath = _makeSharedPath(outputDirectory, qualifiedComponentName)
+    if sharedContents is not None:
+        _writeGeneratedFile(sharedPath, sharedContents)
+    elif sharedPath.exists():
+        logging.info(f"Deleting '{sharedPath}'")
+        sharedPath.unlink()
+
+
 def _writeMapping(
     mappingFile: TextIO, testcasesToPartsMapping: Sequence[TestcaseMapping], numParts: int
 ):
@@ -122,10 +139,12 @@ def writeOutputForXtCpp(
     qualifiedComponentName: str,
     partsContents: Sequence[Sequence[str]],
     testcasesToPartsMapping: Sequence[TestcaseMapping],
+    sharedContents: Sequence[str] | None = None,
 ) -> None:
     lockfileName = outputDirectory / f"{qualifiedComponentName}.xt.cpp.mapping"
     with sourceFileOpen(lockfileName, "w") as mappingAndLockFile:
         _writePartFilesIfNeeded(outputDirectory, qualifiedComponentName, partsContents)
+        _writeSharedFileIfNeeded(outputDirectory, qualifiedComponentName, sharedContents)
         _writeStampFileIfNeededAndDeleteExtraFiles(
             stampPath, outputDirectory, qualifiedComponentName, len(partsContents)
         )
@@ -522,6 +522,29 @@ class TestcaseMapping:
         return self.originalTestcase.sliceText(width)
 
 
+@dataclass
+class SharedCode:
+    """The code before `main` (`prologueBlock`) and the `SHARED CODE` blocks in it.  The code of
+    the blocks is compiled only into the shared translation unit, the rest of the prologue goes
+    into both the shared translation unit and the parts."""
+
+    prologueBlock: CodeBlockInterval
+    blocks: Sequence[CodeBlockInterval]
+
+    def excludeFromParts(
+        self, conditionalBlocks: ConditionalCommonCodeBlocks
+    ) -> ConditionalCommonCodeBlocks:
+        """Return the specified 'conditionalBlocks' extended with the shared code blocks as blocks
+        that are not active in any part."""
+        neverActive = [ConditionalCommonCodeBlock(set(), "SHARED CODE", b) for b in self.blocks]
+        return ConditionalCommonCodeBlocks(
+            sorted(
+                list(conditionalBlocks.conditionalBlocks) + neverActive,
+                key=lambda conditionalBlock: conditionalBlock.block.stopLine,
+            )
+        )
+
+
 @dataclass
 class ParseResult:
     useLineDirectives: bool | None
@@ -531,3 +554,4 @@ class ParseResult:
     conditionalCommonCodeBlocks: ConditionalCommonCodeBlocks
     testPrintLine: TestPrintLineInfo
     testcases: Sequence[Testcase]
+    sharedCode: SharedCode | None = None
@@ -1,5 +1,6 @@
 from __future__ import annotations
 
+import logging
 from pathlib import Path
 import re
 from typing import (
@@ -22,6 +23,7 @@ from lib.extensionsForPy38 import removeprefix, removesuffix
 from lib.codeBlockInterval import CodeBlockInterval
 from lib.bdeConstants import BDE_MAX_LINE_LENGTH
 from lib.resolveTypelistMacro import resolveTypelistMacroValue
+from lib.autoParts import AutoPartsConfig, AutoPartsError, assignParts
 
 from lib.xtCppSupportedControlComments import (
     SET_OF_SUPPORTED_SILENCED_WARNINGS,
@@ -46,6 +48,7 @@ from lib.xtCppParseResults import (
     CodeSlice,
     TypelistSlicing,
     ParseResult,
+    SharedCode,
 )
 
 _END_OF_FILE_LINE = (
@@ -1204,6 +1207,54 @@ def _parseConditionalBlocks(
     return ConditionalCommonCodeBlocks(rv)
 
 
+_MY_SHARED_CODE_PREFIX = MY_CONTROL_COMMENT_PREFIX + "SHARED CODE "
+
+
+def _parseSharedCodeBlocks(
+    xtCppName: str,
+    lines: Sequence[str],
+    mainStartLine: int,
+    condBlocks: ConditionalCommonCodeBlocks,
+) -> Sequence[CodeBlockInterval]:
+    rv: MutableSequence[CodeBlockInterval] = []
+    beginLineNumber: int | None = None
+
+    for lineNumber, line in enumerate(lines, 1):
+        if not line.startswith(_MY_SHARED_CODE_PREFIX):
+            continue  # !!! CONTINUE !!!
+
+        if lineNumber >= mainStartLine:
+            raise ParseError(
+                f"{xtCppName}:{lineNumber}: SHARED CODE blocks must be before 'main': '{line}'"
+            )
+
+        subCommand = removeprefix(line, _MY_SHARED_CODE_PREFIX).strip()
+        if subCommand == "BEGIN":
+            if beginLineNumber is not None:
+                raise ParseError(
+                    f"{xtCppName}:{lineNumber}: SHARED CODE blocks cannot be nested, the block "
+                    f"started on line {beginLineNumber} has no END"
+                )
+            beginLineNumber = lineNumber
+        else:
+            if beginLineNumber is None:
+                raise ParseError(f"{xtCppName}:{lineNumber}: SHARED CODE END without BEGIN")
+
+            block = CodeBlockInterval(beginLineNumber, lineNumber + 1)
+            if condBlocks.overlapsWithAnyConditional(block):
+                raise ParseError(
+                    f"{xtCppName}:{beginLineNumber}: SHARED CODE blocks and FOR blocks cannot "
+                    "overlap"
+                )
+            rv.append(block)
+            beginLineNumber = None
+
+    if beginLineNumber is not None:
+        raise ParseError(f"{xtCppName}:{beginLineNumber}: SHARED CODE BEGIN has no END")
+
+    return rv
+
+
 _MY_PARTS_DEFINITION_HEADING = f"{MY_CONTROL_COMMENT_PREFIX}PARTS (syntax version 1.0.0)"
 
 
@@ -1375,6 +1426,8 @@ def parse(
     qualifiedComponentName: str,
     lines: Sequence[str],
     groupsDirs: Tuple[Path, ...],
+    autoParts: AutoPartsConfig | None = None,
+    sharedCode: bool = False,
 ) -> ParseResult | None:
     # Verify file starts with prologue comment line with name and language
     prologueReStr = f"// {qualifiedComponentName}" + r"\.(?:t|xt)\.cpp +-\*-C\+\+-\*-"
@@ -1406,6 +1459,7 @@ def parse(
     testcaseParseResults = _parseTestcases(
         xtCppName, testCasesOnly.offset, testCasesOnly.lines, resolveTypelist
     )
+    mainStartLine = mainBlock.startLine
     del testCasesOnly, mainBlock
 
     sliceNameMap = _createSliceNameMap(testcaseParseResults)
@@ -1421,10 +1475,35 @@ def parse(
     else:
         simCpp11 = _parseSimCpp11Cpp03(xtCppName, qualifiedComponentName, lines)
 
-    parts = _parsePartsDefinitionTable(xtCppName, lines, testcaseToNumSlices)
+    if autoParts is None:
+        parts = _parsePartsDefinitionTable(xtCppName, lines, testcaseToNumSlices)
+    else:
+        # The PARTS definition is optional in `auto` mode, it only provides the default number
+        # of parts
+        tableNumParts = None
+        if _MY_PARTS_DEFINITION_HEADING in lines:
+            tableNumParts = len(
+                _parsePartsDefinitionTable(xtCppName, lines, dict(testcaseToNumSlices))
+            )
+        try:
+            parts = assignParts(
+                xtCppName, qualifiedComponentName, testcases, tableNumParts, autoParts
+            )
+        except AutoPartsError as e:
+            raise ParseError(str(e)) from None
     if len(parts) > 99:
         raise ParseError(f"There are more than 99 parts! N={len(parts)}", parts)
 
+    sharedCodeBlocks = _parseSharedCodeBlocks(xtCppName, lines, mainStartLine, condBlocks)
+    if sharedCode and simCpp11 is not None and sharedCodeBlocks:
+        # The C++03 expansion is included into each part separately, so the shared code would be
+        # defined in both translation units
+        logging.warning(
+            f"{xtCppName}: SHARED CODE blocks are not supported in test drivers with a C++03 "
+            "expansion, the shared code stays in the parts"
+        )
+        sharedCodeBlocks = []
+
     return ParseResult(
         _getLineDirectivesControl(xtCppName, lines),
         _getSilencedWarnings(xtCppName, lines),
@@ -1433,4 +1512,5 @@ def parse(
         condBlocks,
         testPrintLineInfo,
         testcases,
+        SharedCode(CodeBlockInterval(2, mainStartLine), sharedCodeBlocks) if sharedCode else None,
     )
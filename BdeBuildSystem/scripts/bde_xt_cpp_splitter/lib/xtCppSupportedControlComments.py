@@ -37,6 +37,7 @@ _SUPPORTED_CONTROL_COMMENTS_RE = [
     re.compile(r"SLICING TYPELIST\s*/\s*(?:[1-9])|(?:[1-3][0-9])"),
     re.compile(rf"CODE SLICING (?:BEGIN|BREAK)(?: {_CASE_NAME_RE_STR})?"),
     re.compile(r"CODE SLICING END"),
+    re.compile(r"SHARED CODE (?:BEGIN|END)"),
 ]
 
 _SUPPORTED_END_OF_LINE_CONTROL_COMMENTS_RE = [
@@ -0,0 +1,548 @@
+#!/usr/bin/env python3
+"""
+bench_sim_cpp11_features.py - Performance benchmark of sim_cpp11_features
+
+Runs the Python sim_cpp11_features transformation in-process over several
+suites of inputs and reports, for each suite, the time spent in each phase of
+the transformation and the peak memory allocated.  The results are written in
+the JSON format of Google Benchmark, so that a run can be stored as a baseline
+and later runs compared with it exactly as 'bbs_benchmark.py' compares the
+results of the benchmark drivers.
+
+Suites:
+  - test-cases:     The inputs of 'test_cases_sim_cpp11_features/'
+  - synthetic-N:    A large input made of N regions generated by the
+                    grammar-based fuzzer (fuzz_sim_cpp11_features.py), one
+                    suite per size
+  - corpus:         Real BDE headers having _cpp03 companions (only with
+                    --bde-root, see mutfuzz_sim_cpp11_features.py)
+
+Phases (the time of a phase excludes the time of the phases it calls):
+  - shrouding:      Blanking the comments and strings of the input buffers
+  - templates:      Variadic template simulation, less the phases below
+  - forwarding:     Perfect forwarding workaround
+  - packs:          Repetition of the pack expansions
+  - output:         Writing the master and C++03 files
+  - other:          Everything else (reading, segmenting, boilerplate, ...)
+
+Usage:
+    python bench_sim_cpp11_features.py [options]
+
+Options:
+    --repetitions N         Number of timed runs, the median of which is
+                            reported (default: 5)
+    --synthetic-sizes L     Comma-separated sizes, in generated regions, of the
+                            synthetic inputs (default: 25,100,400, empty for
+                            none)
+    --seed N                Seed of the synthetic inputs (default: 1)
+    --bde-root DIR          Root of a BDE repo, adds the 'corpus' suite
+    --filter REGEX          Regular expression selecting the suites
+    --sim-arg ARG           Additional argument of sim_cpp11_features
+                            (e.g. --sim-arg=--var-args=5), may be repeated
+    --json FILE             File to write the results to
+    --baseline FILE         Results to compare with, ignored if missing
+    --update-baseline       Write the results to the baseline file instead
+    --threshold PERCENT     Slowdown reported as a regression (default: 10)
+    --metric METRIC         real_time or cpu_time (default: cpu_time)
+    --no-fail               Report regressions without failing
+    --profile FILE          Write cProfile data of an extra run to FILE
+    --profile-lines N       Number of functions of the profile printed
+                            (default: 25)
+"""
+
+import argparse
+import contextlib
+import cProfile
+import io
+import json
+import os
+import platform
+import pstats
+import random
+import re
+import statistics
+import sys
+import tempfile
+import time
+import tracemalloc
+from datetime import datetime
+from pathlib import Path
+
+script_dir = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, script_dir)
+import sim_cpp11_features as sim  # noqa: E402
+from bbs_benchmark import compare, format_rows, summarize  # noqa: E402
+from fuzz_sim_cpp11_features import FuzzGenerator  # noqa: E402
+from mutfuzz_sim_cpp11_features import discover_bde_corpus  # noqa: E402
+
+# Functions of sim_cpp11_features timed as each phase
+PHASE_FUNCTIONS = {
+    "shrouding": ("shroud_comments_and_strings",),
+    "templates": ("transform_variadics",),
+    "forwarding": ("transform_forwarding",),
+    "packs": ("repeat_packs", "compact_repeat_packs"),
+    "output": ("write_master", "write_expansion"),
+}
+
+PHASES = tuple(PHASE_FUNCTIONS) + ("other",)
+
+TEST_CASES_DIR = os.path.join(script_dir, "test_cases_sim_cpp11_features")
+
+# The limit macros of the simulation regions of a file are suffixed by a
+# letter, which limits the number of regions of the synthetic inputs.
+SYNTHETIC_MAX_REGIONS = 20
+
+
+class BenchmarkError(Exception):
+    """The transformation of an input failed."""
+
+
+# ============================================================================
+#                          PHASE TIMING
+# ============================================================================
+
+
+def clock():
+    """Return the current (wall clock, CPU) times in seconds."""
+    return time.perf_counter(), time.process_time()
+
+
+class PhaseTimer:
+    """Accumulates the exclusive wall clock and CPU times of the phases.
+
+    Each timed function pushes an accumulator of the time of the timed
+    functions it calls, which is subtracted from its own time, so that the
+    times of the phases add up to the total time.
+    """
+
+    def __init__(self):
+        self.real = dict.fromkeys(PHASES, 0.0)
+        self.cpu = dict.fromkeys(PHASES, 0.0)
+        self.children = []
+        self.total_real = 0.0
+        self.total_cpu = 0.0
+
+    def wrap(self, phase: str, function):
+        def timed(*args, **kwargs):
+            self.children.append([0.0, 0.0])
+            real, cpu = clock()
+            try:
+                return function(*args, **kwargs)
+            finally:
+                end_real, end_cpu = clock()
+                real = end_real - real
+                cpu = end_cpu - cpu
+                child_real, child_cpu = self.children.pop()
+                self.real[phase] += real - child_real
+                self.cpu[phase] += cpu - child_cpu
+                if self.children:
+                    self.children[-1][0] += real
+                    self.children[-1][1] += cpu
+
+        return timed
+
+    def add_run(self, real: float, cpu: float) -> None:
+        """Add the specified total times of a run, attributing the time not
+        spent in any phase to 'other'."""
+        self.total_real += real
+        self.total_cpu += cpu
+        self.real["other"] = self.total_real - sum(self.real[p] for p in PHASE_FUNCTIONS)
+        self.cpu["other"] = self.total_cpu - sum(self.cpu[p] for p in PHASE_FUNCTIONS)
+
+
+@contextlib.contextmanager
+def instrumented(timer: PhaseTimer):
+    """Replace the phase functions of sim_cpp11_features by timed wrappers
+    for the duration of the context."""
+    saved = {}
+    for phase, names in PHASE_FUNCTIONS.items():
+        for name in names:
+            saved[name] = getattr(sim, name)
+            setattr(sim, name, timer.wrap(phase, saved[name]))
+    try:
+        yield timer
+    finally:
+        for name, function in saved.items():
+            setattr(sim, name, function)
+
+
+# ============================================================================
+#                          SUITES
+# ============================================================================
+
+
+def synthetic_input(seed: int, size: int) -> str:
+    """Return a header made of the specified number of regions generated by
+    the grammar-based fuzzer, merged into at most 'SYNTHETIC_MAX_REGIONS'
+    simulation regions."""
+    gen = FuzzGenerator(random.Random(seed))
+    text = gen.gen_file(f"bench_synthetic{size}")
+
+    groups = [[] for _ in range(min(size, SYNTHETIC_MAX_REGIONS))]
+    for i in range(size):
+        groups[i % len(groups)].append(gen.gen_region().split("\n"))
+
+    # Keep the '#if' line of the first region of each group and the bodies of
+    # all of them.
+    regions = []
+    for group in groups:
+        lines = [group[0][0]]
+        for region in group:
+            lines += region[1:-1]
+        lines.append("#endif")
+        regions.append("\n".join(lines))
+
+    # Replace the regions of the generated file, which are between its
+    # include directive and the end of its include guard.
+    include = "#include <bsls_compilerfeatures.h>\n\n"
+    begin = text.index(include) + len(include)
+    end = text.rindex("\n#endif\n\n// " + "-" * 76)
+    return text[:begin] + "\n\n".join(regions) + text[end:]
+
+
+def collect_suites(args, work_dir: str) -> dict:
+    """Return a dictionary mapping the name of each selected suite to the
+    list of its input files."""
+    suites = {"test-cases": sorted(str(p) for p in Path(TEST_CASES_DIR).glob("*.h"))}
+
+    for size in args.synthetic_sizes:
+        path = os.path.join(work_dir, f"bench_synthetic{size}.h")
+        with open(path, "w", encoding="latin-1", newline="") as f:
+            f.write(synthetic_input(args.seed + size, size))
+        suites[f"synthetic-{size}"] = [path]
+
+    if args.bde_root:
+        corpus = discover_bde_corpus(args.bde_root)
+        if not corpus:
+            print(f"No sim_cpp11_features inputs found under {args.bde_root}")
+        else:
+            suites["corpus"] = corpus
+
+    if args.filter:
+        suites = {name: files for name, files in suites.items() if re.search(args.filter, name)}
+    return suites
+
+
+# ============================================================================
+#                          RUNNING
+# ============================================================================
+
+
+def transform(input_filename: str, sim_args: list) -> tuple:
+    """Run sim_cpp11_features on the specified input, writing its output in a
+    temporary directory so that every run writes both files, and return the
+    wall clock and CPU times of the run."""
+    with tempfile.TemporaryDirectory() as out_dir:
+        output_filename = os.path.join(out_dir, os.path.basename(input_filename))
+        out = io.StringIO()
+        try:
+            with contextlib.redirect_stdout(out), contextlib.redirect_stderr(out):
+                start_real, start_cpu = clock()
+                params = sim.Params(
+                    [input_filename, "--output", output_filename, "--force"] + sim_args
+                )
+                for job in params.iter_jobs():
+                    if sim.process_file(
+                        params, job.command_line, job.input_filename, job.output_filename
+                    ):
+                        raise SystemExit(1)
+                end_real, end_cpu = clock()
+        except SystemExit:
+            message = out.getvalue().strip().splitlines()
+            raise BenchmarkError(message[-1] if message else "failed") from None
+    return end_real - start_real, end_cpu - start_cpu
+
+
+def measure_memory(files: list, sim_args: list) -> tuple:
+    """Transform each of the specified files once while tracing the memory
+    allocations, and return the files that succeeded and the peak memory, in
+    bytes, allocated by the transformation of any of them.  Report and skip
+    the files that failed."""
+    ok = []
+    peak = 0
+    tracemalloc.start()
+    try:
+        for path in files:
+            tracemalloc.reset_peak()
+            base = tracemalloc.get_traced_memory()[0]
+            try:
+                transform(path, sim_args)
+            except BenchmarkError as e:
+                print(f"Skipping {path}: {e}")
+                continue
+            peak = max(peak, tracemalloc.get_traced_memory()[1] - base)
+            ok.append(path)
+    finally:
+        tracemalloc.stop()
+    return ok, peak
+
+
+def measure_time(files: list, sim_args: list) -> PhaseTimer:
+    """Transform each of the specified files once and return the times of
+    the phases, summed over the files."""
+    timer = PhaseTimer()
+    with instrumented(timer):
+        for path in files:
+            timer.add_run(*transform(path, sim_args))
+    return timer
+
+
+def run_suite(name: str, files: list, args) -> list:
+    """Benchmark the specified suite and return its Google Benchmark JSON
+    entries, one per phase and one for the total."""
+    # The memory pass also warms up the caches of compiled expressions.
+    files, peak = measure_memory(files, args.sim_args)
+    if not files:
+        return []
+
+    timers = [measure_time(files, args.sim_args) for _ in range(args.repetitions)]
+
+    def entry(phase, real, cpu, **counters):
+        run_name = f"{name}/{phase}"
+        rv = {
+            "name": run_name + "_median",
+            "run_name": run_name,
+            "run_type": "aggregate",
+            "aggregate_name": "median",
+            "repetitions": args.repetitions,
+            "real_time": statistics.median(real) * 1e3,
+            "cpu_time": statistics.median(cpu) * 1e3,
+            "time_unit": "ms",
+        }
+        rv.update(counters)
+        return rv
+
+    entries = [
+        entry(phase, [t.real[phase] for t in timers], [t.cpu[phase] for t in timers])
+        for phase in PHASES
+    ]
+    entries.append(
+        entry(
+            "total",
+            [t.total_real for t in timers],
+            [t.total_cpu for t in timers],
+            files=len(files),
+            bytes=sum(os.path.getsize(path) for path in files),
+            peak_memory=peak,
+        )
+    )
+    return entries
+
+
+def profile_suites(suites: dict, args) -> None:
+    """Transform every input once more under cProfile, write the profile
+    data to the '--profile' file and print the most expensive functions."""
+    profiler = cProfile.Profile()
+    for files in suites.values():
+        for path in files:
+            try:
+                profiler.runcall(transform, path, args.sim_args)
+            except BenchmarkError:
+                pass
+    profiler.dump_stats(args.profile)
+    print(f"Wrote profile data to {args.profile}")
+    stats = pstats.Stats(profiler, stream=sys.stdout)
+    stats.strip_dirs().sort_stats("cumulative").print_stats(args.profile_lines)
+
+
+# ============================================================================
+#                          REPORTING
+# ============================================================================
+
+
+def format_memory(value) -> str:
+    if value is None:
+        return "-"
+    for unit, factor in (("GiB", 1 << 30), ("MiB", 1 << 20), ("KiB", 1 << 10)):
+        if value >= factor:
+            return "%.1f%s" % (value / factor, unit)
+    return "%dB" % value
+
+
+def format_suites(entries: list, metric: str) -> str:
+    """Return a table of the phase times (in milliseconds) and peak memory of
+    each suite of the specified entries."""
+    times = {}
+    totals = {}
+    for e in entries:
+        suite, phase = e["run_name"].split("/")
+        times.setdefault(suite, {})[phase] = e[metric]
+        if phase == "total":
+            totals[suite] = e
+
+    columns = PHASES + ("total",)
+    width = max([len("SUITE")] + [len(suite) for suite in times])
+    header = "%-*s %5s %9s" % (width, "SUITE", "FILES", "SIZE")
+    header += "".join(" %10s" % c.upper() for c in columns) + " %10s" % "PEAK MEM"
+    lines = [header]
+    for suite, phases in times.items():
+        line = "%-*s %5d %9s" % (
+            width,
+            suite,
+            totals[suite]["files"],
+            format_memory(totals[suite]["bytes"]),
+        )
+        line += "".join(" %10.1f" % phases[c] for c in columns)
+        line += " %10s" % format_memory(totals[suite]["peak_memory"])
+        lines.append(line)
+    return "\n".join(lines)
+
+
+def memory_summary(results: dict) -> dict:
+    """Return a dictionary mapping each suite of the specified results to its
+    peak memory."""
+    return {
+        e["run_name"].split("/")[0]: e["peak_memory"]
+        for e in results.get("benchmarks", [])
+        if "peak_memory" in e
+    }
+
+
+def format_memory_rows(rows: list) -> str:
+    width = max([len("SUITE")] + [len(row[0]) for row in rows])
+    lines = [
+        "%-*s %12s %12s %9s  %s" % (width, "SUITE", "PEAK MEM", "BASELINE", "CHANGE", "STATUS")
+    ]
+    for name, cur, base, change, status in rows:
+        lines.append(
+            "%-*s %12s %12s %9s  %s"
+            % (
+                width,
+                name,
+                format_memory(cur),
+                format_memory(base),
+                "-" if change is None else "%+.1f%%" % change,
+                status,
+            )
+        )
+    return "\n".join(lines)
+
+
+# ============================================================================
+#                          MAIN PROGRAM
+# ============================================================================
+
+
+def sizes(value: str) -> list:
+    return [int(size) for size in value.split(",") if size.strip()]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark sim_cpp11_features")
+    parser.add_argument(
+        "--repetitions", type=int, default=5, help="Number of timed runs (median is reported)"
+    )
+    parser.add_argument(
+        "--synthetic-sizes",
+        type=sizes,
+        default=[25, 100, 400],
+        help="Comma-separated sizes, in generated regions, of the synthetic inputs",
+    )
+    parser.add_argument("--seed", type=int, default=1, help="Seed of the synthetic inputs")
+    parser.add_argument("--bde-root", default=None, help="Root of BDE repo (adds 'corpus')")
+    parser.add_argument("--filter", default=None, help="Regular expression selecting the suites")
+    parser.add_argument(
+        "--sim-arg",
+        dest="sim_args",
+        action="append",
+        default=[],
+        help="Additional argument of sim_cpp11_features, may be repeated",
+    )
+    parser.add_argument("--json", default=None, help="File to write the results to")
+    parser.add_argument(
+        "--baseline", default=None, help="Results to compare with, ignored if missing"
+    )
+    parser.add_argument(
+        "--update-baseline",
+        action="store_true",
+        help="Write the results to the baseline file instead of comparing",
+    )
+    parser.add_argument(
+        "--threshold", type=float, default=10.0, help="Slowdown in percent reported as regression"
+    )
+    parser.add_argument(
+        "--metric",
+        choices=("real_time", "cpu_time"),
+        default="cpu_time",
+        help="Time compared with the baseline",
+    )
+    parser.add_argument("--no-fail", action="store_true", help="Report regressions only")
+    parser.add_argument("--profile", default=None, help="File to write cProfile data to")
+    parser.add_argument(
+        "--profile-lines", type=int, default=25, help="Number of profiled functions printed"
+    )
+    args = parser.parse_args()
+
+    if args.repetitions < 1:
+        parser.error("--repetitions must be at least 1")
+    if args.update_baseline and not args.baseline:
+        parser.error("--update-baseline requires --baseline")
+
+    with tempfile.TemporaryDirectory() as work_dir:
+        suites = collect_suites(args, work_dir)
+        if not suites:
+            print("No suite selected")
+            return 1
+
+        entries = []
+        for name, files in suites.items():
+            print(f"Running {name} ({len(files)} files)")
+            sys.stdout.flush()
+            entries += run_suite(name, files, args)
+
+        if args.profile:
+            profile_suites(suites, args)
+
+    results = {
+        "context": {
+            "date": datetime.now().isoformat(timespec="seconds"),
+            "host_name": platform.node(),
+            "executable": os.path.join(script_dir, "sim_cpp11_features.py"),
+            "python_version": platform.python_version(),
+            "sim_args": args.sim_args,
+        },
+        "benchmarks": entries,
+    }
+
+    print(format_suites(entries, args.metric))
+
+    for path in (args.json, args.baseline if args.update_baseline else None):
+        if path:
+            os.makedirs(os.path.dirname(os.path.abspath(path)), exist_ok=True)
+            with open(path, "w") as f:
+                json.dump(results, f, indent=2)
+                f.write("\n")
+
+    if args.update_baseline:
+        print(f"Updated baseline {args.baseline}")
+        return 0
+
+    if not args.baseline:
+        return 0
+    if not os.path.isfile(args.baseline):
+        print(f"No baseline {args.baseline}")
+        return 0
+
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+
+    rows = compare(
+        summarize(results, args.metric), summarize(baseline, args.metric), args.threshold
+    )
+    print(format_rows(rows))
+    memory_rows = compare(memory_summary(results), memory_summary(baseline), args.threshold)
+    print(format_memory_rows(memory_rows))
+
+    regressions = [row for row in rows + memory_rows if row[4] == "REGRESSION"]
+    if regressions:
+        print(
+            f"{len(regressions)} benchmark(s) worse than the baseline by more than "
+            f"{args.threshold:g}%"
+        )
+        if not args.no_fail:
+            return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,54 +1,123 @@
-# Find cycles within a package.
+# Find cycles between the components of a package, a UOR or a whole repository.
 #
 # Usage:
 #   check_cycles.py <list of .h and .cpp files>
+#   check_cycles.py --file-list <file> [--file-list <file> ...]
+#   check_cycles.py --file-lists <file of --file-list files>
+#
+# The cycles are found as the strongly connected components of the include
+# graph; each of them is reported with a shortest cycle as a witness.
 
 import sys
 import re
-import time
+from collections import deque
 from pathlib import Path
 
-def normalize_cycle(cycle):
-    """Takes the 'cycle' list and normalize it such that it starts with the lowest-valued node name."""
-    if not cycle:
-        return []
-
-    # Find the index of the lowest-valued string in the list
-    lowest_string_index = cycle.index(min(cycle))
-
-    cycle_start = cycle[lowest_string_index]
-    cycle = cycle[lowest_string_index:] + cycle[:lowest_string_index]
-    cycle.append(cycle_start)
-    return cycle
-
-def find_cycles(graph):
-    def dfs(node, visited, recStack, path):
-        visited[node] = True
-        recStack[node] = True
-        path.append(node)
-
-        for neighbor in graph.get(node, []):
-            if neighbor == node or graph.get(neighbor, []) == []:
-                continue  # Ignore single-node cycles
-            elif recStack.get(neighbor, False):  # Cycle found
-                cycle_start = path.index(neighbor)
-                cycle = normalize_cycle(path[cycle_start:])
-                cycles.add(tuple(cycle))
-            elif not visited.get(neighbor, False):
-                dfs(neighbor, visited, recStack, path)
-
-        path.pop()
-        recStack[node] = False
-
-    cycles = set()
-    visited = {}
-    recStack = {}
-
-    for node in graph.keys():
-        if not visited.get(node, False):
-            dfs(node, visited, recStack, [])
-
-    return cycles
+def strongly_connected_components(graph):
+    """Return the strongly connected components of the specified 'graph' (a
+    dictionary mapping each node to the set of nodes it depends on) having
+    more than one node, as a sorted list of sorted lists.  This is an
+    iterative version of Tarjan's algorithm, linear in the size of the graph.
+    Self-dependencies and nodes that are not keys of 'graph' are ignored."""
+    index = {}
+    lowlink = {}
+    stack = []
+    on_stack = set()
+    components = []
+
+    for root in graph:
+        if root in index:
+            continue
+
+        index[root] = lowlink[root] = len(index)
+        stack.append(root)
+        on_stack.add(root)
+        work = [(root, iter(graph[root]))]
+
+        while work:
+            node, neighbors = work[-1]
+            descended = False
+            for neighbor in neighbors:
+                if neighbor == node or neighbor not in graph:
+                    continue
+                if neighbor not in index:
+                    index[neighbor] = lowlink[neighbor] = len(index)
+                    stack.append(neighbor)
+                    on_stack.add(neighbor)
+                    work.append((neighbor, iter(graph[neighbor])))
+                    descended = True
+                    break
+                if neighbor in on_stack:
+                    lowlink[node] = min(lowlink[node], index[neighbor])
+            if descended:
+                continue
+
+            work.pop()
+            if work:
+                parent = work[-1][0]
+                lowlink[parent] = min(lowlink[parent], lowlink[node])
+
+            if lowlink[node] == index[node]:
+                component = []
+                while True:
+                    member = stack.pop()
+                    on_stack.discard(member)
+                    component.append(member)
+                    if member == node:
+                        break
+                if len(component) > 1:
+                    components.append(sorted(component))
+
+    return sorted(components)
+
+def shortest_cycle(graph, component, start=None):
+    """Return a shortest cycle of the specified 'graph' through the specified
+    'start' node (by default the lowest-valued node) of the specified strongly
+    connected 'component', as a list of nodes beginning and ending with
+    'start'.  Return an empty list if there is no such cycle."""
+    members = set(component)
+    if start is None:
+        start = min(component)
+
+    parents = {start: None}
+    queue = deque([start])
+    while queue:
+        node = queue.popleft()
+        for neighbor in graph.get(node, ()):
+            if neighbor == start and node != start:
+                path = [node]
+                while parents[path[-1]] is not None:
+                    path.append(parents[path[-1]])
+                return path[::-1] + [start]
+            if neighbor in members and neighbor not in parents:
+                parents[neighbor] = node
+                queue.append(neighbor)
+    return []
+
+def reaches(graph, source, target, members):
+    """Return whether the specified 'target' node is reachable from the
+    specified 'source' node in the specified 'graph' restricted to the
+    specified 'members'."""
+    seen = {source}
+    queue = deque([source])
+    while queue:
+        node = queue.popleft()
+        if node == target:
+            return True
+        for neighbor in graph.get(node, ()):
+            if neighbor in members and neighbor not in seen:
+                seen.add(neighbor)
+                queue.append(neighbor)
+    return False
+
+def format_cycle(cycle, impl_graph):
+    """Return the specified 'cycle' with '->' for implementation dependencies
+    and '-T>' for test-only dependencies."""
+    disp = [cycle[0]]
+    for a, b in zip(cycle, cycle[1:]):
+        disp.append("->" if b in impl_graph.get(a, ()) else "-T>")
+        disp.append(b)
+    return " ".join(disp)
 
 def build_dependency_graph(file_list):
     include_pattern = re.compile(r'^\s*#\s*include\s*["<](\w+)(?:\.fwd)?\.h[">]\s*(// for testing only)?',
@@ -87,14 +156,23 @@ def build_dependency_graph(file_list):
 
 if __name__ == "__main__":
     import argparse
-    parser = argparse.ArgumentParser(description='Find cycles within a package.')
+    parser = argparse.ArgumentParser(description='Find cycles between components.')
     parser.add_argument('files', nargs='*', help='List of .h and .cpp files')
-    parser.add_argument('--file-list', help='File containing list of source files (one per line)')
+    parser.add_argument('--file-list', action='append', default=[],
+                        help='File containing list of source files (one per line), '
+                             'may be repeated to check several UORs together')
+    parser.add_argument('--file-lists', action='append', default=[],
+                        help='File containing list of --file-list files (one per line), '
+                             'used to check all the UORs of a repository together')
     args = parser.parse_args()
 
+    for file_lists_path in args.file_lists:
+        with open(file_lists_path, 'r') as f:
+            args.file_list.extend([line.strip() for line in f if line.strip()])
+
     file_list = args.files
-    if args.file_list:
-        with open(args.file_list, 'r') as f:
+    for file_list_path in args.file_list:
+        with open(file_list_path, 'r') as f:
             file_list.extend([line.strip() for line in f if line.strip()])
 
     print("Parsing source files ...")
@@ -104,35 +182,35 @@ if __name__ == "__main__":
     soletestdeps = set()
     pairdeps = set()
 
-    print("Checking cycles ...")
-    cycles_found = find_cycles(test_graph)
+    print("Checking cycles between %d components ..." % len(test_graph))
+    components = strongly_connected_components(test_graph)
+    impl_components = strongly_connected_components(impl_graph)
 
-    if cycles_found:
+    if components:
         print("Cycles found:")
-        for cycle in sorted(list(cycles_found)):
-
-            testinducers = set()
-            disp=[]
-            for i in range(0,len(cycle)-1):
-                disp.append(cycle[i])
-                if cycle[i+1] in impl_graph[cycle[i]]:
-                    disp.append("->")
-                else:
-                    testinducers.add(  (cycle[i], cycle[i+1]) )
-                    disp.append("-T>")
-            disp.append(cycle[-1])
-
-            if not testinducers:
-                disp.append("  <<< IMPLEMENTATION CYCLE >>")
-
-            else:
-                if len(testinducers) == 1:
-                    soletestdeps.update(testinducers)
-                if len(testinducers) == len(cycle)-1:
-                    pairdeps.update(testinducers)
-                testdeps.update(testinducers)
-
-            print(" ".join(disp))
+        for number, component in enumerate(components, 1):
+            members = set(component)
+            print("  Cycle group %d (%d components): %s" % (number, len(component), " ".join(component)))
+            witness = format_cycle(shortest_cycle(test_graph, component), impl_graph)
+            impl_witnesses = [format_cycle(shortest_cycle(impl_graph, impl_component), impl_graph)
+                              for impl_component in impl_components
+                              if impl_component[0] in members]
+            if witness not in impl_witnesses:
+                print("    " + witness)
+            for impl_witness in impl_witnesses:
+                print("    " + impl_witness + "  <<< IMPLEMENTATION CYCLE >>")
+
+            for a in component:
+                for b in test_graph[a]:
+                    if b not in members or b == a or b in impl_graph[a]:
+                        continue
+                    if reaches(impl_graph, b, a, members):
+                        # 'a -T> b' closes a cycle of implementation dependencies.
+                        soletestdeps.add((a, b))
+                    elif a in test_graph[b] and a not in impl_graph[b]:
+                        pairdeps.add((a, b))
+                    else:
+                        testdeps.add((a, b))
     else:
         print("No cycles found in the dependency graph.")
 
@@ -174,5 +252,5 @@ if __name__ == "__main__":
             for a,b in testdeps:
                 print("    %s -T> %s" % (a,b,))
 
-    if cycles_found:
+    if components:
         sys.exit(1)
@@ -0,0 +1,322 @@
+import glob
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+from . import crashes
+from . import stats
+
+
+class CampaignOptions(object):
+    """Options of a fuzzing campaign.
+
+    Attributes:
+        corpus_dir (str): Directory of the per-component corpora.
+        seed_dir (str): Directory of the per-component seed corpora, which are
+            read but never written, or None.
+        artifact_dir (str): Directory of the per-component failing inputs.
+        num_jobs (int): Number of fuzzing processes per target.
+        mode (str): 'fork' to use libFuzzer's '-fork', 'jobs' to use '-jobs'.
+        max_total_time (int): Time budget per target in seconds, or 0.
+        runs (int): Execution budget per fuzzing process, or 0.
+        timeout (int): Per-input timeout in seconds.
+        rss_limit_mb (int): Memory limit of a fuzzing process, or 0 for the
+            libFuzzer default.
+        stop_on_crash (bool): Whether to stop fuzzing a target at its first
+            crash (in '-fork' mode libFuzzer is told to keep going otherwise).
+        extra_args (list): Additional libFuzzer flags.
+        verbose (bool): Whether to echo the output of the fuzzing processes.
+    """
+
+    def __init__(self, **kw):
+        self.corpus_dir = kw.get("corpus_dir")
+        self.seed_dir = kw.get("seed_dir")
+        self.artifact_dir = kw.get("artifact_dir")
+        self.num_jobs = kw.get("num_jobs", 1)
+        self.mode = kw.get("mode", "fork")
+        self.max_total_time = kw.get("max_total_time", 0)
+        self.runs = kw.get("runs", 0)
+        self.timeout = kw.get("timeout", 25)
+        self.rss_limit_mb = kw.get("rss_limit_mb", 0)
+        self.stop_on_crash = kw.get("stop_on_crash", False)
+        self.extra_args = kw.get("extra_args", [])
+        self.verbose = kw.get("verbose", False)
+
+    def corpus_path(self, target):
+        return os.path.join(self.corpus_dir, target.component)
+
+    def seed_path(self, target):
+        if not self.seed_dir:
+            return None
+        path = os.path.join(self.seed_dir, target.component)
+        return path if os.path.isdir(path) else None
+
+    def artifact_path(self, target):
+        return os.path.join(self.artifact_dir, target.component)
+
+
+def _count_units(path):
+    if not path or not os.path.isdir(path):
+        return 0
+    return sum(
+        1
+        for name in os.listdir(path)
+        if os.path.isfile(os.path.join(path, name))
+    )
+
+
+def _log(message):
+    print(message)
+    sys.stdout.flush()
+
+
+def _budget_args(options):
+    args = []
+    if options.max_total_time:
+        args.append("-max_total_time=%d" % options.max_total_time)
+    if options.runs:
+        args.append("-runs=%d" % options.runs)
+    return args
+
+
+def _fuzz_cmd(target, options):
+    corpus = options.corpus_path(target)
+    cmd = [
+        target.path,
+        "-artifact_prefix=%s%s" % (options.artifact_path(target), os.sep),
+        "-timeout=%d" % options.timeout,
+        "-print_final_stats=1",
+    ]
+    if options.rss_limit_mb:
+        cmd.append("-rss_limit_mb=%d" % options.rss_limit_mb)
+    cmd += _budget_args(options)
+
+    if options.mode == "fork":
+        cmd.append("-fork=%d" % options.num_jobs)
+        if not options.stop_on_crash:
+            cmd += [
+                "-ignore_crashes=1",
+                "-ignore_timeouts=1",
+                "-ignore_ooms=1",
+            ]
+    elif options.num_jobs > 1:
+        cmd += [
+            "-jobs=%d" % options.num_jobs,
+            "-workers=%d" % options.num_jobs,
+        ]
+
+    cmd += options.extra_args
+    cmd.append(corpus)
+    seeds = options.seed_path(target)
+    if seeds:
+        cmd.append(seeds)
+    return cmd
+
+
+def _run_and_collect(cmd, cwd, collector, verbose):
+    """Run the specified fuzzing command, feeding its output to the specified
+    ``StatsCollector`` as it is printed, and return its exit code."""
+    start = time.time()
+    proc = subprocess.Popen(
+        cmd, cwd=cwd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT
+    )
+    try:
+        for raw in proc.stdout:
+            line = raw.decode("utf-8", errors="replace")
+            collector.add_line(line, time.time() - start)
+            if verbose:
+                sys.stdout.write(line)
+                sys.stdout.flush()
+        return proc.wait()
+    except KeyboardInterrupt:
+        proc.terminate()
+        proc.wait()
+        raise
+
+
+def fuzz_target(target, options):
+    """Fuzz the specified target and return its ``TargetStats``.
+
+    The corpus of the component is created (and filled from the seed corpus)
+    on first use.  Failing inputs are written to the artifact directory of
+    the component, reproduced, and deduplicated by stack.
+    """
+    result = stats.TargetStats(target.name)
+    corpus = options.corpus_path(target)
+    artifacts = options.artifact_path(target)
+    for path in (corpus, artifacts):
+        if not os.path.isdir(path):
+            os.makedirs(path)
+    result.corpus_before = _count_units(corpus)
+    old_slow_units = set(crashes.slow_units(artifacts))
+
+    cmd = _fuzz_cmd(target, options)
+    _log("FUZZ %s: START (%s)" % (target.name, " ".join(cmd)))
+
+    # '-jobs' writes the output of each process to 'fuzz-<N>.log' in the
+    # current directory, '-fork' its temporary files to TMPDIR.
+    work_dir = tempfile.mkdtemp(prefix="bbs_fuzz_")
+    try:
+        start = time.time()
+        collector = stats.StatsCollector()
+        result.returncode = _run_and_collect(
+            cmd, work_dir, collector, options.verbose
+        )
+        result.duration = time.time() - start
+
+        collectors = [collector]
+        logs = sorted(glob.glob(os.path.join(work_dir, "fuzz-*.log")))
+        if logs:
+            collectors = []
+            for log_path in logs:
+                job_collector = stats.StatsCollector()
+                with open(log_path, errors="replace") as f:
+                    for line in f:
+                        job_collector.add_line(line)
+                collectors.append(job_collector)
+        result.set_from_collectors(collectors)
+    finally:
+        shutil.rmtree(work_dir, ignore_errors=True)
+
+    result.corpus_after = _count_units(corpus)
+
+    db = crashes.CrashDb(artifacts)
+    for name in db.new_artifacts():
+        output = crashes.reproduce(
+            target, os.path.join(artifacts, name), options.timeout
+        )
+        sig, is_new = db.add(target, name, output)
+        if sig not in result.crashes:
+            result.crashes.append(sig)
+        crash = db.crashes[sig]
+        if is_new:
+            result.new_crashes.append(sig)
+            _log(
+                "FUZZ %s: NEW CRASH %s (%s in %s) %s"
+                % (
+                    target.name,
+                    sig,
+                    crash["kind"],
+                    " < ".join(crash["frames"]) or "?",
+                    os.path.join(artifacts, name),
+                )
+            )
+        else:
+            _log("FUZZ %s: DUPLICATE CRASH %s" % (target.name, sig))
+    db.save()
+
+    # Slow inputs are performance hints, reported without failing the run.
+    for name in crashes.slow_units(artifacts):
+        if name not in old_slow_units:
+            result.slow_units.append(name)
+            _log(
+                "FUZZ %s: SLOW UNIT %s"
+                % (target.name, os.path.join(artifacts, name))
+            )
+
+    _log(
+        "FUZZ %s: DONE (%.0fs, %d execs, %.0f exec/s, cov %d -> %d, "
+        "corpus %d -> %d, %d new crashes)"
+        % (
+            target.name,
+            result.duration,
+            result.execs,
+            result.exec_per_sec,
+            result.initial_cov,
+            result.final_cov,
+            result.corpus_before,
+            result.corpus_after,
+            len(result.new_crashes),
+        )
+    )
+    return result
+
+
+def merge_corpus(targets, options):
+    """Minimize the corpus shared by the specified targets, the parts of one
+    component.
+
+    The corpus and the seed corpus are merged with '-merge=1' into a new
+    directory by each target in turn, keeping the inputs adding coverage to
+    any of the parts, which then replaces the corpus.  Return a
+    '(before, after)' tuple of corpus sizes, or None if the merge failed.
+    """
+    target = targets[0]
+    corpus = options.corpus_path(target)
+    if not os.path.isdir(corpus):
+        os.makedirs(corpus)
+    before = _count_units(corpus)
+
+    merged = tempfile.mkdtemp(
+        prefix=".merge-", dir=os.path.dirname(os.path.abspath(corpus))
+    )
+    work_dir = tempfile.mkdtemp(prefix="bbs_fuzz_")
+    try:
+        # Each merge adds to 'merged' the inputs adding coverage for its
+        # target to what 'merged' already covers.
+        for part in targets:
+            cmd = [
+                part.path,
+                "-merge=1",
+                "-timeout=%d" % options.timeout,
+                "-artifact_prefix=%s%s"
+                % (options.artifact_path(part), os.sep),
+            ]
+            if options.rss_limit_mb:
+                cmd.append("-rss_limit_mb=%d" % options.rss_limit_mb)
+            cmd += [merged, corpus]
+            seeds = options.seed_path(part)
+            if seeds:
+                cmd.append(seeds)
+
+            _log("MERGE %s: START (%s)" % (part.name, " ".join(cmd)))
+            proc = subprocess.run(
+                cmd,
+                cwd=work_dir,
+                stdout=subprocess.PIPE,
+                stderr=subprocess.STDOUT,
+            )
+            if proc.returncode != 0:
+                _log(
+                    "MERGE %s: FAILURE (rc %d)\n%s"
+                    % (
+                        part.name,
+                        proc.returncode,
+                        proc.stdout.decode("utf-8", errors="replace"),
+                    )
+                )
+                return None
+
+        shutil.rmtree(corpus)
+        os.rename(merged, corpus)
+        merged = None
+    finally:
+        shutil.rmtree(work_dir, ignore_errors=True)
+        if merged:
+            shutil.rmtree(merged, ignore_errors=True)
+
+    after = _count_units(corpus)
+    _log(
+        "MERGE %s: DONE (corpus %d -> %d)" % (target.component, before, after)
+    )
+    return before, after
+
+
+# -----------------------------------------------------------------------------
+# Copyright 2025 Bloomberg Finance L.P.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ----------------------------- END-OF-FILE -----------------------------------
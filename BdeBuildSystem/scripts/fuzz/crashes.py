@@ -0,0 +1,198 @@
+import hashlib
+import json
+import os
+import re
+import shutil
+import subprocess
+import time
+
+# Prefixes of the files libFuzzer writes for failing inputs.
+ARTIFACT_PREFIXES = ("crash-", "leak-", "timeout-", "oom-")
+
+# Prefix of the files libFuzzer writes for slow (but passing) inputs.
+SLOW_UNIT_PREFIX = "slow-unit-"
+
+# Number of application frames identifying a crash.
+_NUM_FRAMES = 3
+
+_FRAME_RE = re.compile(r"^\s*#(\d+) 0x[0-9a-fA-F]+ in (.*)$")
+_LOCATION_RE = re.compile(r" (\(\S+\+0x[0-9a-fA-F]+\)|\S+:\d+(:\d+)?)$")
+_KIND_RES = (
+    re.compile(r"ERROR: (\w+Sanitizer: [\w-]+)"),
+    re.compile(r"ERROR: (libFuzzer: [\w -]+?)(?: after| \(|$)"),
+    re.compile(r"(runtime error): "),
+)
+
+# Frames of the sanitizer and libFuzzer runtimes, which do not identify the
+# crash.
+_RUNTIME_FRAME_RE = re.compile(
+    r"^(__asan|__msan|__tsan|__ubsan|__lsan|__sanitizer|__interceptor|"
+    r"__interception|__libc_start|_start$|fuzzer::|std::__1::__function|"
+    r"(__)?(malloc|calloc|realloc|free|operator new|operator delete)\b|"
+    r"(__GI_)?(raise|abort)\b)"
+)
+
+
+def is_artifact(name):
+    return name.startswith(ARTIFACT_PREFIXES)
+
+
+def slow_units(artifact_dir):
+    """Return the names of the slow inputs in the specified artifact
+    directory."""
+    if not os.path.isdir(artifact_dir):
+        return []
+    return sorted(
+        name
+        for name in os.listdir(artifact_dir)
+        if name.startswith(SLOW_UNIT_PREFIX)
+    )
+
+
+def parse_report(output):
+    """Return the '(kind, frames)' identifying the first sanitizer or
+    libFuzzer report in the specified output.
+
+    The frames are the names of the first few functions of the reported
+    stack that are not part of the sanitizer or libFuzzer runtime, without
+    addresses and source locations, so that the signature of a crash does not
+    change with unrelated code changes.
+    """
+    kind = None
+    for line in output.splitlines():
+        for regex in _KIND_RES:
+            match = regex.search(line)
+            if match:
+                kind = match.group(1).strip()
+                break
+        if kind:
+            break
+
+    frames = []
+    in_stack = False
+    for line in output.splitlines():
+        match = _FRAME_RE.match(line)
+        if not match:
+            if in_stack:
+                break  # end of the first stack
+            continue
+        if in_stack and match.group(1) == "0":
+            break
+        in_stack = True
+        function = _LOCATION_RE.sub("", match.group(2).strip())
+        if _RUNTIME_FRAME_RE.match(function):
+            continue
+        frames.append(function)
+        if len(frames) == _NUM_FRAMES:
+            break
+
+    return kind or "unknown", frames
+
+
+def signature(kind, frames):
+    text = "\n".join([kind] + frames)
+    return hashlib.sha1(text.encode("utf-8")).hexdigest()[:16]
+
+
+def reproduce(target, artifact_path, timeout):
+    """Run the specified fuzz target on the specified failing input and return
+    its output."""
+    cmd = [target.path, "-timeout=%d" % timeout, "-runs=1", artifact_path]
+    try:
+        proc = subprocess.run(
+            cmd,
+            stdout=subprocess.PIPE,
+            stderr=subprocess.STDOUT,
+            timeout=timeout * 2 + 10,
+        )
+        return proc.stdout.decode("utf-8", errors="replace")
+    except subprocess.TimeoutExpired as e:
+        out = e.output.decode("utf-8", errors="replace") if e.output else ""
+        return out + "\nERROR: libFuzzer: timeout\n"
+
+
+class CrashDb(object):
+    """Unique crashes of one component, persisted in '<dir>/crashes.json'.
+
+    Each crash is identified by a signature of its kind and top stack frames.
+    The first failing input of a crash is kept in the artifact directory,
+    inputs reproducing an already known crash are moved into the
+    'duplicates' subdirectory.
+    """
+
+    def __init__(self, artifact_dir):
+        self._dir = artifact_dir
+        self._path = os.path.join(artifact_dir, "crashes.json")
+        self.crashes = {}
+        if os.path.isfile(self._path):
+            with open(self._path) as f:
+                self.crashes = json.load(f)
+
+    def known_artifacts(self):
+        rv = set()
+        for crash in self.crashes.values():
+            rv.update(crash["artifacts"])
+        return rv
+
+    def new_artifacts(self):
+        """Return the names of the failing inputs in the artifact directory
+        that are not recorded yet."""
+        if not os.path.isdir(self._dir):
+            return []
+        known = self.known_artifacts()
+        return sorted(
+            name
+            for name in os.listdir(self._dir)
+            if is_artifact(name) and name not in known
+        )
+
+    def add(self, target, name, output):
+        """Record the failing input 'name' whose reproduction printed the
+        specified 'output'.  Return a '(signature, is_new)' tuple."""
+        kind, frames = parse_report(output)
+        sig = signature(kind, frames)
+        crash = self.crashes.get(sig)
+        if crash is None:
+            self.crashes[sig] = {
+                "kind": kind,
+                "frames": frames,
+                "target": target.name,
+                "artifacts": [name],
+                "duplicates": 0,
+                "first_seen": time.strftime("%Y-%m-%dT%H:%M:%S"),
+            }
+            return sig, True
+
+        crash["duplicates"] += 1
+        duplicates_dir = os.path.join(self._dir, "duplicates")
+        if not os.path.isdir(duplicates_dir):
+            os.makedirs(duplicates_dir)
+        shutil.move(
+            os.path.join(self._dir, name), os.path.join(duplicates_dir, name)
+        )
+        return sig, False
+
+    def save(self):
+        if not self.crashes:
+            return
+        if not os.path.isdir(self._dir):
+            os.makedirs(self._dir)
+        with open(self._path, "w") as f:
+            json.dump(self.crashes, f, indent=2, sort_keys=True)
+
+
+# -----------------------------------------------------------------------------
+# Copyright 2025 Bloomberg Finance L.P.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ----------------------------- END-OF-FILE -----------------------------------
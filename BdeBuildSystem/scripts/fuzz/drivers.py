@@ -0,0 +1,112 @@
+import mmap
+import os
+import re
+
+# Symbols every libFuzzer-linked test driver contains: the entry point
+# defined by the test driver, and the name of a libFuzzer flag, which is only
+# present if the libFuzzer 'main' was linked in.
+_FUZZ_MARKERS = (b"LLVMFuzzerTestOneInput", b"max_total_time")
+
+# Test drivers generated from an '.xt.cpp' file are named
+# '<component>.<part>.t'.
+_PART_RE = re.compile(r"\.\d\d$")
+
+
+class FuzzTarget(object):
+    """A fuzz-enabled test driver.
+
+    Attributes:
+        name (str): Name of the test driver ('<component>[.<part>]').
+        component (str): Name of the component, used to select the corpus.
+        path (str): Path to the test driver.
+    """
+
+    def __init__(self, path):
+        self.path = path
+        name = os.path.basename(path)
+        if name.endswith(".exe"):
+            name = name[: -len(".exe")]
+        if name.endswith(".t"):
+            name = name[: -len(".t")]
+        self.name = name
+        self.component = _PART_RE.sub("", name)
+
+    def __repr__(self):
+        return "FuzzTarget(%r)" % self.path
+
+
+def is_fuzz_driver(path):
+    """Return whether the specified executable is linked with libFuzzer.
+
+    The executable is scanned for the libFuzzer markers instead of being run,
+    as running a test driver that is not a fuzz target with libFuzzer flags
+    would run its test cases.
+    """
+    try:
+        with open(path, "rb") as f:
+            if os.fstat(f.fileno()).st_size == 0:
+                return False
+            with mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as data:
+                return all(data.find(marker) != -1 for marker in _FUZZ_MARKERS)
+    except (OSError, ValueError):
+        return False
+
+
+def _is_test_driver(path):
+    name = os.path.basename(path)
+    return (
+        (name.endswith(".t") or name.endswith(".t.exe"))
+        and os.path.isfile(path)
+        and os.access(path, os.X_OK)
+    )
+
+
+def discover(paths, name_filter=None):
+    """Return the fuzz-enabled test drivers in the specified paths.
+
+    Args:
+        paths (list): Test driver executables, or directories (typically the
+            'tests' directory of a build) that are searched for test drivers.
+        name_filter (str): Regular expression the test driver names must
+            match, or None to select all drivers.
+
+    Returns:
+        A list of ``FuzzTarget`` sorted by name.
+    """
+    candidates = []
+    for path in paths:
+        if os.path.isdir(path):
+            for entry in sorted(os.listdir(path)):
+                entry_path = os.path.join(path, entry)
+                if _is_test_driver(entry_path):
+                    candidates.append(entry_path)
+        else:
+            candidates.append(path)
+
+    regex = re.compile(name_filter) if name_filter else None
+    targets = {}
+    for candidate in candidates:
+        target = FuzzTarget(candidate)
+        if regex and not regex.search(target.name):
+            continue
+        if target.name not in targets and is_fuzz_driver(candidate):
+            targets[target.name] = target
+
+    return [targets[name] for name in sorted(targets)]
+
+
+# -----------------------------------------------------------------------------
+# Copyright 2025 Bloomberg Finance L.P.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ----------------------------- END-OF-FILE -----------------------------------
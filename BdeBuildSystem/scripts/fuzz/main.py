@@ -0,0 +1,241 @@
+from __future__ import print_function
+
+import argparse
+import json
+import multiprocessing
+import os
+import sys
+
+from . import campaign
+from . import drivers
+from . import stats
+
+
+def main():
+    """Run a fuzzing campaign with options specified by commandline arguments.
+
+    Exit with a return code 0 on success, and 1 if a new crash was found or
+    a target could not be run.
+    """
+    parser = get_cmdline_parser()
+    args = parser.parse_args()
+
+    targets = drivers.discover(
+        [os.path.abspath(path) for path in args.paths], args.filter
+    )
+    if args.cmd == "list":
+        for target in targets:
+            print("%s %s" % (target.name, target.path))
+        sys.exit(0)
+
+    if not targets:
+        print("No fuzz-enabled test drivers found.", file=sys.stderr)
+        sys.exit(1)
+
+    fuzz_root = os.path.abspath(args.fuzz_dir)
+    options = campaign.CampaignOptions(
+        corpus_dir=os.path.abspath(
+            args.corpus_dir or os.path.join(fuzz_root, "corpus")
+        ),
+        seed_dir=os.path.abspath(args.seed_dir) if args.seed_dir else None,
+        artifact_dir=os.path.abspath(
+            args.artifact_dir or os.path.join(fuzz_root, "artifacts")
+        ),
+        num_jobs=args.jobs,
+        mode=args.mode,
+        max_total_time=args.max_total_time,
+        runs=args.runs,
+        timeout=args.timeout,
+        rss_limit_mb=args.rss_limit_mb,
+        stop_on_crash=args.stop_on_crash,
+        extra_args=args.libfuzzer_args,
+        verbose=args.verbose,
+    )
+
+    exit_code = 0
+    if args.cmd == "merge":
+        for parts in _by_component(targets):
+            if campaign.merge_corpus(parts, options) is None:
+                exit_code = 1
+        sys.exit(exit_code)
+
+    if not options.max_total_time and not options.runs:
+        parser.error("run requires --max-total-time or --runs")
+
+    results = []
+    try:
+        for target in targets:
+            result = campaign.fuzz_target(target, options)
+            results.append(result)
+            if result.new_crashes:
+                exit_code = 1
+            elif result.returncode != 0 and not result.crashes:
+                print(
+                    "FUZZ %s: FAILURE (rc %d)"
+                    % (target.name, result.returncode)
+                )
+                exit_code = 1
+    except KeyboardInterrupt:
+        print("CAUGHT SIG_INT")
+        exit_code = 1
+
+    if args.merge:
+        for parts in _by_component(targets):
+            if campaign.merge_corpus(parts, options) is None:
+                exit_code = 1
+
+    print()
+    print(stats.format_report(results))
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(
+                {"targets": [result.to_dict() for result in results]},
+                f,
+                indent=2,
+            )
+
+    sys.exit(exit_code)
+
+
+def _by_component(targets):
+    """Return the lists of the targets of each component, as the parts of a
+    split test driver share the corpus of their component."""
+    rv = {}
+    for target in targets:
+        rv.setdefault(target.component, []).append(target)
+    return list(rv.values())
+
+
+def get_cmdline_parser():
+    """Get the command line parser.
+
+    Returns:
+        ArgumentParser
+    """
+    parser = argparse.ArgumentParser(
+        prog="bbs_fuzz",
+        description="Run libFuzzer campaigns on the test drivers of a "
+        "BDE_BUILD_TARGET_FUZZ build.",
+    )
+    parser.add_argument(
+        "cmd",
+        choices=("list", "run", "merge"),
+        help="'list' the fuzz-enabled test drivers, 'run' a campaign on "
+        "them, or 'merge' (minimize) their corpora",
+    )
+    parser.add_argument(
+        "paths",
+        nargs="+",
+        help="test drivers, or directories to search for test drivers "
+        "(typically the 'tests' directory of the build)",
+    )
+    parser.add_argument(
+        "--filter", help="regular expression selecting test drivers by name"
+    )
+    parser.add_argument(
+        "--fuzz-dir",
+        default="fuzz",
+        help="root of the corpus and artifact directories "
+        "[default: %(default)s]",
+    )
+    parser.add_argument(
+        "--corpus-dir",
+        help="directory of the per-component corpora "
+        "[default: <fuzz-dir>/corpus]",
+    )
+    parser.add_argument(
+        "--seed-dir",
+        help="directory of the per-component seed corpora (e.g. checked into "
+        "the source tree), used but never modified",
+    )
+    parser.add_argument(
+        "--artifact-dir",
+        help="directory of the per-component failing inputs and crash "
+        "databases [default: <fuzz-dir>/artifacts]",
+    )
+    parser.add_argument(
+        "--jobs",
+        "-j",
+        type=int,
+        default=multiprocessing.cpu_count(),
+        help="number of fuzzing processes per target [default: %(default)s]",
+    )
+    parser.add_argument(
+        "--mode",
+        choices=("fork", "jobs"),
+        default="fork",
+        help="run the processes with libFuzzer's '-fork' (shared corpus, "
+        "keeps going after crashes) or '-jobs' [default: %(default)s]",
+    )
+    parser.add_argument(
+        "--max-total-time",
+        type=int,
+        default=0,
+        help="time budget per target in seconds",
+    )
+    parser.add_argument(
+        "--runs",
+        type=int,
+        default=0,
+        help="execution budget per fuzzing process",
+    )
+    parser.add_argument(
+        "--timeout",
+        type=int,
+        default=25,
+        help="per-input timeout in seconds [default: %(default)s]",
+    )
+    parser.add_argument(
+        "--rss-limit-mb",
+        type=int,
+        default=0,
+        help="memory limit of a fuzzing process [default: libFuzzer's]",
+    )
+    parser.add_argument(
+        "--stop-on-crash",
+        action="store_true",
+        help="stop fuzzing a target at its first crash",
+    )
+    parser.add_argument(
+        "--merge",
+        action="store_true",
+        help="minimize the corpora after the 'run'",
+    )
+    parser.add_argument(
+        "--json", help="write the statistics of the 'run' to a JSON file"
+    )
+    parser.add_argument(
+        "--libfuzzer-arg",
+        dest="libfuzzer_args",
+        action="append",
+        default=[],
+        help="additional libFuzzer flag (e.g. '-dict=file'), may be repeated",
+    )
+    parser.add_argument(
+        "--verbose",
+        "-v",
+        action="store_true",
+        help="echo the output of the fuzzing processes",
+    )
+    return parser
+
+
+if __name__ == "__main__":
+    main()
+
+# -----------------------------------------------------------------------------
+# Copyright 2025 Bloomberg Finance L.P.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ----------------------------- END-OF-FILE -----------------------------------
@@ -0,0 +1,199 @@
+import re
+
+# libFuzzer status lines look like:
+#
+#   #2      INITED cov: 3 ft: 3 corp: 1/1b exec/s: 0 rss: 30Mb
+#   #1024   NEW    cov: 57 ft: 80 corp: 9/93b lim: 11 exec/s: 512 rss: 31Mb
+#   #34523: cov: 112 ft: 254 corp: 66 exec/s: 3451 oom/timeout/crash: 0/0/1
+#
+# the last form being printed by the parent process in '-fork' mode.
+_STATUS_RE = re.compile(r"^#(\d+):?\s")
+_FIELD_RE = re.compile(r"\b(cov|ft|exec/s): (\d+)")
+
+
+class Sample(object):
+    """Coverage of a fuzz target at some point of a run.
+
+    Attributes:
+        time (float): Seconds since the start of the run, or None if unknown.
+        execs (int): Number of executions so far.
+        cov (int): Number of covered code blocks/edges.
+        ft (int): Number of covered features.
+    """
+
+    def __init__(self, time, execs, cov, ft):
+        self.time = time
+        self.execs = execs
+        self.cov = cov
+        self.ft = ft
+
+    def to_dict(self):
+        return {
+            "time": None if self.time is None else round(self.time, 3),
+            "execs": self.execs,
+            "cov": self.cov,
+            "ft": self.ft,
+        }
+
+
+def parse_status_line(line, time=None):
+    """Return the ``Sample`` reported by the specified libFuzzer output line,
+    or None if it is not a status line."""
+    match = _STATUS_RE.match(line)
+    if not match:
+        return None
+    fields = dict(_FIELD_RE.findall(line))
+    if "cov" not in fields:
+        return None
+    return Sample(
+        time, int(match.group(1)), int(fields["cov"]), int(fields.get("ft", 0))
+    )
+
+
+class StatsCollector(object):
+    """Collect the statistics of one fuzzing process from its output.
+
+    Attributes:
+        initial (Sample): First status reported, or None.
+        final (Sample): Last status reported, or None.
+        growth (list): Samples at which the coverage grew.
+    """
+
+    def __init__(self):
+        self.initial = None
+        self.final = None
+        self.growth = []
+
+    def add_line(self, line, time=None):
+        sample = parse_status_line(line, time)
+        if sample is None:
+            return
+        if self.initial is None:
+            self.initial = sample
+            self.growth.append(sample)
+        elif sample.cov > self.growth[-1].cov:
+            self.growth.append(sample)
+        self.final = sample
+
+
+class TargetStats(object):
+    """Statistics of the fuzzing of one target.
+
+    Attributes:
+        name (str): Name of the target.
+        duration (float): Wall clock time of the run in seconds.
+        execs (int): Total number of executions of all fuzzing processes.
+        initial_cov (int): Coverage of the initial corpus.
+        final_cov (int): Coverage at the end of the run.
+        initial_ft (int): Features of the initial corpus.
+        final_ft (int): Features at the end of the run.
+        corpus_before (int): Number of corpus units before the run.
+        corpus_after (int): Number of corpus units after the run.
+        growth (list): Samples at which the coverage grew.
+        crashes (list): Crash signatures found by the run.
+        new_crashes (list): Signatures not found by any previous run.
+        slow_units (list): Names of the slow inputs found by the run.
+        returncode (int): Exit code of the fuzzing (parent) process.
+    """
+
+    def __init__(self, name):
+        self.name = name
+        self.duration = 0.0
+        self.execs = 0
+        self.initial_cov = 0
+        self.final_cov = 0
+        self.initial_ft = 0
+        self.final_ft = 0
+        self.corpus_before = 0
+        self.corpus_after = 0
+        self.growth = []
+        self.crashes = []
+        self.new_crashes = []
+        self.slow_units = []
+        self.returncode = 0
+
+    @property
+    def exec_per_sec(self):
+        return self.execs / self.duration if self.duration > 0 else 0.0
+
+    def set_from_collectors(self, collectors):
+        """Set the coverage and execution counts from the specified
+        ``StatsCollector`` objects, one per fuzzing process.  The execution
+        counts are summed, the coverage is the best of the processes."""
+        collectors = [c for c in collectors if c.final is not None]
+        if not collectors:
+            return
+        self.execs = sum(c.final.execs for c in collectors)
+        self.initial_cov = max(c.initial.cov for c in collectors)
+        self.initial_ft = max(c.initial.ft for c in collectors)
+        self.final_cov = max(c.final.cov for c in collectors)
+        self.final_ft = max(c.final.ft for c in collectors)
+        if len(collectors) == 1:
+            self.growth = collectors[0].growth
+
+    def to_dict(self):
+        return {
+            "name": self.name,
+            "duration": round(self.duration, 3),
+            "execs": self.execs,
+            "exec_per_sec": round(self.exec_per_sec, 1),
+            "initial_cov": self.initial_cov,
+            "final_cov": self.final_cov,
+            "cov_growth": self.final_cov - self.initial_cov,
+            "initial_ft": self.initial_ft,
+            "final_ft": self.final_ft,
+            "corpus_before": self.corpus_before,
+            "corpus_after": self.corpus_after,
+            "growth": [sample.to_dict() for sample in self.growth],
+            "crashes": self.crashes,
+            "new_crashes": self.new_crashes,
+            "slow_units": self.slow_units,
+            "returncode": self.returncode,
+        }
+
+
+def format_report(all_stats):
+    """Return a text table of the specified ``TargetStats``."""
+    header = "%-32s %8s %12s %9s %14s %14s %9s %7s" % (
+        "TARGET",
+        "TIME",
+        "EXECS",
+        "EXEC/S",
+        "COV",
+        "FT",
+        "CORPUS",
+        "CRASHES",
+    )
+    lines = [header, "-" * len(header)]
+    for s in all_stats:
+        lines.append(
+            "%-32s %7.0fs %12d %9.0f %14s %14s %9s %7s"
+            % (
+                s.name,
+                s.duration,
+                s.execs,
+                s.exec_per_sec,
+                "%d (+%d)" % (s.final_cov, s.final_cov - s.initial_cov),
+                "%d (+%d)" % (s.final_ft, s.final_ft - s.initial_ft),
+                "%d/%d" % (s.corpus_after, s.corpus_before),
+                "%d/%d" % (len(s.new_crashes), len(s.crashes)),
+            )
+        )
+    return "\n".join(lines)
+
+
+# -----------------------------------------------------------------------------
+# Copyright 2025 Bloomberg Finance L.P.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ----------------------------- END-OF-FILE -----------------------------------
@@ -24,21 +24,31 @@ Options:
     --timeout N          Per-invocation timeout in seconds (default: 30)
     --verbose            Print each test case name as it runs
     --stop-on-fail       Stop on first failure
+    --fast               Run the Python script in-process and the Perl script
+                         in a long-lived co-process in each worker process,
+                         instead of starting both interpreters per input
 """
 
 import argparse
 import concurrent.futures
+import contextlib
 import difflib
 import hashlib
+import importlib.util
+import io
+import multiprocessing
 import os
 import platform
 import random
 import re
 import shutil
+import signal
 import subprocess
 import sys
 import tempfile
+import threading
 import time
+import traceback
 from pathlib import Path
 
 # ============================================================================
@@ -53,6 +63,9 @@ def normalize_output(text: str) -> str:
     text = re.sub(r"\d{4}-\d{2}-\d{2}T\d{2}:\d{2}:\d{2}(\+\d{2}:\d{2}|Z)?", "TIMESTAMP", text)
     text = re.sub(r"sim_cpp11_features\.pl", "sim_cpp11_features.SCRIPT", text)
     text = re.sub(r"sim_cpp11_features\.py", "sim_cpp11_features.SCRIPT", text)
+    # The Python script elides its '.py' extension from the recorded command
+    # line, which the Perl script does not.
+    text = re.sub(r"(Command line: sim_cpp11_features)(?=[ \n])", r"\1.SCRIPT", text)
     text = re.sub(r"\n+$", "\n", text)  # Normalize trailing newlines
     return text
 
@@ -1229,6 +1242,18 @@ def _is_msys2_perl(perl_exe: str) -> bool:
         return False
 
 
+def collect_files(work_dir: str) -> dict:
+    """Return the contents of the files of the specified directory, by name."""
+    files = {}
+    for f in Path(work_dir).iterdir():
+        if f.is_file():
+            try:
+                files[f.name] = f.read_text(encoding="utf-8", errors="replace")
+            except Exception:
+                files[f.name] = "<unreadable>"
+    return files
+
+
 class FuzzRunner:
     """Runs Perl and Python scripts and compares their output."""
 
@@ -1257,6 +1282,10 @@ class FuzzRunner:
             return _win_to_posix_path(win_path)
         return win_path
 
+    def close(self):
+        """Release the resources of the runner."""
+        pass
+
     def run_script(
         self,
         exe: str,
@@ -1311,16 +1340,7 @@ class FuzzRunner:
         except Exception as e:
             return ("error", "", str(e), {})
 
-        # Collect output files
-        files = {}
-        for f in Path(work_dir).iterdir():
-            if f.is_file():
-                try:
-                    files[f.name] = f.read_text(encoding="utf-8", errors="replace")
-                except Exception:
-                    files[f.name] = "<unreadable>"
-
-        return (rc, stdout, stderr, files)
+        return (rc, stdout, stderr, collect_files(work_dir))
 
     def compare_one(
         self,
@@ -1390,89 +1410,511 @@ class FuzzRunner:
                         {},
                     )
 
-            # If either timed out or errored, record but don't count as diff
-            if perl_rc == "timeout" or python_rc == "timeout":
-                return (
-                    True,
-                    {
-                        "status": "timeout",
-                        "perl_rc": perl_rc,
-                        "python_rc": python_rc,
-                        "mode": mode_label,
-                    },
-                )
-            if perl_rc == "error" or python_rc == "error":
-                return (
-                    True,
-                    {
-                        "status": "exec_error",
-                        "perl_err": perl_err,
-                        "python_err": python_err,
-                        "mode": mode_label,
-                    },
-                )
+            return self.compare_results(
+                (perl_rc, perl_out, perl_err, perl_files),
+                (python_rc, python_out, python_err, python_files),
+                mode_label,
+            )
 
-            # If both crash with nonzero exit, that's acceptable
-            # (we only care about output differences when they succeed)
-            if perl_rc != 0 and python_rc != 0:
-                # Both failed - check if they failed similarly
-                return (True, None)
+    def compare_results(self, perl_result: tuple, python_result: tuple, mode_label: str):
+        """
+        Compare the (rc, stdout, stderr, files) results of both scripts.
+        Returns (passed, failure_info_or_None).
+        """
+        perl_rc, perl_out, perl_err, perl_files = perl_result
+        python_rc, python_out, python_err, python_files = python_result
+
+        # If either timed out or errored, record but don't count as diff
+        if perl_rc == "timeout" or python_rc == "timeout":
+            return (
+                True,
+                {
+                    "status": "timeout",
+                    "perl_rc": perl_rc,
+                    "python_rc": python_rc,
+                    "mode": mode_label,
+                },
+            )
+        if perl_rc == "error" or python_rc == "error":
+            return (
+                True,
+                {
+                    "status": "exec_error",
+                    "perl_err": perl_err,
+                    "python_err": python_err,
+                    "mode": mode_label,
+                },
+            )
 
-            # If one crashed and the other didn't, that's a failure
-            if perl_rc != python_rc:
-                return (
-                    False,
-                    {
-                        "type": "exit_code_mismatch",
-                        "perl_rc": perl_rc,
-                        "python_rc": python_rc,
-                        "perl_stderr": perl_err,
-                        "python_stderr": python_err,
-                        "mode": mode_label,
-                    },
-                )
+        # If both crash with nonzero exit, that's acceptable
+        # (we only care about output differences when they succeed)
+        if perl_rc != 0 and python_rc != 0:
+            # Both failed - check if they failed similarly
+            return (True, None)
 
-            # Both succeeded - compare outputs
-            diffs = []
+        # If one crashed and the other didn't, that's a failure
+        if perl_rc != python_rc:
+            return (
+                False,
+                {
+                    "type": "exit_code_mismatch",
+                    "perl_rc": perl_rc,
+                    "python_rc": python_rc,
+                    "perl_stderr": perl_err,
+                    "python_stderr": python_err,
+                    "mode": mode_label,
+                },
+            )
 
-            # Compare stdout
-            norm_perl_out = normalize_output(perl_out)
-            norm_python_out = normalize_output(python_out)
-            if norm_perl_out != norm_python_out:
+        # Both succeeded - compare outputs
+        diffs = []
+
+        # Compare stdout
+        norm_perl_out = normalize_output(perl_out)
+        norm_python_out = normalize_output(python_out)
+        if norm_perl_out != norm_python_out:
+            diff = list(
+                difflib.unified_diff(
+                    norm_perl_out.splitlines(keepends=True),
+                    norm_python_out.splitlines(keepends=True),
+                    fromfile="perl_stdout",
+                    tofile="python_stdout",
+                    n=3,
+                )
+            )
+            diffs.append(("stdout", "".join(diff)))
+
+        # Compare generated files
+        all_filenames = set(perl_files.keys()) | set(python_files.keys())
+        for fname in sorted(all_filenames):
+            perl_content = perl_files.get(fname, "")
+            python_content = python_files.get(fname, "")
+            norm_perl = normalize_output(perl_content)
+            norm_python = normalize_output(python_content)
+            if norm_perl != norm_python:
                 diff = list(
                     difflib.unified_diff(
-                        norm_perl_out.splitlines(keepends=True),
-                        norm_python_out.splitlines(keepends=True),
-                        fromfile="perl_stdout",
-                        tofile="python_stdout",
+                        norm_perl.splitlines(keepends=True),
+                        norm_python.splitlines(keepends=True),
+                        fromfile=f"perl/{fname}",
+                        tofile=f"python/{fname}",
                         n=3,
                     )
                 )
-                diffs.append(("stdout", "".join(diff)))
-
-            # Compare generated files
-            all_filenames = set(perl_files.keys()) | set(python_files.keys())
-            for fname in sorted(all_filenames):
-                perl_content = perl_files.get(fname, "")
-                python_content = python_files.get(fname, "")
-                norm_perl = normalize_output(perl_content)
-                norm_python = normalize_output(python_content)
-                if norm_perl != norm_python:
-                    diff = list(
-                        difflib.unified_diff(
-                            norm_perl.splitlines(keepends=True),
-                            norm_python.splitlines(keepends=True),
-                            fromfile=f"perl/{fname}",
-                            tofile=f"python/{fname}",
-                            n=3,
-                        )
-                    )
-                    diffs.append((fname, "".join(diff)))
+                diffs.append((fname, "".join(diff)))
 
-            if diffs:
-                return (False, {"type": "output_mismatch", "diffs": diffs, "mode": mode_label})
+        if diffs:
+            return (False, {"type": "output_mismatch", "diffs": diffs, "mode": mode_label})
 
-            return (True, None)
+        return (True, None)
+
+
+# ============================================================================
+#                       FAST (IN-PROCESS) RUNNER
+# ============================================================================
+
+# Perl program serving the requests of a 'PerlOracle'.  The Perl script is
+# compiled once, without running its main program, and each request is
+# processed by a forked child, which starts from the pristine state of the
+# compiled script.  A frame is a line holding the number of fields, followed
+# by each field as a line holding its length in bytes and the field itself.
+# A request holds the input file name, the input and the command line
+# options; the response holds the status ('exit' or 'timeout'), the exit code,
+# the standard output and error, and the name and content of each file.
+PERL_ORACLE_SOURCE = r"""
+use strict;
+use warnings;
+use File::Path qw(rmtree);
+use File::Spec;
+use File::Temp qw(tempdir);
+
+my ($script, $timeout) = @ARGV;
+binmode(STDIN);
+binmode(STDOUT);
+$| = 1;
+
+sub readFrame {
+    my $count = <STDIN>;
+    return undef unless defined $count;
+    chomp $count;
+    my @fields;
+    for (1 .. $count) {
+        my $length = <STDIN>;
+        die "Truncated frame\n" unless defined $length;
+        chomp $length;
+        my $field = "";
+        while (length($field) < $length) {
+            read(STDIN, $field, $length - length($field), length($field))
+                or die "Truncated frame\n";
+        }
+        push @fields, $field;
+    }
+    return \@fields;
+}
+
+sub writeFrame {
+    my $frame = scalar(@_) . "\n";
+    $frame .= length($_) . "\n" . $_ for @_;
+    print STDOUT $frame;
+}
+
+sub slurp {
+    my ($path) = @_;
+    open(my $fh, "<:raw", $path) or return "";
+    local $/;
+    my $data = <$fh>;
+    return defined($data) ? $data : "";
+}
+
+my $source = slurp($script);
+$source =~ s/^exit main\(\);$//m or die "No main program in $script\n";
+$0 = $script;
+@ARGV = ();
+eval("package main;\n#line 1 \"$script\"\n$source");
+die $@ if $@;
+
+while (my $request = readFrame()) {
+    my ($name, $input, @args) = @$request;
+    my $tmp  = tempdir("sim_oracle_XXXXXX", TMPDIR => 1);
+    my $work = "$tmp/work";
+    mkdir($work) or die "Cannot create $work: $!\n";
+    open(my $fh, ">:raw", "$work/$name") or die "Cannot write $name: $!\n";
+    print $fh $input;
+    close($fh);
+
+    my $pid = fork();
+    die "Cannot fork: $!\n" unless defined $pid;
+    if (!$pid) {
+        open(STDIN, "<", File::Spec->devnull());
+        open(STDOUT, ">:raw", "$tmp/stdout");
+        open(STDERR, ">:raw", "$tmp/stderr");
+        chdir($work) or die "Cannot chdir to $work: $!\n";
+        @ARGV = (@args, $name);
+        exit(main::main());
+    }
+
+    my $timedOut = 0;
+    local $SIG{ALRM} = sub { $timedOut = 1; kill("KILL", $pid); };
+    alarm($timeout);
+    my $reaped;
+    do { $reaped = waitpid($pid, 0) } while ($reaped == -1 && $!{EINTR});
+    my $status = $?;
+    alarm(0);
+
+    my @response = $timedOut        ? ("timeout", 0)
+                 : ($status & 127)  ? ("exit", -($status & 127))
+                 :                    ("exit", $status >> 8);
+    push @response, slurp("$tmp/stdout"), slurp("$tmp/stderr");
+    opendir(my $dh, $work) or die "Cannot read $work: $!\n";
+    for my $file (sort readdir($dh)) {
+        push @response, $file, slurp("$work/$file") if -f "$work/$file";
+    }
+    closedir($dh);
+    rmtree($tmp);
+    writeFrame(@response);
+}
+"""
+
+
+def universal_newlines(text: str) -> str:
+    """Translate the line endings of the specified text as reading it in text
+    mode does (see 'FuzzRunner.run_script' and 'collect_files')."""
+    return text.replace("\r\n", "\n").replace("\r", "\n")
+
+
+def decode_text(data: bytes) -> str:
+    return universal_newlines(data.decode("utf-8", "replace"))
+
+
+def write_frame(stream, fields: list) -> None:
+    """Write the specified byte string fields as a frame of the oracle
+    protocol."""
+    data = [b"%d\n" % len(fields)]
+    for field in fields:
+        data += [b"%d\n" % len(field), field]
+    stream.write(b"".join(data))
+    stream.flush()
+
+
+def read_frame(stream) -> list:
+    """Read a frame of the oracle protocol and return its fields."""
+    count = stream.readline()
+    if not count:
+        raise EOFError("Perl oracle exited")
+    fields = []
+    for _ in range(int(count)):
+        length = int(stream.readline())
+        field = stream.read(length)
+        if len(field) != length:
+            raise EOFError("Truncated frame from Perl oracle")
+        fields.append(field)
+    return fields
+
+
+class PerlOracle:
+    """Long-lived Perl process running the Perl script on the inputs sent to
+    it over a framed stdin/stdout protocol (see PERL_ORACLE_SOURCE), saving
+    the start up of an interpreter and the compilation of the script per
+    input.  A request is submitted before its result is read, so that the
+    caller can run the Python script meanwhile."""
+
+    def __init__(self, perl_exe: str, perl_script: str, timeout: int, msys2_perl: bool):
+        self.perl_exe = perl_exe
+        self.perl_script = _win_to_posix_path(perl_script) if msys2_perl else perl_script
+        self.timeout = timeout
+        self.proc = None
+
+    def submit(self, input_content: str, input_name: str, extra_args: list):
+        """Send a request, and return an error result if it failed or None."""
+        if self.proc is None or self.proc.poll() is not None:
+            self.proc = subprocess.Popen(
+                [self.perl_exe, "-e", PERL_ORACLE_SOURCE, self.perl_script, str(self.timeout)],
+                stdin=subprocess.PIPE,
+                stdout=subprocess.PIPE,
+            )
+        fields = [input_name, input_content] + list(extra_args)
+        try:
+            write_frame(self.proc.stdin, [field.encode("utf-8") for field in fields])
+        except OSError as e:
+            self.close()
+            return ("error", "", f"Perl oracle failed: {e}", {})
+        return None
+
+    def result(self):
+        """Return the (rc, stdout, stderr, files) result of the request."""
+        try:
+            fields = read_frame(self.proc.stdout)
+        except (OSError, EOFError, ValueError) as e:
+            self.close()
+            return ("error", "", f"Perl oracle failed: {e}", {})
+
+        status, rc, stdout, stderr = fields[:4]
+        if status == b"timeout":
+            return ("timeout", "", "TIMEOUT", {})
+        files = {
+            name.decode("utf-8", "replace"): decode_text(content)
+            for name, content in zip(fields[4::2], fields[5::2])
+        }
+        return (int(rc), decode_text(stdout), decode_text(stderr), files)
+
+    def close(self):
+        if self.proc is not None:
+            self.proc.kill()
+            self.proc.wait()
+            self.proc = None
+
+
+class InProcessTimeout(BaseException):
+    """Raised by SIGALRM to interrupt an in-process run that timed out.  Not
+    an 'Exception', so that the script does not handle it."""
+
+
+def _raise_timeout(signum, frame):
+    raise InProcessTimeout()
+
+
+def run_in_process(
+    sim, script: str, input_content: str, input_name: str, extra_args: list, timeout: int
+):
+    """Run the main program of the imported Python script 'sim' on the input
+    in a temporary directory, as FuzzRunner.run_script would run the script.
+    Returns (rc, stdout, stderr, files).  Must be called from the main thread
+    of a process running nothing else, as it changes the current directory,
+    'sys.argv' and the SIGALRM handler."""
+    with tempfile.TemporaryDirectory(prefix="fuzz_sim_") as work_dir:
+        with open(os.path.join(work_dir, input_name), "wb") as f:
+            f.write(input_content.encode("utf-8"))
+
+        out = io.StringIO()
+        err = io.StringIO()
+        saved_cwd = os.getcwd()
+        saved_argv = sys.argv
+        use_alarm = hasattr(signal, "SIGALRM")
+        try:
+            os.chdir(work_dir)
+            sys.argv = [script] + list(extra_args) + [input_name]
+            if use_alarm:
+                saved_handler = signal.signal(signal.SIGALRM, _raise_timeout)
+                signal.alarm(timeout)
+            with contextlib.redirect_stdout(out), contextlib.redirect_stderr(err):
+                try:
+                    rc = sim.main()
+                except SystemExit as e:
+                    if e.code is None or isinstance(e.code, int):
+                        rc = e.code or 0
+                    else:
+                        print(e.code, file=sys.stderr)
+                        rc = 1
+                except Exception:
+                    traceback.print_exc()
+                    rc = 1
+        except InProcessTimeout:
+            return ("timeout", "", "TIMEOUT", {})
+        finally:
+            if use_alarm:
+                signal.alarm(0)
+                signal.signal(signal.SIGALRM, saved_handler)
+            sys.argv = saved_argv
+            os.chdir(saved_cwd)
+
+        return (
+            rc,
+            universal_newlines(out.getvalue()),
+            universal_newlines(err.getvalue()),
+            collect_files(work_dir),
+        )
+
+
+class FastWorker:
+    """State of a worker process of FastFuzzRunner: the imported Python script
+    and the Perl oracle."""
+
+    def __init__(self, perl_exe, perl_script, python_script, timeout, msys2_perl):
+        spec = importlib.util.spec_from_file_location("sim_cpp11_features", python_script)
+        self.sim = importlib.util.module_from_spec(spec)
+        sys.modules[spec.name] = self.sim
+        spec.loader.exec_module(self.sim)
+        self.python_script = python_script
+        self.timeout = timeout
+        self.oracle = PerlOracle(perl_exe, perl_script, timeout, msys2_perl)
+
+    def run_pair(self, input_content: str, input_name: str, extra_args: list):
+        """Return the (perl_result, python_result) of both scripts, the Perl
+        script running while the Python one runs in-process."""
+        perl_result = self.oracle.submit(input_content, input_name, extra_args)
+        python_result = run_in_process(
+            self.sim, self.python_script, input_content, input_name, extra_args, self.timeout
+        )
+        if perl_result is None:
+            perl_result = self.oracle.result()
+        return perl_result, python_result
+
+
+_fast_worker = None
+
+
+def _init_fast_worker(*args):
+    global _fast_worker
+    _fast_worker = FastWorker(*args)
+
+
+def _fast_run_pair(input_content: str, input_name: str, extra_args: list):
+    return _fast_worker.run_pair(input_content, input_name, extra_args)
+
+
+class FastFuzzRunner(FuzzRunner):
+    """Runs the scripts without starting an interpreter per input: each of a
+    pool of worker processes imports the Python script and keeps a Perl
+    oracle co-process, and the comparisons are spread over the workers."""
+
+    def __init__(
+        self,
+        perl_script: str,
+        python_script: str,
+        perl_exe: str,
+        timeout: int,
+        output_dir: str,
+        workers: int,
+    ):
+        super().__init__(perl_script, python_script, perl_exe, sys.executable, timeout, output_dir)
+        self.workers = workers
+        self.lock = threading.Lock()
+        self.pool = self._new_pool()
+
+    # Function initializing the state of each worker process
+    worker_initializer = staticmethod(_init_fast_worker)
+
+    def _new_pool(self):
+        return concurrent.futures.ProcessPoolExecutor(
+            max_workers=self.workers,
+            mp_context=multiprocessing.get_context("spawn"),
+            initializer=self.worker_initializer,
+            initargs=(
+                self.perl_exe,
+                self.perl_script,
+                os.path.abspath(self.python_script),
+                self.timeout,
+                self.msys2_perl,
+            ),
+        )
+
+    def _replace_pool(self, pool):
+        """Replace the specified pool, unless another thread already did, and
+        terminate its workers: a worker may be hung (e.g. in an infinite loop
+        of the Python script) and would otherwise never be available again."""
+        with self.lock:
+            if self.pool is not pool:
+                return
+            self.pool = self._new_pool()
+        processes = list((getattr(pool, "_processes", None) or {}).values())
+        pool.shutdown(wait=False, cancel_futures=True)
+        for process in processes:
+            process.terminate()
+
+    def run_in_worker(self, mode_label: str, function, *args):
+        """Run function(*args) in a worker process.  Returns (result, None),
+        or (None, info) with the status info of a run that timed out or whose
+        worker died.  A run interrupted because another run replaced the pool
+        is retried in the new pool."""
+        for _ in range(3):
+            with self.lock:
+                pool = self.pool
+            try:
+                future = pool.submit(function, *args)
+            except RuntimeError:
+                continue  # The pool was shut down by another run
+            try:
+                return future.result(timeout=2 * self.timeout + 30), None
+            except concurrent.futures.TimeoutError:
+                self._replace_pool(pool)
+                return None, {
+                    "status": "timeout",
+                    "perl_rc": "timeout",
+                    "python_rc": "timeout",
+                    "mode": mode_label,
+                }
+            except (
+                concurrent.futures.process.BrokenProcessPool,
+                concurrent.futures.CancelledError,
+            ) as e:
+                with self.lock:
+                    replaced = self.pool is not pool
+                if replaced:
+                    continue
+
+                # A worker died (e.g. stack overflow): replace the pool
+                self._replace_pool(pool)
+                return None, {
+                    "status": "exec_error",
+                    "perl_err": "",
+                    "python_err": f"Worker died: {e}",
+                    "mode": mode_label,
+                }
+        return None, {
+            "status": "exec_error",
+            "perl_err": "",
+            "python_err": "Worker pool replaced repeatedly",
+            "mode": mode_label,
+        }
+
+    def compare_one(
+        self,
+        input_content: str,
+        input_name: str,
+        extra_args: list = None,
+        mode_label: str = "default",
+    ):
+        """Same as FuzzRunner.compare_one."""
+        result, info = self.run_in_worker(
+            mode_label, _fast_run_pair, input_content, input_name, list(extra_args or [])
+        )
+        if result is None:
+            return (True, info)
+        perl_result, python_result = result
+        return self.compare_results(perl_result, python_result, mode_label)
+
+    def close(self):
+        self.pool.shutdown(cancel_futures=True)
 
 
 # ============================================================================
@@ -1606,6 +2048,11 @@ def main():
     )
     parser.add_argument("--verbose", "-v", action="store_true", help="Print each test case")
     parser.add_argument("--stop-on-fail", action="store_true", help="Stop on first failure")
+    parser.add_argument(
+        "--fast",
+        action="store_true",
+        help="Run the Python script in-process and the Perl script in a long-lived co-process",
+    )
     parser.add_argument(
         "--workers",
         "-j",
@@ -1636,19 +2083,30 @@ def main():
         args.workers = min(4, max(1, (os.cpu_count() or 2) // 2))
     print(f"Timeout: {args.timeout}s")
     print(f"Workers: {args.workers}")
+    print(f"Mode: {'fast (in-process)' if args.fast else 'one process per script run'}")
     print(f"Output dir: {args.output_dir}")
     print()
 
     os.makedirs(args.output_dir, exist_ok=True)
 
-    runner = FuzzRunner(
-        perl_script=args.perl,
-        python_script=args.python,
-        perl_exe=args.perl_exe,
-        python_exe=python_exe,
-        timeout=args.timeout,
-        output_dir=args.output_dir,
-    )
+    if args.fast:
+        runner = FastFuzzRunner(
+            perl_script=args.perl,
+            python_script=args.python,
+            perl_exe=args.perl_exe,
+            timeout=args.timeout,
+            output_dir=args.output_dir,
+            workers=args.workers,
+        )
+    else:
+        runner = FuzzRunner(
+            perl_script=args.perl,
+            python_script=args.python,
+            perl_exe=args.perl_exe,
+            python_exe=python_exe,
+            timeout=args.timeout,
+            output_dir=args.output_dir,
+        )
 
     # CLI modes to test for each generated input
     all_cli_modes = [
@@ -1845,6 +2303,8 @@ def main():
     except KeyboardInterrupt:
         print("\n\nInterrupted by user.")
 
+    runner.close()
+
     # Final summary
     elapsed = time.time() - start_time
     rate = total / elapsed if elapsed > 0 else 0
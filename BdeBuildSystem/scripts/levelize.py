@@ -0,0 +1,509 @@
+"""Report the levelization of components and the critical path of the build.
+
+The include graph of the components is extracted from their sources (as
+'check_cycles.py' does).  The report contains:
+
+- the physical level of each component: components depending on no other
+  component of the graph are at level 1, the others one level above their
+  highest dependency (the components of a cycle share one level);
+- the critical path: the dependency chain with the longest total compile time
+  (measured from the '.ninja_log' of a build, or counting one unit per
+  component), compared with the total compile time to estimate the
+  parallelism the dependency structure allows;
+- the hotspots: the headers whose change triggers the largest rebuilds
+  (transitive dependers, weighted by compile time) and the components with
+  the largest number of dependencies.
+
+The report is printed as text, and optionally written as JSON and Graphviz.
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import os
+import sys
+
+from check_cycles import (
+    build_dependency_graph,
+    strongly_connected_components,
+)
+
+
+def read_file_lists(files, file_list_paths, file_lists_paths):
+    """Return the specified 'files' and the files listed in the specified
+    response files, as accepted by 'check_cycles.py'."""
+    file_list_paths = list(file_list_paths)
+    for path in file_lists_paths:
+        with open(path) as f:
+            file_list_paths.extend(line.strip() for line in f if line.strip())
+
+    rv = list(files)
+    for path in file_list_paths:
+        with open(path) as f:
+            rv.extend(line.strip() for line in f if line.strip())
+    return rv
+
+
+def component_of_object(path):
+    """Return the name of the component compiled into the specified object
+    file (e.g. 'bslma_allocator' for '.../bslma_allocator.t.cpp.o' or
+    '.../bslma_allocator.01.t.cpp.o'), or None if it is not an object file.
+    """
+    name = os.path.basename(path)
+    if not name.endswith((".o", ".obj")):
+        return None
+    return name.split(".", 1)[0]
+
+
+def read_ninja_log(path):
+    """Return a dictionary mapping each component to the time in seconds
+    spent compiling its objects according to the specified '.ninja_log'."""
+    last = {}
+    with open(path) as f:
+        for line in f:
+            if line.startswith("#"):
+                continue
+            fields = line.rstrip("\n").split("\t")
+            if len(fields) < 4:
+                continue
+            # The last entry of an output is its most recent build.
+            last[fields[3]] = (int(fields[1]) - int(fields[0])) / 1000.0
+
+    rv = {}
+    for output, seconds in last.items():
+        component = component_of_object(output)
+        if component:
+            rv[component] = rv.get(component, 0.0) + seconds
+    return rv
+
+
+class Levelization(object):
+    """Levels, critical path and hotspots of an include graph.
+
+    Attributes:
+        graph (dict): Component to the set of components it depends on,
+            restricted to the components of the graph.
+        test_graph (dict): Same as 'graph', including the test dependencies.
+        weights (dict): Component to its compile time (or 1).
+        cycles (list): Strongly connected components of 'graph'.
+        levels (dict): Component to its level.
+        critical_path (list): Components of the critical path, from the
+            lowest level up.
+    """
+
+    def __init__(self, impl_graph, test_graph, weights):
+        nodes = set(impl_graph)
+        self.graph = {
+            c: set(d for d in deps if d in nodes and d != c)
+            for c, deps in impl_graph.items()
+        }
+        self.test_graph = {
+            c: set(d for d in deps if d in nodes and d != c)
+            for c, deps in test_graph.items()
+        }
+        self.weights = dict((c, weights.get(c, 0.0)) for c in nodes)
+
+        self.cycles = strongly_connected_components(self.graph)
+        self._condense()
+        self._compute_levels()
+        self._compute_critical_path()
+        self._compute_dependers()
+
+    def _condense(self):
+        # Each cycle is handled as a single node named after its first
+        # component, so that the graph of the nodes is acyclic.
+        self.node_of = dict((c, c) for c in self.graph)
+        for cycle in self.cycles:
+            for c in cycle:
+                self.node_of[c] = cycle[0]
+        self.members = {}
+        for c, node in self.node_of.items():
+            self.members.setdefault(node, []).append(c)
+
+        self.dag = dict((node, set()) for node in self.members)
+        for c, deps in self.graph.items():
+            for d in deps:
+                if self.node_of[d] != self.node_of[c]:
+                    self.dag[self.node_of[c]].add(self.node_of[d])
+
+        # Topological order, dependencies first (iterative DFS).
+        self.order = []
+        state = {}
+        for root in sorted(self.dag):
+            if root in state:
+                continue
+            state[root] = 1
+            work = [(root, iter(sorted(self.dag[root])))]
+            while work:
+                node, deps = work[-1]
+                for d in deps:
+                    if d not in state:
+                        state[d] = 1
+                        work.append((d, iter(sorted(self.dag[d]))))
+                        break
+                else:
+                    work.pop()
+                    self.order.append(node)
+
+    def _compute_levels(self):
+        node_level = {}
+        for node in self.order:
+            node_level[node] = 1 + max(
+                [node_level[d] for d in self.dag[node]] or [0]
+            )
+        self.levels = dict(
+            (c, node_level[node]) for c, node in self.node_of.items()
+        )
+
+    def _compute_critical_path(self):
+        node_weight = dict(
+            (node, sum(self.weights[c] for c in members))
+            for node, members in self.members.items()
+        )
+        finish = {}
+        previous = {}
+        for node in self.order:
+            best = None
+            for d in self.dag[node]:
+                if best is None or finish[d] > finish[best]:
+                    best = d
+            previous[node] = best
+            finish[node] = node_weight[node] + (finish[best] if best else 0)
+
+        self.total_weight = sum(node_weight.values())
+        self.critical_path = []
+        self.critical_weight = 0.0
+        if finish:
+            node = max(sorted(finish), key=lambda n: finish[n])
+            self.critical_weight = finish[node]
+            nodes = []
+            while node is not None:
+                nodes.append(node)
+                node = previous[node]
+            for node in reversed(nodes):
+                self.critical_path.extend(self._cycle_order(node))
+
+    def _cycle_order(self, node):
+        # The members of a cycle have no dependency order: list first the
+        # members with the fewest dependencies within the cycle.
+        members = set(self.members[node])
+        return sorted(
+            members, key=lambda c: (len(self.graph[c] & members), c)
+        )
+
+    def _compute_dependers(self):
+        # Bitsets (Python integers) of the transitive dependers of each node,
+        # computed from the highest level down.
+        bit = dict((node, 1 << i) for i, node in enumerate(self.order))
+        direct = dict((node, 0) for node in self.dag)
+        for node, deps in self.dag.items():
+            for d in deps:
+                direct[d] |= bit[node]
+
+        closure = {}
+        for node in reversed(self.order):
+            mask = direct[node]
+            rest = direct[node]
+            while rest:
+                low = rest & -rest
+                rest ^= low
+                mask |= closure[self.order[low.bit_length() - 1]]
+            closure[node] = mask
+        self._bit = bit
+        self._closure = closure
+
+    def transitive_dependers(self, component):
+        """Return the components that include the specified 'component'
+        directly or indirectly (excluding the other members of its cycle)."""
+        mask = self._closure[self.node_of[component]]
+        rv = []
+        while mask:
+            low = mask & -mask
+            mask ^= low
+            rv.extend(self.members[self.order[low.bit_length() - 1]])
+        return rv
+
+    def rebuild_set(self, component):
+        """Return the components recompiled when the header of the specified
+        'component' changes: the component itself, its transitive dependers,
+        the other members of its cycle, and the test drivers including any of
+        them."""
+        affected = set(self.transitive_dependers(component))
+        affected.update(self.members[self.node_of[component]])
+        for c, deps in self.test_graph.items():
+            if c not in affected and deps & affected:
+                affected.add(c)
+        return affected
+
+    def transitive_dependencies(self, component):
+        seen = set()
+        stack = [self.node_of[component]]
+        while stack:
+            for d in self.dag[stack.pop()]:
+                if d not in seen:
+                    seen.add(d)
+                    stack.append(d)
+        return sum(len(self.members[node]) for node in seen)
+
+    def hotspots(self, count):
+        """Return the 'count' components with the largest rebuild cost, as
+        a list of dictionaries."""
+        direct_dependers = dict((c, 0) for c in self.graph)
+        for c, deps in self.graph.items():
+            for d in deps:
+                direct_dependers[d] += 1
+
+        # Pre-select by transitive fan-in, which is cheap to compute.
+        candidates = sorted(
+            self.graph,
+            key=lambda c: (
+                -len(self.transitive_dependers(c)),
+                -direct_dependers[c],
+                c,
+            ),
+        )[: max(count * 4, count)]
+
+        rv = []
+        for c in candidates:
+            rebuild = self.rebuild_set(c)
+            rv.append(
+                {
+                    "component": c,
+                    "level": self.levels[c],
+                    "fan_in": direct_dependers[c],
+                    "transitive_fan_in": len(self.transitive_dependers(c)),
+                    "rebuild_count": len(rebuild),
+                    "rebuild_time": round(
+                        sum(self.weights[r] for r in rebuild), 3
+                    ),
+                }
+            )
+        rv.sort(key=lambda h: (-h["rebuild_time"], -h["rebuild_count"]))
+        return rv[:count]
+
+    def fan_out(self, count):
+        """Return the 'count' components with the most dependencies."""
+        rv = [
+            {
+                "component": c,
+                "level": self.levels[c],
+                "fan_out": len(self.graph[c]),
+                "transitive_fan_out": self.transitive_dependencies(c),
+            }
+            for c in self.graph
+        ]
+        rv.sort(key=lambda h: (-h["transitive_fan_out"], -h["fan_out"]))
+        return rv[:count]
+
+
+def format_text(lev, hotspots, fan_out, unit):
+    lines = []
+    by_level = {}
+    for c, level in lev.levels.items():
+        by_level.setdefault(level, []).append(c)
+
+    lines.append(
+        "%d components, %d levels, %d cycles"
+        % (len(lev.levels), max(by_level or [0]), len(lev.cycles))
+    )
+    lines.append("")
+    lines.append("Components per level:")
+    for level in sorted(by_level):
+        lines.append("  %4d: %d" % (level, len(by_level[level])))
+
+    for cycle in lev.cycles:
+        lines.append("Cycle (levelized together): %s" % " ".join(cycle))
+
+    lines.append("")
+    lines.append(
+        "Critical path (%d components, %.1f%s of %.1f%s total, "
+        "parallelism at most %.1f):"
+        % (
+            len(lev.critical_path),
+            lev.critical_weight,
+            unit,
+            lev.total_weight,
+            unit,
+            (
+                lev.total_weight / lev.critical_weight
+                if lev.critical_weight
+                else 0.0
+            ),
+        )
+    )
+    for c in lev.critical_path:
+        lines.append(
+            "  %4d  %-40s %8.1f%s" % (lev.levels[c], c, lev.weights[c], unit)
+        )
+
+    lines.append("")
+    lines.append("Headers triggering the largest rebuilds:")
+    lines.append(
+        "  %-40s %5s %7s %9s %8s %10s"
+        % ("COMPONENT", "LEVEL", "FAN-IN", "TRANS-IN", "REBUILD", "COST")
+    )
+    for h in hotspots:
+        lines.append(
+            "  %-40s %5d %7d %9d %8d %9.1f%s"
+            % (
+                h["component"],
+                h["level"],
+                h["fan_in"],
+                h["transitive_fan_in"],
+                h["rebuild_count"],
+                h["rebuild_time"],
+                unit,
+            )
+        )
+
+    lines.append("")
+    lines.append("Components with the most dependencies:")
+    lines.append(
+        "  %-40s %5s %7s %9s" % ("COMPONENT", "LEVEL", "FAN-OUT", "TRANS-OUT")
+    )
+    for h in fan_out:
+        lines.append(
+            "  %-40s %5d %7d %9d"
+            % (
+                h["component"],
+                h["level"],
+                h["fan_out"],
+                h["transitive_fan_out"],
+            )
+        )
+    return "\n".join(lines)
+
+
+def to_json(lev, hotspots, fan_out, timed):
+    return {
+        "weight_unit": "seconds" if timed else "components",
+        "components": dict(
+            (
+                c,
+                {
+                    "level": lev.levels[c],
+                    "weight": lev.weights[c],
+                    "dependencies": sorted(lev.graph[c]),
+                },
+            )
+            for c in sorted(lev.levels)
+        ),
+        "cycles": lev.cycles,
+        "critical_path": lev.critical_path,
+        "critical_path_weight": lev.critical_weight,
+        "total_weight": lev.total_weight,
+        "hotspots": hotspots,
+        "fan_out": fan_out,
+    }
+
+
+def to_dot(lev):
+    """Return the graph in the Graphviz format, with one rank per level and
+    the critical path highlighted."""
+    critical = set(zip(lev.critical_path[1:], lev.critical_path))
+    lines = ["digraph levelization {", "  rankdir=BT;", "  node [shape=box];"]
+    by_level = {}
+    for c, level in lev.levels.items():
+        by_level.setdefault(level, []).append(c)
+    for level in sorted(by_level):
+        lines.append(
+            '  { rank=same; "L%d" [shape=plaintext]; %s }'
+            % (level, " ".join('"%s";' % c for c in sorted(by_level[level])))
+        )
+    for level in sorted(by_level)[1:]:
+        lines.append('  "L%d" -> "L%d" [style=invis];' % (level, level - 1))
+    for c in sorted(lev.graph):
+        for d in sorted(lev.graph[c]):
+            attrs = " [color=red, penwidth=2]" if (c, d) in critical else ""
+            lines.append('  "%s" -> "%s"%s;' % (c, d, attrs))
+    lines.append("}")
+    return "\n".join(lines)
+
+
+def get_cmdline_parser():
+    parser = argparse.ArgumentParser(
+        prog="levelize",
+        description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+    )
+    parser.add_argument("files", nargs="*", help="list of .h and .cpp files")
+    parser.add_argument(
+        "--file-list",
+        action="append",
+        default=[],
+        help="file containing list of source files (one per line), may be "
+        "repeated",
+    )
+    parser.add_argument(
+        "--file-lists",
+        action="append",
+        default=[],
+        help="file containing list of --file-list files (one per line)",
+    )
+    parser.add_argument(
+        "--ninja-log",
+        help="'.ninja_log' of a build, the compile times of which weight the "
+        "components (default: one unit per component)",
+    )
+    parser.add_argument(
+        "--top",
+        type=int,
+        default=20,
+        help="number of hotspots reported [default: %(default)s]",
+    )
+    parser.add_argument("--json", help="write the report to a JSON file")
+    parser.add_argument("--dot", help="write the graph to a Graphviz file")
+    return parser
+
+
+def main():
+    args = get_cmdline_parser().parse_args()
+
+    file_list = read_file_lists(args.files, args.file_list, args.file_lists)
+    test_graph, impl_graph = build_dependency_graph(file_list)
+    if not impl_graph:
+        print("No components found.", file=sys.stderr)
+        sys.exit(1)
+
+    timed = False
+    if args.ninja_log and os.path.isfile(args.ninja_log):
+        weights = read_ninja_log(args.ninja_log)
+        timed = True
+    else:
+        if args.ninja_log:
+            print("No %s, counting components" % args.ninja_log)
+        weights = dict((c, 1.0) for c in impl_graph)
+
+    lev = Levelization(impl_graph, test_graph, weights)
+    hotspots = lev.hotspots(args.top)
+    fan_out = lev.fan_out(args.top)
+
+    print(format_text(lev, hotspots, fan_out, "s" if timed else ""))
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(to_json(lev, hotspots, fan_out, timed), f, indent=2)
+    if args.dot:
+        with open(args.dot, "w") as f:
+            f.write(to_dot(lev) + "\n")
+
+
+if __name__ == "__main__":
+    main()
+
+# -----------------------------------------------------------------------------
+# Copyright 2025 Bloomberg Finance L.P.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ----------------------------- END-OF-FILE -----------------------------------
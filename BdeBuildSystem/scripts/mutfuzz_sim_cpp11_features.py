@@ -40,6 +40,17 @@ Options:
     --timeout N          Per-invocation timeout in seconds (default: 30)
     --verbose            Print each test case
     --stop-on-fail       Stop on first failure
+    --fast               Run the Python script in-process and the Perl script
+                         in a long-lived co-process in each worker process,
+                         instead of starting both interpreters per input
+    --coverage           Coverage-guided mode (implies --fast): trace the line
+                         and branch coverage of the Python script, add the
+                         mutated inputs reaching new coverage to the corpus and
+                         mutate them preferably, minimize the failing inputs,
+                         and report the coverage growth (saved with the final
+                         corpus in the output directory)
+    --minimize-runs N    Maximum runs minimizing each failing input in
+                         coverage-guided mode, 0 to disable (default: 200)
     --workers N          Number of parallel workers
 """
 
@@ -60,10 +71,13 @@ from pathlib import Path
 script_dir = os.path.dirname(os.path.abspath(__file__))
 sys.path.insert(0, script_dir)
 from fuzz_sim_cpp11_features import (
+    FastFuzzRunner,
+    FastWorker,
     FuzzRunner,
     find_perl_exe,
     find_python_exe,
     normalize_output,
+    run_in_process,
     save_failure,
 )
 
@@ -328,6 +342,392 @@ def apply_mutations(rng: random.Random, content: str, num_mutations: int) -> tup
     return content, applied
 
 
+# ============================================================================
+#                       COVERAGE-GUIDED FUZZING
+# ============================================================================
+
+
+COVERAGE_REPORT_INTERVAL = 10.0  # Seconds between coverage progress reports
+
+
+class CoverageTracer:
+    """Collects the coverage of the code of the specified source file while
+    active (as a context manager).  The coverage items are the lines executed
+    ('L', line) and either the branches taken ('B', function, from, to) if
+    'sys.monitoring' is available (Python 3.12+), or the arcs between the
+    consecutive lines executed ('A', from, to) otherwise (using
+    'sys.settrace').
+
+    Only the items not reported before are returned by 'take()', which lets
+    'sys.monitoring' disable the instrumentation of each location once it was
+    hit, so that code already covered runs at full speed."""
+
+    def __init__(self, filename: str):
+        self.filename = filename
+        self.seen = set()
+        self.new = set()
+        self.monitoring = getattr(sys, "monitoring", None)
+        if self.monitoring:
+            self._register_monitoring()
+
+    def _register_monitoring(self):
+        mon = self.monitoring
+        events = mon.events
+        tool = mon.COVERAGE_ID
+        mon.use_tool_id(tool, "mutfuzz_sim_cpp11_features")
+        new = self.new
+
+        def on_line(code, line):
+            if code.co_filename == self.filename:
+                new.add(("L", line))
+            return mon.DISABLE
+
+        # Python 3.14 reports each direction of a branch as a separate event,
+        # earlier versions report both as 'BRANCH' events, which can only be
+        # disabled once both directions were taken.
+        destinations = {}
+
+        def on_branch_direction(code, source, destination):
+            if code.co_filename == self.filename:
+                new.add(("B", code.co_qualname, source, destination))
+            return mon.DISABLE
+
+        def on_branch(code, source, destination):
+            if code.co_filename != self.filename:
+                return mon.DISABLE
+            new.add(("B", code.co_qualname, source, destination))
+            taken = destinations.setdefault((code, source), set())
+            taken.add(destination)
+            return mon.DISABLE if len(taken) > 1 else None
+
+        mon.register_callback(tool, events.LINE, on_line)
+        self.events = events.LINE
+        if hasattr(events, "BRANCH_LEFT"):
+            for event in (events.BRANCH_LEFT, events.BRANCH_RIGHT):
+                mon.register_callback(tool, event, on_branch_direction)
+                self.events |= event
+        else:
+            mon.register_callback(tool, events.BRANCH, on_branch)
+            self.events |= events.BRANCH
+
+    def _trace(self, frame, event, arg):
+        if frame.f_code.co_filename != self.filename:
+            return None
+        new = self.new
+        last = -frame.f_code.co_firstlineno
+
+        def trace_lines(frame, event, arg):
+            nonlocal last
+            if event == "line":
+                line = frame.f_lineno
+                new.add(("L", line))
+                new.add(("A", last, line))
+                last = line
+            elif event == "return":
+                new.add(("A", last, -frame.f_code.co_firstlineno))
+            return trace_lines
+
+        return trace_lines
+
+    def __enter__(self):
+        if self.monitoring:
+            self.monitoring.set_events(self.monitoring.COVERAGE_ID, self.events)
+        else:
+            sys.settrace(self._trace)
+        return self
+
+    def __exit__(self, *exc_info):
+        if self.monitoring:
+            self.monitoring.set_events(self.monitoring.COVERAGE_ID, 0)
+        else:
+            sys.settrace(None)
+
+    def take(self) -> set:
+        """Return the items covered for the first time since the last call."""
+        new = self.new - self.seen
+        self.seen |= new
+        self.new.clear()
+        return new
+
+
+class CoverageWorker(FastWorker):
+    """State of a worker process of CoverageFuzzRunner, tracing the coverage
+    of the Python script."""
+
+    def __init__(self, *args):
+        super().__init__(*args)
+        self.tracer = CoverageTracer(self.sim.__file__)
+
+    def run_traced(self, input_content: str, input_name: str, extra_args: list):
+        """Same as FastWorker.run_pair, also returning the coverage items first
+        reached in this worker by the Python script."""
+        perl_result = self.oracle.submit(input_content, input_name, extra_args)
+        with self.tracer:
+            python_result = run_in_process(
+                self.sim, self.python_script, input_content, input_name, extra_args, self.timeout
+            )
+        if perl_result is None:
+            perl_result = self.oracle.result()
+        return perl_result, python_result, self.tracer.take()
+
+
+_coverage_worker = None
+
+
+def _init_coverage_worker(*args):
+    global _coverage_worker
+    _coverage_worker = CoverageWorker(*args)
+
+
+def _coverage_run_pair(input_content: str, input_name: str, extra_args: list):
+    return _coverage_worker.run_traced(input_content, input_name, extra_args)
+
+
+def _coverage_untraced_pair(input_content: str, input_name: str, extra_args: list):
+    return _coverage_worker.run_pair(input_content, input_name, extra_args)
+
+
+class CoverageFuzzRunner(FastFuzzRunner):
+    """FastFuzzRunner whose workers trace the coverage of the Python script."""
+
+    worker_initializer = staticmethod(_init_coverage_worker)
+
+    def compare_traced(
+        self, input_content: str, input_name: str, extra_args: list, mode_label: str
+    ):
+        """Same as compare_one, also returning the set of coverage items first
+        reached by the input in its worker.  Returns (passed, info, items)."""
+        result, info = self.run_in_worker(
+            mode_label, _coverage_run_pair, input_content, input_name, list(extra_args)
+        )
+        if result is None:
+            return True, info, set()
+        perl_result, python_result, items = result
+        ok, info = self.compare_results(perl_result, python_result, mode_label)
+        return ok, info, items
+
+    def compare_one(self, input_content: str, input_name: str, extra_args: list, mode_label: str):
+        """Same as FastFuzzRunner.compare_one, not tracing the coverage: the
+        items first reached by an untraced input (e.g. a candidate of
+        minimize_failure) would be missed by the inputs that reach them later."""
+        result, info = self.run_in_worker(
+            mode_label, _coverage_untraced_pair, input_content, input_name, list(extra_args)
+        )
+        if result is None:
+            return True, info
+        perl_result, python_result = result
+        return self.compare_results(perl_result, python_result, mode_label)
+
+
+class CorpusEntry:
+    """An input of the corpus of coverage-guided fuzzing."""
+
+    def __init__(self, name: str, content: str, found: int):
+        self.name = name
+        self.content = content
+        self.found = found  # Number of coverage items first reached by it
+        self.picks = 0  # Number of times it was mutated
+
+    def weight(self) -> float:
+        """Entries that reached more new coverage and were mutated less
+        often are mutated first."""
+        return (1 + self.found) / (1 + self.picks)
+
+
+def count_coverage(coverage: set) -> tuple:
+    """Return the number of lines and of branches (or arcs) of coverage."""
+    lines = sum(1 for item in coverage if item[0] == "L")
+    return lines, len(coverage) - lines
+
+
+def minimize_failure(
+    runner, content: str, input_name: str, extra_args: list, mode_label: str, info: dict, max_runs
+):
+    """Remove chunks of lines from the failing input, halving the chunk size
+    when no chunk can be removed, as long as the input fails the same way.
+    Returns the minimized input, its failure info and the number of runs."""
+    lines = content.splitlines(keepends=True)
+    chunk = max(1, len(lines) // 2)
+    runs = 0
+    while chunk >= 1 and runs < max_runs:
+        removed = False
+        i = 0
+        while i < len(lines) and runs < max_runs:
+            candidate = lines[:i] + lines[i + chunk :]
+            ok, candidate_info = runner.compare_one(
+                "".join(candidate), input_name, extra_args, mode_label
+            )
+            runs += 1
+            if not ok and candidate_info.get("type") == info.get("type"):
+                lines = candidate
+                info = candidate_info
+                removed = True
+            else:
+                i += chunk
+        if not removed:
+            chunk //= 2
+        else:
+            chunk = min(chunk, max(1, len(lines) // 2))
+    return "".join(lines), info, runs
+
+
+def coverage_fuzz(args, runner, corpus: list, master_seed: int, all_cli_modes: list) -> int:
+    """Run the coverage-guided fuzzing loop: mutate the inputs of the corpus,
+    preferring those that reached new coverage, add the mutated inputs that
+    reach new coverage to the corpus, and minimize and save the failures."""
+    rng = random.Random(master_seed)
+    coverage = set()
+    queue = []
+    growth = []  # (elapsed, tests, lines, branches, corpus size)
+    branch_kind = "branches" if hasattr(sys, "monitoring") else "arcs"
+
+    total = 0
+    passed = 0
+    failed = 0
+    errors = 0
+    timeouts = 0
+    start_time = time.time()
+
+    def record(ok, info, iteration, iter_seed, input_name, content, extra_args, mode_label, origin):
+        nonlocal total, passed, failed, errors, timeouts
+        total += 1
+        if ok:
+            passed += 1
+            if info and info.get("status") == "timeout":
+                timeouts += 1
+            elif info and info.get("status") == "exec_error":
+                errors += 1
+            return
+
+        failed += 1
+        print(
+            f"FAIL [{iteration}] {input_name} ({mode_label}) - {info.get('type', 'unknown')}"
+            f" [{origin}]"
+        )
+        original = content
+        if args.minimize_runs > 0:
+            content, info, runs = minimize_failure(
+                runner, content, input_name, extra_args, mode_label, info, args.minimize_runs
+            )
+            print(
+                f"  minimized from {original.count(chr(10))} to {content.count(chr(10))}"
+                f" lines in {runs} runs"
+            )
+        info["source_file"] = origin
+        save_failure(
+            args.output_dir, iteration, iter_seed, content, input_name, info, extra_args
+        )
+        fail_dir = os.path.join(args.output_dir, f"failure_{iteration:06d}_seed{iter_seed}")
+        with open(os.path.join(fail_dir, "original_" + input_name), "wb") as f:
+            f.write(original.encode("utf-8"))
+
+    def report():
+        elapsed = time.time() - start_time
+        lines, branches = count_coverage(coverage)
+        growth.append((elapsed, total, lines, branches, len(queue)))
+        rate = total / elapsed if elapsed > 0 else 0
+        print(
+            f"[{elapsed:7.1f}s] {total} tests, {failed} failed, corpus {len(queue)}, "
+            f"coverage {lines} lines {branches} {branch_kind} ({rate:.1f} tests/s)"
+        )
+
+    with concurrent.futures.ThreadPoolExecutor(max_workers=args.workers) as pool:
+        # Run the seeds unmutated, to measure the coverage they reach
+        futures = [
+            pool.submit(runner.compare_traced, content, name, [], "default")
+            for name, content in corpus
+        ]
+        for i, ((name, content), future) in enumerate(zip(corpus, futures)):
+            ok, info, items = future.result()
+            items -= coverage
+            coverage |= items
+            queue.append(CorpusEntry(name, content, len(items)))
+            record(ok, info, i, master_seed, name, content, [], "default", name)
+        report()
+
+        iteration = len(corpus)
+        last_report = time.time()
+        try:
+            while args.iterations <= 0 or iteration < args.iterations + len(corpus):
+                batch = []
+                for _ in range(args.workers * 2):
+                    iter_seed = master_seed + iteration
+                    iter_rng = random.Random(iter_seed)
+                    entry = rng.choices(queue, weights=[e.weight() for e in queue], k=1)[0]
+                    entry.picks += 1
+                    num_mutations = iter_rng.randint(1, args.max_mutations)
+                    mutated, mutation_names = apply_mutations(
+                        iter_rng, entry.content, num_mutations
+                    )
+                    mode_label, base_args = iter_rng.choice(all_cli_modes)
+                    extra_args = list(base_args)
+                    if iter_rng.random() < 0.2:
+                        extra_args.append(f"--var-args={iter_rng.randint(1, 10)}")
+                    input_name = f"cov_{iteration:06d}.h"
+                    origin = f"{entry.name} <- {'+'.join(mutation_names)}"
+                    future = pool.submit(
+                        runner.compare_traced, mutated, input_name, extra_args, mode_label
+                    )
+                    case = (iteration, iter_seed, input_name, mutated, extra_args, mode_label)
+                    batch.append((future, case, origin))
+                    iteration += 1
+
+                for future, case, origin in batch:
+                    ok, info, items = future.result()
+                    items -= coverage
+                    if items:
+                        coverage |= items
+                        queue.append(CorpusEntry(case[2], case[3], len(items)))
+                        if args.verbose:
+                            print(f"  [{case[0]}] {case[2]} +{len(items)} [{origin}]")
+                    record(ok, info, *case, origin)
+                    if not ok and args.stop_on_fail:
+                        raise StopIteration
+
+                if time.time() - last_report >= COVERAGE_REPORT_INTERVAL:
+                    report()
+                    last_report = time.time()
+        except StopIteration:
+            print("\nStopping on first failure.")
+        except KeyboardInterrupt:
+            print("\n\nInterrupted by user.")
+
+    runner.close()
+    report()
+
+    # Save the corpus, usable as the '--corpus-dir' of a later run, and the
+    # growth of the coverage over time
+    corpus_dir = os.path.join(args.output_dir, "corpus")
+    os.makedirs(corpus_dir, exist_ok=True)
+    for entry in queue:
+        with open(os.path.join(corpus_dir, entry.name), "wb") as f:
+            f.write(entry.content.encode("utf-8"))
+    with open(os.path.join(args.output_dir, "coverage_growth.csv"), "w", encoding="utf-8") as f:
+        f.write("elapsed,tests,lines,branches,corpus\n")
+        for elapsed, tests, lines, branches, size in growth:
+            f.write(f"{elapsed:.1f},{tests},{lines},{branches},{size}\n")
+
+    elapsed = time.time() - start_time
+    lines, branches = count_coverage(coverage)
+    print()
+    print("=" * 60)
+    print("Coverage-guided fuzz testing complete")
+    print(f"  Master seed:  {master_seed}")
+    print(f"  Total tests:  {total}")
+    print(f"  Passed:       {passed}")
+    print(f"  Failed:       {failed}")
+    print(f"  Errors:       {errors}")
+    print(f"  Timeouts:     {timeouts}")
+    print(f"  Coverage:     {lines} lines, {branches} {branch_kind}")
+    print(f"  Corpus:       {len(queue)} inputs ({len(queue) - len(corpus)} new) in {corpus_dir}")
+    print(f"  Elapsed:      {elapsed:.1f}s ({total / elapsed if elapsed > 0 else 0:.1f} tests/s)")
+    if failed > 0:
+        print(f"  Failures in:  {args.output_dir}")
+    print("=" * 60)
+
+    return 1 if failed > 0 else 0
+
+
 # ============================================================================
 #                           MAIN
 # ============================================================================
@@ -378,6 +778,22 @@ def main():
     )
     parser.add_argument("--verbose", "-v", action="store_true", help="Print each test case")
     parser.add_argument("--stop-on-fail", action="store_true", help="Stop on first failure")
+    parser.add_argument(
+        "--fast",
+        action="store_true",
+        help="Run the Python script in-process and the Perl script in a long-lived co-process",
+    )
+    parser.add_argument(
+        "--coverage",
+        action="store_true",
+        help="Coverage-guided mode: keep and mutate the inputs reaching new coverage",
+    )
+    parser.add_argument(
+        "--minimize-runs",
+        type=int,
+        default=200,
+        help="Maximum runs minimizing each failure with --coverage (default: 200)",
+    )
     parser.add_argument(
         "--workers",
         "-j",
@@ -452,20 +868,43 @@ def main():
     print(f"Python exe: {python_exe}")
     print(f"Timeout: {args.timeout}s")
     print(f"Workers: {args.workers}")
+    if args.coverage:
+        print("Mode: coverage-guided (in-process)")
+    else:
+        print(f"Mode: {'fast (in-process)' if args.fast else 'one process per script run'}")
     print(f"Max mutations: {args.max_mutations}")
     print(f"Output dir: {args.output_dir}")
     print()
 
     os.makedirs(args.output_dir, exist_ok=True)
 
-    runner = FuzzRunner(
-        perl_script=args.perl,
-        python_script=args.python,
-        perl_exe=args.perl_exe,
-        python_exe=python_exe,
-        timeout=args.timeout,
-        output_dir=args.output_dir,
-    )
+    if args.coverage:
+        runner = CoverageFuzzRunner(
+            perl_script=args.perl,
+            python_script=args.python,
+            perl_exe=args.perl_exe,
+            timeout=args.timeout,
+            output_dir=args.output_dir,
+            workers=args.workers,
+        )
+    elif args.fast:
+        runner = FastFuzzRunner(
+            perl_script=args.perl,
+            python_script=args.python,
+            perl_exe=args.perl_exe,
+            timeout=args.timeout,
+            output_dir=args.output_dir,
+            workers=args.workers,
+        )
+    else:
+        runner = FuzzRunner(
+            perl_script=args.perl,
+            python_script=args.python,
+            perl_exe=args.perl_exe,
+            python_exe=python_exe,
+            timeout=args.timeout,
+            output_dir=args.output_dir,
+        )
 
     # CLI modes
     all_cli_modes = [
@@ -475,6 +914,9 @@ def main():
         ("clean", ["--clean"]),
     ]
 
+    if args.coverage:
+        return coverage_fuzz(args, runner, corpus, master_seed, all_cli_modes)
+
     total = 0
     passed = 0
     failed = 0
@@ -665,6 +1107,8 @@ def main():
     except KeyboardInterrupt:
         print("\n\nInterrupted by user.")
 
+    runner.close()
+
     # Final summary
     elapsed = time.time() - start_time
     rate = total / elapsed if elapsed > 0 else 0
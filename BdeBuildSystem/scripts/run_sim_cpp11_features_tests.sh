@@ -27,9 +27,11 @@ PYTHON_SCRIPT="$SCRIPT_DIR/sim_cpp11_features.py"
 PERL_DIR="$WORK_DIR/perl"
 PYTHON_DIR="$WORK_DIR/python"
 CLI_DIR="$WORK_DIR/cli"
+ARITY_DIR="$WORK_DIR/arity"
+COMPACT_DIR="$WORK_DIR/compact"
 
 rm -rf "$WORK_DIR"
-mkdir -p "$PERL_DIR" "$PYTHON_DIR" "$CLI_DIR"
+mkdir -p "$PERL_DIR" "$PYTHON_DIR" "$CLI_DIR" "$ARITY_DIR" "$COMPACT_DIR"
 
 PASSED=0
 FAILED=0
@@ -43,6 +45,14 @@ normalize() {
         -e 's/sim_cpp11_features\.py/sim_cpp11_features.SCRIPT/g'
 }
 
+# Options listed in the usage text of the Python version only
+PYTHON_ONLY_OPTIONS="jobs|file-list|force|cache-dir|compact|suggest-var-args|usage-file-list|compile-db|watch|poll-interval"
+
+# Remove the Python-only options from a usage text
+strip_python_only_options() {
+    grep -vE -- "^ +\[ *--(${PYTHON_ONLY_OPTIONS})([= ]|\]|$)"
+}
+
 # Normalize debug output (same as normalize for now - all trace calls match)
 normalize_debug() {
     normalize
@@ -204,7 +214,7 @@ run_debug_test() {
 
 # Test: stdin to stdout (error case)
 cat "$CLI_TEST_FILE" | perl "$PERL_SCRIPT" - > "$CLI_DIR/perl_stdin.out" 2>&1 || true
-cat "$CLI_TEST_FILE" | $PYTHON3 "$PYTHON_SCRIPT" - > "$CLI_DIR/python_stdin.out" 2>&1 || true
+cat "$CLI_TEST_FILE" | $PYTHON3 "$PYTHON_SCRIPT" - 2>&1 | strip_python_only_options > "$CLI_DIR/python_stdin.out"
 run_cli_test "stdin error" "$CLI_DIR/perl_stdin.out" "$CLI_DIR/python_stdin.out"
 
 # Test: file to stdout (default)
@@ -283,6 +293,74 @@ cp "$TEST_DIR/test_comprehensive.h" "$CLI_TEST_FILE"
 (cd "$CLI_DIR" && $PYTHON3 "$PYTHON_SCRIPT" --debug=2 "test_comprehensive.h") > "$CLI_DIR/python_d2.out" 2>&1 || true
 run_debug_test "--debug=2" "$CLI_DIR/perl_d2.out" "$CLI_DIR/python_d2.out"
 
+# Compare an output of the Python version with the expected one, after
+# normalization
+run_expected_test() {
+    local test_name="$1"
+    local expected="$2"
+    local actual="$3"
+
+    echo -n "Testing $test_name... "
+
+    normalize < "$expected" > "$actual.expected.norm"
+    normalize < "$actual" > "$actual.norm"
+
+    if diff -q "$actual.expected.norm" "$actual.norm" > /dev/null 2>&1; then
+        echo "PASSED"
+        PASSED=$((PASSED + 1))
+    else
+        echo "FAILED"
+        echo "    Diff ($test_name):"
+        diff "$actual.expected.norm" "$actual.norm" | head -20
+        FAILED=$((FAILED + 1))
+    fi
+}
+
+echo ""
+echo "Part 4: Compact expansion (Python only)"
+echo "----------------------------------------"
+
+# Test: --compact generates the repetitions as macro invocations, with the
+# padded names of the copies when the limit has two digits
+COMPACT_TEST_DIR="$TEST_DIR/compact"
+cp "$COMPACT_TEST_DIR/test_compact.h" "$COMPACT_DIR"
+(cd "$COMPACT_DIR" && $PYTHON3 "$PYTHON_SCRIPT" --compact test_compact.h) > /dev/null 2>&1 || true
+run_expected_test "--compact (test_compact.h)" "$COMPACT_TEST_DIR/test_compact.h.expected" "$COMPACT_DIR/test_compact.h"
+run_expected_test "--compact (test_compact_cpp03.h)" "$COMPACT_TEST_DIR/test_compact_cpp03.h.expected" "$COMPACT_DIR/test_compact_cpp03.h"
+
+echo ""
+echo "Part 5: Variadic arity analysis (Python only)"
+echo "----------------------------------------"
+
+ARITY_TEST_DIR="$TEST_DIR/arity"
+ARITY_FILES="arity_widget.h arity_tuple.h"
+
+cp "$ARITY_TEST_DIR"/*.h "$ARITY_TEST_DIR"/*.cpp "$ARITY_DIR"
+echo "arity_widget.t.cpp" > "$ARITY_DIR/uses.txt"
+
+# Test: report of the proposed limits; a template with no uses keeps its limit
+(cd "$ARITY_DIR" && $PYTHON3 "$PYTHON_SCRIPT" --suggest-var-args --usage-file-list uses.txt $ARITY_FILES) > "$ARITY_DIR/arity.out" 2>&1 || true
+run_expected_test "--suggest-var-args" "$ARITY_TEST_DIR/arity.out" "$ARITY_DIR/arity.out"
+
+# Test: --inplace is refused without an explicit corpus, and changes nothing
+echo -n "Testing --suggest-var-args --inplace without corpus... "
+if (cd "$ARITY_DIR" && $PYTHON3 "$PYTHON_SCRIPT" --suggest-var-args --inplace $ARITY_FILES) > "$ARITY_DIR/refused.out" 2>&1; then
+    echo "FAILED (not refused)"
+    FAILED=$((FAILED + 1))
+elif ! diff -q "$ARITY_TEST_DIR/arity_widget.h" "$ARITY_DIR/arity_widget.h" > /dev/null 2>&1; then
+    echo "FAILED (file modified)"
+    FAILED=$((FAILED + 1))
+else
+    echo "PASSED"
+    PASSED=$((PASSED + 1))
+fi
+
+# Test: --inplace writes the proposed limits into the input files
+(cd "$ARITY_DIR" && $PYTHON3 "$PYTHON_SCRIPT" --suggest-var-args --inplace --usage-file-list uses.txt $ARITY_FILES) > /dev/null 2>&1 || true
+for file in $ARITY_FILES; do
+    run_expected_test "--suggest-var-args --inplace ($file)" "$ARITY_TEST_DIR/$file.expected" "$ARITY_DIR/$file"
+done
+
 echo ""
 echo "========================================"
 echo "Results: $PASSED passed, $FAILED failed"
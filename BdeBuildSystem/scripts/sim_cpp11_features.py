@@ -20,9 +20,22 @@ extremely useful.
 """
 
 import argparse
+import bisect
+import concurrent.futures
+import contextlib
+import ctypes
+import ctypes.util
+import hashlib
+import io
+import json
 import os
 import re
+import select
+import struct
 import sys
+import tempfile
+import time
+import traceback
 from datetime import datetime
 from typing import Iterator, NamedTuple, Optional, List, Tuple, Dict
 
@@ -39,6 +52,21 @@ class Job(NamedTuple):
     output_filename: str
 
 
+def read_file_list(file_list: str) -> List[str]:
+    """Return the file names listed, one per line, in the specified file
+    (standard input if '-'), skipping blank lines and '#' comments."""
+    try:
+        if file_list == "-":
+            lines = sys.stdin.readlines()
+        else:
+            with open(file_list, "r") as f:
+                lines = f.readlines()
+    except OSError as e:
+        print(f"Cannot read file list {file_list}: {e.strerror}", file=sys.stderr)
+        sys.exit(1)
+    return [line.strip() for line in lines if line.strip() and not line.strip().startswith("#")]
+
+
 class Params:
     """Read-only, frozen run-time options parsed from the command line.
 
@@ -75,6 +103,15 @@ class Params:
     timestamp_comment: str
     files: Tuple[str, ...]
     output: Optional[str]
+    jobs: int
+    force: bool
+    compact: bool
+    cache_dir: Optional[str]
+    suggest_var_args: bool
+    usage_files: Tuple[str, ...]
+    compile_db: Optional[str]
+    watch_dirs: Tuple[str, ...]
+    poll_interval: float
 
     def __init__(self, argv: Optional[List[str]] = None) -> None:
         """Parse the command line and populate every option.
@@ -103,9 +140,7 @@ class Params:
             action="store_true",
             help="Verify that nothing has changed",
         )
-        parser.add_argument(
-            "--clean", action="store_true", help="Remove all C++03 emulation code"
-        )
+        parser.add_argument("--clean", action="store_true", help="Remove all C++03 emulation code")
         parser.add_argument(
             "--test", action="store_true", help="Run the tool on built-in test file"
         )
@@ -115,6 +150,73 @@ class Params:
             default=0,
             help="Maximum number of variadic template expansions",
         )
+        parser.add_argument(
+            "--jobs",
+            "-j",
+            type=int,
+            default=1,
+            help="Number of files processed in parallel (0 for one per CPU)",
+        )
+        parser.add_argument(
+            "--compact",
+            action="store_true",
+            help="Generate the repetitions of variadic templates as macro "
+            "invocations instead of copies (written into the file as $compact)",
+        )
+        parser.add_argument(
+            "--force",
+            action="store_true",
+            help="Run the transformations even if the cache shows that the "
+            "C++03 file is up to date, and ignore the cache",
+        )
+        parser.add_argument(
+            "--cache-dir",
+            default=os.environ.get("SIM_CPP11_FEATURES_CACHE_DIR"),
+            help="Directory caching the generated output of each input and the "
+            "digests of the C++03 files (default: $SIM_CPP11_FEATURES_CACHE_DIR, "
+            "no cache if unset)",
+        )
+        parser.add_argument(
+            "--file-list",
+            action="append",
+            default=[],
+            help="File listing input files, one per line ('-' for standard "
+            "input), in addition to the input files on the command line",
+        )
+        parser.add_argument(
+            "--watch",
+            action="append",
+            default=[],
+            metavar="DIR",
+            help="Regenerate the C++03 files of the sources under DIR whenever "
+            "the sources change, until interrupted (may be repeated)",
+        )
+        parser.add_argument(
+            "--poll-interval",
+            type=float,
+            default=0,
+            help="With --watch, scan the directories every POLL_INTERVAL "
+            "seconds instead of using inotify",
+        )
+        parser.add_argument(
+            "--suggest-var-args",
+            action="store_true",
+            help="Propose the smallest $var-args and $local-var-args covering "
+            "the uses of the variadic templates of the input files (written "
+            "into the files with --inplace)",
+        )
+        parser.add_argument(
+            "--usage-file-list",
+            action="append",
+            default=[],
+            help="File listing the files scanned for uses by --suggest-var-args, "
+            "one per line ('-' for standard input)",
+        )
+        parser.add_argument(
+            "--compile-db",
+            help="Compilation database (compile_commands.json) whose sources "
+            "are scanned for uses by --suggest-var-args",
+        )
         parser.add_argument(
             "files",
             nargs="*",
@@ -136,16 +238,67 @@ class Params:
 
         inplace = args.inplace and not args.no_inplace
 
+        input_files = list(args.files)
+        for file_list in args.file_list:
+            input_files += read_file_list(file_list)
+
+        usage_files = []
+        for file_list in args.usage_file_list:
+            usage_files += read_file_list(file_list)
+
+        if args.jobs < 0:
+            print("Option --jobs requires a non-negative number", file=sys.stderr)
+            sys.exit(1)
+
         if args.clean and not inplace:
             print("Option --clean requires --inplace", file=sys.stderr)
             sys.exit(1)
-        if args.test and args.files:
+        if args.suggest_var_args and (args.clean or args.test or args.output_option):
+            print(
+                "Option --suggest-var-args cannot be combined with --clean, " "--test or --output",
+                file=sys.stderr,
+            )
+            sys.exit(1)
+        if args.suggest_var_args and inplace and not (usage_files or args.compile_db):
+            print(
+                "Option --suggest-var-args with --inplace requires --usage-file-list "
+                "or --compile-db",
+                file=sys.stderr,
+            )
+            sys.exit(1)
+        if (usage_files or args.compile_db) and not args.suggest_var_args:
+            print(
+                "Options --usage-file-list and --compile-db require --suggest-var-args",
+                file=sys.stderr,
+            )
+            sys.exit(1)
+        if args.test and input_files:
             print("Cannot specify filename with --test", file=sys.stderr)
             sys.exit(1)
-        if not args.test and not args.files:
+        if args.watch and (
+            input_files
+            or args.test
+            or args.clean
+            or args.inplace
+            or args.output_option
+            or args.verify_no_change
+            or args.suggest_var_args
+        ):
+            print(
+                "Option --watch cannot be combined with input files, --test, --clean, "
+                "--inplace, --output, --verify-no-change or --suggest-var-args",
+                file=sys.stderr,
+            )
+            sys.exit(1)
+        if args.poll_interval < 0 or (args.poll_interval and not args.watch):
+            print(
+                "Option --poll-interval requires --watch and a non-negative number", file=sys.stderr
+            )
+            sys.exit(1)
+        if not args.test and not input_files and not args.watch:
             print("Must specify an input file name or -", file=sys.stderr)
             sys.exit(1)
-        if len(args.files) > 1 and args.output_option:
+        if len(input_files) > 1 and args.output_option:
             print(
                 "Only one input file name may be specified when using --output",
                 file=sys.stderr,
@@ -158,7 +311,7 @@ class Params:
         else:
             # Strip a '_cpp03' marker (reserved for outputs) that precedes
             # the extension so, e.g., 'foo_cpp03.h' is treated as 'foo.h'.
-            files = tuple(re.sub(r"_cpp03(?=\.|\Z)", "", f) for f in args.files)
+            files = tuple(re.sub(r"_cpp03(?=\.|\Z)", "", f) for f in input_files)
             output = args.output_option
 
         timestamp = datetime.now().strftime("%a %b %d %H:%M:%S %Y")
@@ -181,6 +334,15 @@ class Params:
         set_(self, "timestamp_comment", Params.TIMESTAMP_PREFIX + timestamp)
         set_(self, "files", files)
         set_(self, "output", output)
+        set_(self, "jobs", args.jobs or os.cpu_count() or 1)
+        set_(self, "force", args.force)
+        set_(self, "compact", args.compact)
+        set_(self, "cache_dir", args.cache_dir or None)
+        set_(self, "suggest_var_args", args.suggest_var_args)
+        set_(self, "usage_files", tuple(usage_files))
+        set_(self, "compile_db", args.compile_db)
+        set_(self, "watch_dirs", tuple(args.watch))
+        set_(self, "poll_interval", args.poll_interval)
 
     def __setattr__(self, name: str, value: object) -> None:
         raise AttributeError(f"Params is frozen; cannot assign to {name!r}")
@@ -208,11 +370,11 @@ class Params:
 
     def get_command_line(self, filename: str, use_basename: bool = True) -> str:
         """Return the minimal command-line options and current filename.  The
-           returned command elides the '.py' from this script name since that's
-           the invocable wrapper name.
+        returned command elides the '.py' from this script name since that's
+        the invocable wrapper name.
 
-           If `use_basename` is true, the returned commandline removes the path
-           component from `filename`.
+        If `use_basename` is true, the returned commandline removes the path
+        component from `filename`.
         """
         ret = os.path.splitext(os.path.basename(sys.argv[0]))[0]
 
@@ -253,17 +415,47 @@ class Params:
 #                             GLOBAL STATE
 # ============================================================================
 
-# Per-file mutable state (reset in ``process_file``).  These will be moved
-# into a per-file context object in a follow-up refactor step.
-file_max_args = 10
-max_args = file_max_args
-variadic_limit_base = ""
-variadic_limit = ""
-bottom_copyright = ""  # Copyright text extracted from input file (bottom style)
-top_copyright = ""  # Copyright text extracted from input file (top style)
 
-# Set of class templates that have been forward declared already
-class_template_forward_declared: Dict[str, bool] = {}
+class FileContext:
+    """Mutable state of the processing of one input file.
+
+    ``process_file`` creates a context per file and passes it explicitly to
+    the transformations, so that files are processed independently of each
+    other (and may be processed in different worker processes, see
+    ``--jobs``).
+    """
+
+    def __init__(self, params: Params, input_filename: str) -> None:
+        self.file_max_args = params.default_max_args
+        self.max_args = params.max_args_opt or self.file_max_args
+
+        base = re.sub(r"\..*", "", os.path.basename(input_filename))
+        self.variadic_limit_base = base.upper() + "_VARIADIC_LIMIT"
+        self.variadic_limit = ""
+
+        self.bottom_copyright = ""  # Copyright text from input file (bottom style)
+        self.top_copyright = ""  # Copyright text from input file (top style)
+
+        # Set of class templates that have been forward declared already
+        self.class_template_forward_declared: Dict[str, bool] = {}
+
+        # Generated parameter counter
+        self.next_gen_param = 0
+
+        # Compact expansion of the current region (see 'compact_repeat_packs'),
+        # the number of repetitions supported by each family of iteration
+        # macros defined so far in the region and the counter of the generated
+        # macros
+        self.compact = False
+        self.compact_repeat_limit: Dict[str, int] = {}
+        self.next_compact_macro = 0
+
+    def gen_name(self, prefix: str) -> str:
+        """Return a unique generated name using the supplied prefix argument."""
+        result = f"{prefix}{self.next_gen_param}"
+        self.next_gen_param += 1
+        return result
+
 
 # 80 spaces for constructing indentations
 SPACES = " " * 80
@@ -275,15 +467,6 @@ DUMMY_CHAR = "."  # For debug mode; use "\xb7" (centered dot) for production
 #                           INPUT CONTEXT
 # ============================================================================
 
-# Input file as a single string
-input_text = ""
-input_end = 0
-shrouded_input = ""
-input_pos = 0
-
-# Input context stack
-input_stack: List[Tuple[str, int, str, int]] = []
-
 # cppSearch state
 cpp_match: List[Optional[str]] = []
 cpp_match_all: Optional[str] = None
@@ -316,6 +499,16 @@ Usage: sim_cpp11_features.pl [ --output=<filename> ]
                              [ --verify-no-change ]
                              [ --clean ]
                              [ --test ]
+                             [ --jobs=<count> ]
+                             [ --compact ]
+                             [ --force ]
+                             [ --cache-dir=<directory> ]
+                             [ --file-list=<filename> ]...
+                             [ --watch=<directory> ]...
+                             [ --poll-interval=<seconds> ]
+                             [ --suggest-var-args
+                               [ --usage-file-list=<filename> ]...
+                               [ --compile-db=<filename> ] ]
                              {{ <input-file>... | - }}""")
     sys.exit(1)
 
@@ -365,14 +558,13 @@ def shroud_comments_and_strings(text: str) -> str:
     literals in the specified string so that they contain no C++ tokens that
     might confuse a regular expression search.
     """
-    result = text
+    # Every replacement has the same length as the text it replaces and the
+    # search never looks behind its starting point, so the matches can be
+    # found in the original text and the result assembled in one pass.
+    parts = []
     pos = 0
 
-    while True:
-        match = COMMENT_AND_STRING_RE.search(result, pos)
-        if not match:
-            break
-
+    for match in COMMENT_AND_STRING_RE.finditer(text):
         start, end = match.start(), match.end()
         comment = match.group(1) or match.group(2)
         literal = match.group(3) or match.group(4)
@@ -380,17 +572,22 @@ def shroud_comments_and_strings(text: str) -> str:
         if comment:
             replacement = comment_to_whitespace(comment, "keep-len")
         elif literal:
-            first = result[start]
-            last = result[end - 1]
+            first = text[start]
+            last = text[end - 1]
             replacement = DUMMY_CHAR * len(literal)
             replacement = first + replacement[1:-1] + last
         else:
             raise RuntimeError("Shouldn't get here")
 
-        result = result[:start] + replacement + result[end:]
-        pos = start + len(replacement)
+        parts.append(text[pos:start])
+        parts.append(replacement)
+        pos = end
 
-    return result
+    if not parts:
+        return text
+
+    parts.append(text[pos:])
+    return "".join(parts)
 
 
 def strip_comments(text: str, option: str = "single-ws") -> str:
@@ -420,11 +617,7 @@ def strip_comments(text: str, option: str = "single-ws") -> str:
 
         if match.group(1) or match.group(2):
             comment = match.group(0)
-            if (
-                option == "single-ws"
-                and last == "\n"
-                and (start == 0 or result[start - 1] == "\n")
-            ):
+            if option == "single-ws" and last == "\n" and (start == 0 or result[start - 1] == "\n"):
                 # Comment takes one or more whole lines. Replace with nothing.
                 comment = ""
             else:
@@ -437,47 +630,274 @@ def strip_comments(text: str, option: str = "single-ws") -> str:
     return result
 
 
+# ============================================================================
+#                           LEXICAL INDEX
+# ============================================================================
+
+# Preprocessor directive, as searched for by 'cpp_find_matching_pp_directive'
+PP_DIRECTIVE_RE = re.compile(r"^[ \t]*\#[ \t]*(\w+).*\n", re.MULTILINE)
+
+
+class BracketTable:
+    """The brackets of a shrouded buffer, lexed once, and their matches.
+
+    ``positions`` lists the position of every bracket in the buffer and
+    ``match`` maps the position of each opening bracket to the position just
+    after its closing bracket, or to -1 if the scan of ``find_matching_brace``
+    starting at that bracket would not end on a closing bracket (because of a
+    mismatched or missing closing bracket).  If ``angle`` is true, '<' and
+    '>' are brackets too, and they are matched with the same heuristics as
+    ``find_matching_brace`` uses for template parameter lists: an unmatched
+    '<' (e.g. a less-than operator) is dropped by the next closing bracket of
+    another kind, and a '>' closing nothing is ignored.
+    """
+
+    __slots__ = ("positions", "match")
+
+    def __init__(self, shrouded: str, angle: bool) -> None:
+        bracket_re = r"[\[\](){}<>]" if angle else r"[\[\](){}]"
+        self.positions = [m.start() for m in re.finditer(bracket_re, shrouded)]
+        self.match: Dict[int, int] = {}
+
+        # Positions of the open brackets, and the closing bracket expected
+        # for each.
+        stack: List[int] = []
+        expected: List[str] = []
+
+        for pos in self.positions:
+            bracket = shrouded[pos]
+            closing = MATCHING_BRACKETS.get(bracket)
+            if closing:
+                stack.append(pos)
+                expected.append(closing)
+                continue
+
+            while expected and expected[-1] != bracket and expected[-1] == ">":
+                self.match[stack.pop()] = -1
+                expected.pop()
+
+            if expected and expected[-1] == bracket:
+                self.match[stack.pop()] = pos + 1
+                expected.pop()
+            elif bracket != ">":
+                # Mismatched bracket: scanning from any open bracket fails.
+                for open_pos in stack:
+                    self.match[open_pos] = -1
+                stack = []
+                expected = []
+
+        for open_pos in stack:
+            self.match[open_pos] = -1
+
+
+class PPDirectiveIndex:
+    """The preprocessor directives of a shrouded buffer, lexed once.
+
+    ``starts`` and ``ends`` are the boundaries of each directive line (the
+    end including the newline), ``names`` the directive names (e.g. 'ifdef'),
+    and ``endif`` maps the index of each '#if', '#ifdef' and '#ifndef' to the
+    index of its '#endif', if any.
+    """
+
+    __slots__ = ("starts", "ends", "name_starts", "name_ends", "names", "endif")
+
+    def __init__(self, shrouded: str, text: str) -> None:
+        self.starts: List[int] = []
+        self.ends: List[int] = []
+        self.name_starts: List[int] = []
+        self.name_ends: List[int] = []
+        self.names: List[str] = []
+        self.endif: Dict[int, int] = {}
+
+        open_ifs: List[int] = []
+        for match in PP_DIRECTIVE_RE.finditer(shrouded):
+            index = len(self.names)
+            name = text[match.start(1) : match.end(1)]
+            self.starts.append(match.start())
+            self.ends.append(match.end())
+            self.name_starts.append(match.start(1))
+            self.name_ends.append(match.end(1))
+            self.names.append(name)
+
+            if name.startswith("if"):
+                open_ifs.append(index)
+            elif name == "endif" and open_ifs:
+                self.endif[open_ifs.pop()] = index
+
+
 # ============================================================================
 #                           INPUT MANAGEMENT
 # ============================================================================
 
 
+class TextBuffer:
+    """An input string, its shrouded mirror, and an index of its lines.
+
+    ``text`` and ``shrouded`` always have the same length, and a position in
+    one is the same position in the other.  Both are kept as flat strings,
+    since every ``cpp_search`` runs a regular expression over ``shrouded``;
+    ``substitute`` edits both, re-shrouding only the substituted text.  The
+    line index (the position at which each line starts) is built lazily, up
+    to the highest position looked up so far, and an edit discards only the
+    part of the index that follows the edit, so ``line_and_column`` does not
+    re-count the lines from the beginning of the buffer on every call.  The
+    bracket tables and the directive index are lexed on first use and
+    discarded by an edit.
+    """
+
+    __slots__ = (
+        "text",
+        "shrouded",
+        "pos",
+        "_line_starts",
+        "_indexed_to",
+        "_bracket_tables",
+        "_pp_directives",
+    )
+
+    def __init__(self, text: str) -> None:
+        self.text = text
+        self.shrouded = shroud_comments_and_strings(text)
+        self.pos = 0  # End of the last successful ``cpp_search``
+        self._line_starts = [0]
+        self._indexed_to = 0
+        self._bracket_tables: Dict[bool, BracketTable] = {}
+        self._pp_directives: Optional[PPDirectiveIndex] = None
+
+    @property
+    def end(self) -> int:
+        return len(self.text)
+
+    def substitute(self, start: int, length: int, subst: str) -> None:
+        """Replace ``length`` characters at ``start`` with ``subst``."""
+        end = start + length
+        self.text = self.text[:start] + subst + self.text[end:]
+        self.shrouded = (
+            self.shrouded[:start] + shroud_comments_and_strings(subst) + self.shrouded[end:]
+        )
+        self._bracket_tables = {}
+        self._pp_directives = None
+
+        if self._indexed_to > start:
+            # Keep the lines starting at or before 'start'; those are not
+            # affected by the edit.
+            del self._line_starts[bisect.bisect_right(self._line_starts, start) :]
+            self._indexed_to = start
+
+    def brackets(self, angle: bool) -> BracketTable:
+        """Return the bracket table, with '<' and '>' if ``angle`` is true."""
+        table = self._bracket_tables.get(angle)
+        if table is None:
+            table = BracketTable(self.shrouded, angle)
+            self._bracket_tables[angle] = table
+        return table
+
+    def pp_directives(self) -> PPDirectiveIndex:
+        """Return the index of the preprocessor directives."""
+        if self._pp_directives is None:
+            self._pp_directives = PPDirectiveIndex(self.shrouded, self.text)
+        return self._pp_directives
+
+    def line_start(self, pos: int) -> int:
+        """Return the position of the start of the line containing ``pos``."""
+        if pos > self._indexed_to:
+            text = self.text
+            line_starts = self._line_starts
+            newline = text.find("\n", self._indexed_to, pos)
+            while newline >= 0:
+                line_starts.append(newline + 1)
+                newline = text.find("\n", newline + 1, pos)
+            self._indexed_to = pos
+
+        return self._line_starts[bisect.bisect_right(self._line_starts, pos) - 1]
+
+    def line_and_column(self, pos: int) -> Tuple[int, int]:
+        """Return the line and column numbers (both 1-based) at ``pos``."""
+        line_start = self.line_start(pos)
+        return (bisect.bisect_right(self._line_starts, line_start), pos - line_start + 1)
+
+
+# Current input and the stack of saved input contexts
+input_buffer = TextBuffer("")
+input_stack: List[TextBuffer] = []
+
+
 def set_input(instr: str) -> None:
     """Sets the input string and resets/populates the shrouded input string."""
-    global input_text, input_end, input_pos, shrouded_input
+    global input_buffer
 
-    input_text = instr.replace("\r\n", "\n")  # Normalize newlines
-    if input_text and input_text[-1] != "\n":
-        input_text += "\n"
-    input_end = len(input_text)
-    input_pos = 0
-    shrouded_input = shroud_comments_and_strings(input_text)
+    text = instr.replace("\r\n", "\n")  # Normalize newlines
+    if text and text[-1] != "\n":
+        text += "\n"
+    input_buffer = TextBuffer(text)
 
 
 def push_input(instr: str) -> None:
     """Like set_input but preserves the previous input context."""
-    global input_stack
-    input_stack.append((input_text, input_end, shrouded_input, input_pos))
+    input_stack.append(input_buffer)
     set_input(instr)
 
 
 def pop_input() -> str:
     """Restore the input context from the top of the context stack."""
-    global input_text, input_end, shrouded_input, input_pos
+    global input_buffer
 
     if not input_stack:
         raise RuntimeError("Empty input stack")
 
-    ret = input_text
-    input_text, input_end, shrouded_input, input_pos = input_stack.pop()
+    ret = input_buffer.text
+    input_buffer = input_stack.pop()
     return ret
 
 
+def reset_input() -> None:
+    """Discard the input contexts and the cppSearch state left over from the
+    processing of a previous file (possibly one that failed)."""
+    global input_buffer
+
+    input_buffer = TextBuffer("")
+    input_stack.clear()
+    clear_cpp_match()
+
+
 # ============================================================================
 #                           C++ CODE SEARCHES
 # ============================================================================
 
 
+def set_cpp_match(starts: List[int], ends: List[int]) -> None:
+    """Set the cppSearch state to the match (group 0 first) having the
+    specified group boundaries, a group that did not participate in the match
+    having a negative start."""
+    global cpp_match, cpp_match_all, cpp_match_start, cpp_match_end
+
+    input_text = input_buffer.text
+    cpp_match_start = starts
+    cpp_match_end = ends
+
+    # Get actual text from original input (not shrouded)
+    cpp_match_all = input_text[starts[0] : ends[0]]
+    cpp_match = [cpp_match_all]
+
+    for i in range(1, len(starts)):
+        if starts[i] is not None and starts[i] >= 0:
+            cpp_match.append(input_text[starts[i] : ends[i]])
+        else:
+            cpp_match.append(None)
+
+    input_buffer.pos = ends[0]
+
+
+def clear_cpp_match() -> None:
+    """Reset the cppSearch state after a failed search."""
+    global cpp_match, cpp_match_all, cpp_match_start, cpp_match_end
+
+    cpp_match = []
+    cpp_match_all = None
+    cpp_match_start = []
+    cpp_match_end = []
+
+
 def cpp_search(pattern: str, pos: int = 0, endpos: Optional[int] = None) -> bool:
     """
     Search the input string for the specified pattern.
@@ -486,10 +906,8 @@ def cpp_search(pattern: str, pos: int = 0, endpos: Optional[int] = None) -> bool
     Sets global variables cpp_match, cpp_match_all, cpp_match_start, cpp_match_end.
     Returns True on success, False on failure.
     """
-    global cpp_match, cpp_match_all, cpp_match_start, cpp_match_end, input_pos
-
     if endpos is None:
-        endpos = input_end
+        endpos = input_buffer.end
 
     # Handle \G anchor (match at position) by using match instead of search
     anchored = False
@@ -504,31 +922,18 @@ def cpp_search(pattern: str, pos: int = 0, endpos: Optional[int] = None) -> bool
         regex = pattern
 
     if anchored:
-        match = regex.match(shrouded_input, pos, endpos)
+        match = regex.match(input_buffer.shrouded, pos, endpos)
     else:
-        match = regex.search(shrouded_input, pos, endpos)
+        match = regex.search(input_buffer.shrouded, pos, endpos)
     if match and match.end() <= endpos:
-        cpp_match_start = [match.start()] + [match.start(i) for i in range(1, regex.groups + 1)]
-        cpp_match_end = [match.end()] + [match.end(i) for i in range(1, regex.groups + 1)]
-
-        # Get actual text from original input (not shrouded)
-        cpp_match_all = input_text[cpp_match_start[0] : cpp_match_end[0]]
-        cpp_match = [cpp_match_all]
-
-        for i in range(1, len(cpp_match_start)):
-            if cpp_match_start[i] is not None and cpp_match_start[i] >= 0:
-                cpp_match.append(input_text[cpp_match_start[i] : cpp_match_end[i]])
-            else:
-                cpp_match.append(None)
-
-        input_pos = cpp_match_end[0]
+        set_cpp_match(
+            [match.start()] + [match.start(i) for i in range(1, regex.groups + 1)],
+            [match.end()] + [match.end(i) for i in range(1, regex.groups + 1)],
+        )
         return True
 
     # No match found
-    cpp_match = []
-    cpp_match_all = None
-    cpp_match_start = []
-    cpp_match_end = []
+    clear_cpp_match()
     return False
 
 
@@ -537,15 +942,10 @@ def cpp_substitute(start: int, length: int, subst: str) -> None:
     Replace the substring in input beginning at the specified start position.
     Adjust all of the cppSearch state accordingly.
     """
-    global input_text, shrouded_input, input_end, cpp_match_start, cpp_match_end, input_pos
-
     end = start + length
     length_change = len(subst) - length
 
-    input_text = input_text[:start] + subst + input_text[end:]
-    shrouded_input = (
-        shrouded_input[:start] + shroud_comments_and_strings(subst) + shrouded_input[end:]
-    )
+    input_buffer.substitute(start, length, subst)
 
     # Adjust match positions
     for i in range(len(cpp_match_start)):
@@ -556,15 +956,11 @@ def cpp_substitute(start: int, length: int, subst: str) -> None:
         if cpp_match_end[i] is not None and cpp_match_end[i] >= end:
             cpp_match_end[i] += length_change
 
-    if input_pos >= end:
-        input_pos += length_change
+    if input_buffer.pos >= end:
+        input_buffer.pos += length_change
 
-    input_end += length_change
 
-
-def cpp_find_matching_pp_directive(
-    params: Params, pos: int, what: str = "else|elif|endif"
-) -> bool:
+def cpp_find_matching_pp_directive(params: Params, pos: int, what: str = "else|elif|endif") -> bool:
     """
     Find the position of the next directive at the same nesting level
     that is part of the same #if...#endif construct.
@@ -573,24 +969,44 @@ def cpp_find_matching_pp_directive(
     """
     params.trace("cppFindMatchingPPDirective", "pos = %d, what = %s", pos, what)
 
+    directives = input_buffer.pp_directives()
+    num_directives = len(directives.names)
+    first_index = index = bisect.bisect_left(directives.starts, pos)
+
     depth = 1
-    while cpp_search(r"^[ \t]*\#[ \t]*(\w+).*\n", pos):
-        pos = cpp_match_end[0]
-        pp_directive = cpp_match[1] or ""
+    while index < num_directives:
+        pos = directives.ends[index]
+        pp_directive = directives.names[index]
 
         if depth == 1:
             if re.match(f"^({what})$", pp_directive):
-                params.trace("cppFindMatchingPPDirective", "Found match '%s' at %d", pp_directive, pos)
+                set_pp_directive_match(directives, index)
+                params.trace(
+                    "cppFindMatchingPPDirective", "Found match '%s' at %d", pp_directive, pos
+                )
                 return True
             elif pp_directive == "endif":
+                set_pp_directive_match(directives, index)
                 params.trace("cppFindMatchingPPDirective", "No match")
                 return False
 
         if pp_directive.startswith("if"):  # match #if, #ifdef, #ifndef
+            endif = directives.endif.get(index)
+            if endif is not None:
+                # Skip the nested #if...#endif construct.
+                index = endif + 1
+                pos = directives.ends[endif]
+                continue
             depth += 1
         if pp_directive == "endif":
             depth -= 1
 
+        index += 1
+
+    clear_cpp_match()
+    if index > first_index:
+        input_buffer.pos = pos
+
     if depth != 1:
         fatal(f"Unmatched #if at position {pos}")
 
@@ -598,32 +1014,30 @@ def cpp_find_matching_pp_directive(
     return False
 
 
-def line_and_column(pos: int) -> Tuple[int, int]:
-    """Return the input line number and column number at the specified pos."""
-    fragment = input_text[:pos]
-
-    # Count newlines
-    line_num = fragment.count("\n") + 1
+def set_pp_directive_match(directives: PPDirectiveIndex, index: int) -> None:
+    """Set the cppSearch state to the directive at the specified index."""
+    set_cpp_match(
+        [directives.starts[index], directives.name_starts[index]],
+        [directives.ends[index], directives.name_ends[index]],
+    )
 
-    # Count characters after last newline
-    last_newline = fragment.rfind("\n")
-    col_num = pos - last_newline if last_newline >= 0 else pos + 1
 
-    return (line_num, col_num)
+def line_and_column(pos: int) -> Tuple[int, int]:
+    """Return the input line number and column number at the specified pos."""
+    return input_buffer.line_and_column(pos)
 
 
 def display_pos(pos: int) -> str:
     """Error-handling routine to print the line at the specified pos with a caret."""
-    if pos == input_end:
+    input_text = input_buffer.text
+    if pos == len(input_text):
         return "\n^\n"
 
-    line_num, col = line_and_column(pos)
-
     # Find the line containing pos
-    line_start = input_text.rfind("\n", 0, pos) + 1
+    line_start = input_buffer.line_start(pos)
     line_end = input_text.find("\n", pos)
     if line_end < 0:
-        line_end = input_end
+        line_end = len(input_text)
 
     line = input_text[line_start : line_end + 1]
     col_in_line = pos - line_start
@@ -667,6 +1081,45 @@ def find_matching_brace(brace: str, pos: int) -> int:
     Find the specified brace in input starting at pos, then return the
     position immediately after the matching end brace.
     """
+    table = input_buffer.brackets(brace == "<")
+    positions = table.positions
+    shrouded = input_buffer.shrouded
+
+    start_pos = pos
+    index = bisect.bisect_left(positions, pos)
+    while index < len(positions) and shrouded[positions[index]] == ">":
+        # Ignore unmatched '>'
+        pos = positions[index] + 1
+        input_buffer.pos = pos
+        index += 1
+
+    if index == len(positions):
+        clear_cpp_match()
+        return pos
+
+    brace_pos = positions[index]
+    found_brace = shrouded[brace_pos]
+    if found_brace in MATCHING_BRACKETS:
+        if found_brace != brace:
+            # Fail: No match.
+            set_cpp_match([brace_pos], [brace_pos + 1])
+            return start_pos
+
+        end = table.match[brace_pos]
+        if end >= 0:
+            set_cpp_match([end - 1], [end])
+            return end
+
+    # The brackets are mismatched; scan them to report the error.
+    return scan_matching_brace(brace, start_pos)
+
+
+def scan_matching_brace(brace: str, pos: int) -> int:
+    """
+    Find the specified brace in input starting at pos, then return the
+    position immediately after the matching end brace, scanning the input
+    rather than looking up the bracket table.
+    """
     start_pos = pos
 
     open_braces = "[({"
@@ -688,7 +1141,7 @@ def find_matching_brace(brace: str, pos: int) -> int:
 
         brace_pos = cpp_match_start[0]
         pos = cpp_match_end[0]
-        found_brace = input_text[brace_pos]
+        found_brace = input_buffer.text[brace_pos]
 
         matching_brace = MATCHING_BRACKETS.get(found_brace)
 
@@ -751,19 +1204,8 @@ PACK_TYPES = [
 ]
 PACK_TYPES_STR = "|".join(re.escape(t) for t in PACK_TYPES)
 
-# Generated parameter counter
-next_gen_param = 0
-
-
-def gen_name(prefix: str) -> str:
-    """Return a unique generated name using the supplied prefix argument."""
-    global next_gen_param
-    result = f"{prefix}{next_gen_param}"
-    next_gen_param += 1
-    return result
-
 
-def get_template_params(params: Params, pos: int) -> List[List[str]]:
+def get_template_params(params: Params, ctx: FileContext, pos: int) -> List[List[str]]:
     """
     Given an input string where the substring at pos starts with a template
     parameter list, return a list of [type, name, default] triples.
@@ -778,7 +1220,7 @@ def get_template_params(params: Params, pos: int) -> List[List[str]]:
         pack_type = cpp_match[2] or ""
         if cpp_match[3]:
             pack_type += cpp_match[3]
-        pack_name = cpp_match[4] or gen_name("__Param__")
+        pack_name = cpp_match[4] or ctx.gen_name("__Param__")
         pack_dflt = cpp_match[5] or ""
         packs.append([pack_type, pack_name, pack_dflt])
         pos = cpp_match_start[6]  # Include closing delimiter in next search
@@ -802,13 +1244,21 @@ def get_template_params(params: Params, pos: int) -> List[List[str]]:
 
 def noop_template_transform(
     params: Params,
+    ctx: FileContext,
     template_begin: int,
     template_head_end: int,
     template_end: int,
     is_variadic: bool = False,
 ) -> str:
     """Return the template substring with comments stripped."""
-    return strip_comments(input_text[template_begin:template_end])
+    return strip_comments(input_buffer.text[template_begin:template_end])
+
+
+# Pack expansion marker inserted by 'mark_pack_expansions'
+PACK_MARKER_RE = re.compile(r"__PACK_[VT][0-9]+[RF]__")
+
+# Newline and the indentation following it
+NEWLINE_INDENT_RE = re.compile(r"\n[ \t]*")
 
 
 def replace_and_fit_on_line(
@@ -818,17 +1268,12 @@ def replace_and_fit_on_line(
     Replaces [pack_start, pack_end) with replacement, re-indenting as necessary
     so that longest line in replacement fits within ``params.max_column``.
     """
-    global input_text, shrouded_input, input_end
-
     pack_end = pack_start + pack_len
 
     params.trace("replaceAndFitOnLine", "START workingBuffer = [%s]", working_buffer)
 
     # pre_pack is the text on same line preceding the current pack
-    pre_pack_match = re.search(
-        r"^(.*)(?=.{" + str(len(working_buffer) - pack_start) + r"}$)", working_buffer, re.DOTALL
-    )
-    if pre_pack_match:
+    if 0 <= pack_start <= len(working_buffer):
         # Find start of current line
         line_start = working_buffer.rfind("\n", 0, pack_start) + 1
         pre_pack = working_buffer[line_start:pack_start]
@@ -844,7 +1289,7 @@ def replace_and_fit_on_line(
         post_pack = working_buffer[pack_end:newline_pos]
 
     # Truncate post_pack at the start of the next pack, if any
-    pack_marker = re.search(r"__PACK_[VT][0-9]+[RF]__", post_pack)
+    pack_marker = PACK_MARKER_RE.search(post_pack)
     if pack_marker:
         post_pack = post_pack[: pack_marker.start()]
 
@@ -853,7 +1298,7 @@ def replace_and_fit_on_line(
     # Compute length of longest line of replacement
     last_replacement_width = 0
     max_replacement_width = 0
-    for line in re.split(r"\n[ \t]*", replacement):
+    for line in NEWLINE_INDENT_RE.split(replacement):
         last_replacement_width = len(line)
         max_replacement_width = max(max_replacement_width, last_replacement_width)
 
@@ -889,7 +1334,7 @@ def replace_and_fit_on_line(
             pack_start -= spaces_at_end_of_prepack
 
     # Insert indentation after every newline in replacement
-    replacement = re.sub(r"\n[ \t]*", "\n" + indentation, replacement)
+    replacement = NEWLINE_INDENT_RE.sub("\n" + indentation, replacement)
 
     if target_col + last_replacement_width + post_len > params.max_column:
         # post_pack will not fit on the same line as the last line
@@ -916,10 +1361,10 @@ def replace_and_fit_on_line(
 
     pack_len = pack_end - pack_start
 
-    if working_buffer is shrouded_input or id(working_buffer) == id(shrouded_input):
+    if working_buffer is input_buffer.shrouded:
         cpp_substitute(pack_start, pack_len, replacement)
-        params.trace("replaceAndFitOnLine", "RETURN SHROUDED = [%s]", shrouded_input)
-        return shrouded_input
+        params.trace("replaceAndFitOnLine", "RETURN SHROUDED = [%s]", input_buffer.shrouded)
+        return input_buffer.shrouded
     else:
         working_buffer = (
             working_buffer[:pack_start] + replacement + working_buffer[pack_start + pack_len :]
@@ -930,6 +1375,7 @@ def replace_and_fit_on_line(
 
 def replace_forwarding(
     params: Params,
+    ctx: FileContext,
     template_begin: int,
     template_head_end: int,
     template_end: int,
@@ -939,7 +1385,7 @@ def replace_forwarding(
     Replace uses of perfect forwarding within the specified input with
     special macros.
     """
-    buffer = strip_comments(input_text[template_begin:template_end])
+    buffer = strip_comments(input_buffer.text[template_begin:template_end])
 
     push_input(buffer)
     params.trace("replaceForwarding", "Stripped input = [%s]", buffer)
@@ -963,7 +1409,7 @@ def replace_forwarding(
 
             replace_and_fit_on_line(
                 params,
-                shrouded_input,
+                input_buffer.shrouded,
                 repl_start,
                 repl_end - repl_start,
                 f"BSLS_COMPILERFEATURES_FORWARD_REF({typename})" + argname,
@@ -979,27 +1425,25 @@ def replace_forwarding(
         while cpp_search(pattern, pos):
             replace_and_fit_on_line(
                 params,
-                shrouded_input,
+                input_buffer.shrouded,
                 cpp_match_start[0],
                 cpp_match_end[0] - cpp_match_start[0],
                 f"BSLS_COMPILERFEATURES_FORWARD({typename}, ",
             )
             pos = cpp_match_end[0]
 
-    params.trace("replaceForwarding", "Result = [%s]", input_text)
+    params.trace("replaceForwarding", "Result = [%s]", input_buffer.text)
 
     buffer = pop_input()
     return buffer
 
 
-def mark_pack_expansions(params: Params) -> List[str]:
+def mark_pack_expansions(params: Params, ctx: FileContext) -> List[str]:
     """
     Replace every parameter pack and pack expansion in input with markers.
     Return a list of pack expansion patterns.
     """
-    global input_text, shrouded_input
-
-    params.trace("markPackExpansions", "ORIGINAL = [%s]", input_text)
+    params.trace("markPackExpansions", "ORIGINAL = [%s]", input_buffer.text)
 
     type_names: Dict[str, bool] = {}
     pack_idents = []
@@ -1013,7 +1457,7 @@ def mark_pack_expansions(params: Params) -> List[str]:
 
         pack_type = cpp_match[2] or ""
         separator = cpp_match[4] or ""
-        param_pack_name = cpp_match[3] or gen_name("_Tp__")
+        param_pack_name = cpp_match[3] or ctx.gen_name("_Tp__")
 
         if re.search(r"(class|typename)", pack_type):
             pack_r = pack_r.replace("__PACK_V", "__PACK_T")
@@ -1024,9 +1468,8 @@ def mark_pack_expansions(params: Params) -> List[str]:
         pack_idents.append(param_pack_name)
         pack_expansions.append(f"{pack_type} {param_pack_name}")
 
-        input_text = (
-            input_text[: cpp_match_start[0]] + replacement + input_text[cpp_match_end[0] :]
-        )
+        input_text = input_buffer.text
+        input_text = input_text[: cpp_match_start[0]] + replacement + input_text[cpp_match_end[0] :]
 
         # Replace sizeof... (pack) with __PACKSIZE_#__
         pack_size = f"__PACKSIZE_{pack_num}__"
@@ -1060,9 +1503,8 @@ def mark_pack_expansions(params: Params) -> List[str]:
             pattern_text += " " + pack_ident
             pack_idents.append(pack_ident)
 
-        input_text = (
-            input_text[: cpp_match_start[0]] + replacement + input_text[cpp_match_end[0] :]
-        )
+        input_text = input_buffer.text
+        input_text = input_text[: cpp_match_start[0]] + replacement + input_text[cpp_match_end[0] :]
 
         # Scan backwards until pattern is fully-balanced
         while True:
@@ -1121,30 +1563,34 @@ def mark_pack_expansions(params: Params) -> List[str]:
         for ident in pack_idents:
             pack_expansions[i] = re.sub(rf"\b{ident}\b", f"{ident}_@", pack_expansions[i])
 
-    params.trace("markPackExpansion", "AFTER XFORM = [\n%s\n]", input_text)
+    params.trace("markPackExpansion", "AFTER XFORM = [\n%s\n]", input_buffer.text)
     params.trace("markPackExpansion", 'EXPANSIONS =\n    "%s', '"\n    "'.join(pack_expansions))
 
     return pack_expansions
 
 
 def repeat_packs(
-    params: Params, buffer: str, max_args_val: int, pack_expansions: List[str]
+    params: Params, ctx: FileContext, buffer: str, max_args_val: int, pack_expansions: List[str]
 ) -> str:
     """
     Create multiple copies of buffer, replacing each __PACK_V#R__ or __PACK_T#R__
     pattern with an expansion of the parameter packs.
     """
     applied_pack_expansions = []
-    output = ""
+    output = []
 
     # If max_args_val is 2 digits, pad counts
     digit_pad = "0" if max_args_val > 9 else ""
     space_pad = " " if max_args_val > 9 else ""
 
-    for rep_count in range(max_args_val + 1):
+    # In compact mode, only the empty expansion is copied
+    compact = ctx.compact and can_compact_packs(buffer, max_args_val, pack_expansions)
+    last_copy = 0 if compact else max_args_val
+
+    for rep_count in range(last_copy + 1):
         working_buffer = buffer
 
-        working_buffer = f"#if {variadic_limit} >= {rep_count}\n" + working_buffer
+        working_buffer = f"#if {ctx.variadic_limit} >= {rep_count}\n" + working_buffer
 
         rep_string = ("" if rep_count > 9 else space_pad) + str(rep_count)
         rep_id_string = ("" if rep_count > 9 else digit_pad) + str(rep_count)
@@ -1153,7 +1599,7 @@ def repeat_packs(
         working_buffer = re.sub(r"__PACKSIZE_[0-9]+__", f"{rep_string}u", working_buffer)
 
         for expand_num in range(len(pack_expansions)):
-            match = re.search(rf"__PACK_([VT]){expand_num}([RF])__(.*)", working_buffer, re.DOTALL)
+            match = re.search(rf"__PACK_([VT]){expand_num}([RF])__", working_buffer)
             if not match:
                 fatal(f"Can't find pack {expand_num} in working buffer")
                 return ""  # Unreachable, but helps mypy
@@ -1163,7 +1609,7 @@ def repeat_packs(
             pack_start = match.start(1) - 7
             pack_type = match.group(1) or ""  # 'T' for type, 'V' for value
             is_fill = (match.group(2) or "") == "F"
-            pack_end = match.start(3)  # Position of trailing content
+            pack_end = match.end()  # Position of trailing content
             pack_len = pack_end - pack_start
 
             fill_count_str = ("" if (max_args_val - rep_count) > 9 else space_pad) + str(
@@ -1221,29 +1667,124 @@ def repeat_packs(
                 params, working_buffer, pack_start, pack_len, replacement
             )
 
-        working_buffer += f"#endif  // {variadic_limit} >= {rep_count}\n"
-        output += working_buffer + "\n"
+        working_buffer += f"#endif  // {ctx.variadic_limit} >= {rep_count}\n"
+        output.append(working_buffer + "\n")
+
+    if compact:
+        output.append(compact_repeat_packs(params, ctx, buffer, max_args_val, pack_expansions))
+
+    return "".join(output)
+
+
+# Parameter of the macros generated by 'compact_repeat_packs'
+COMPACT_PARAM = "BSLS_SIM_N"
+
+# Shared iteration macros: BSLS_COMPILERFEATURES_SIMULATE_REPEAT_<n>(M)
+# expands to 'M(1), M(2), ..., M(n)', and
+# BSLS_COMPILERFEATURES_SIMULATE_REPEAT_PADDED_<n>(M) to 'M(01), M(02), ...',
+# generating the same names as the copies of 'repeat_packs' when the limit has
+# two digits.
+COMPACT_REPEAT = "BSLS_COMPILERFEATURES_SIMULATE_REPEAT_"
+COMPACT_REPEAT_PADDED = "BSLS_COMPILERFEATURES_SIMULATE_REPEAT_PADDED_"
 
-    return output
+
+def can_compact_packs(buffer: str, max_args_val: int, pack_expansions: List[str]) -> bool:
+    """Return ``True`` if the repetitions of the specified buffer can be
+    generated by 'compact_repeat_packs', i.e., if the buffer can be the body
+    of a macro and every repetition expands its packs in full."""
+    if max_args_val < 1 or re.search(r"__PACK_[VT][0-9]+F__", buffer):
+        # Fill markers depend on the number of remaining arguments, which
+        # the preprocessor cannot compute.
+        return False
+    if re.search(r"^[ \t]*#", buffer, re.MULTILINE):
+        return False
+    for match in COMMENT_AND_STRING_RE.finditer(buffer):
+        if match.group(1) or match.group(2):
+            return False
+    for text in [buffer] + pack_expansions:
+        if COMPACT_PARAM in text:
+            return False
+    return not any("__PACK_" in pattern for pattern in pack_expansions)
+
+
+def compact_repeat_packs(
+    params: Params, ctx: FileContext, buffer: str, max_args_val: int, pack_expansions: List[str]
+) -> str:
+    """
+    Return the repetitions 1 to max_args_val of buffer as invocations of a
+    macro defined by buffer, each __PACK_V#R__ or __PACK_T#R__ pattern being
+    expanded by an iteration macro.  The output is linear in max_args_val,
+    while the copies of 'repeat_packs' are quadratic.
+    """
+    name = f"{ctx.variadic_limit}_{ctx.next_compact_macro}"
+    ctx.next_compact_macro += 1
+    n = COMPACT_PARAM
+    output = []
+
+    # Same padding of the repetition numbers as 'repeat_packs'
+    digit_pad = "0" if max_args_val > 9 else ""
+    repeat = COMPACT_REPEAT_PADDED if digit_pad else COMPACT_REPEAT
+
+    if ctx.compact_repeat_limit.get(repeat, 0) < max_args_val:
+        # Macros defined identically by every generated file.  They are flat
+        # rather than recursive: expanding a chain of nested macros costs the
+        # compiler more than the repeated text saves.
+        output.append(f"#ifndef {repeat}{max_args_val}\n")
+        for i in range(1, max_args_val + 1):
+            repeats = ", ".join(f"M({'' if j > 9 else digit_pad}{j})" for j in range(1, i + 1))
+            output.append(f"#define {repeat}{i}(M) {repeats}\n")
+        output.append(f"#endif\n")
+        ctx.compact_repeat_limit[repeat] = max_args_val
+
+    macros = []
+    for expand_num, pattern in enumerate(pack_expansions):
+        pattern_macro = f"{name}_P{expand_num}"
+        pattern = re.sub(r"\s*\n\s*", " ", pattern).replace("@", "##" + n)
+        output.append(f"#define {pattern_macro}({n}) {pattern}\n")
+        macros.append(pattern_macro)
+
+    body = re.sub(r"__PACKSIZE_[0-9]+__", f"{n}##u", buffer)
+    body = re.sub(
+        r"__PACK_[VT]([0-9]+)R__",
+        lambda match: f"{repeat}##{n}({name}_P{match.group(1)})",
+        body,
+    )
+
+    output.append(f"#define {name}({n})".ljust(params.max_column - 2) + " \\\n")
+    lines = body.rstrip("\n").split("\n")
+    for line in lines[:-1]:
+        output.append(line.rstrip().ljust(params.max_column - 2) + " \\\n")
+    output.append(lines[-1] + "\n")
+    macros.append(name)
+
+    for rep_count in range(1, max_args_val + 1):
+        output.append(f"#if {ctx.variadic_limit} >= {rep_count}\n")
+        output.append(f"{name}({rep_count})\n")
+        output.append(f"#endif  // {ctx.variadic_limit} >= {rep_count}\n")
+
+    for macro in macros:
+        output.append(f"#undef {macro}\n")
+
+    params.trace("compactRepeatPacks", "OUTPUT = [%s]", "".join(output))
+    return "".join(output) + "\n"
 
 
 def transform_variadic_function(
     params: Params,
+    ctx: FileContext,
     template_begin: int,
     template_head_end: int,
     template_end: int,
     is_variadic: bool = False,
 ) -> str:
     """Transform a variadic function template."""
-    global input_text
-
-    buffer = strip_comments(input_text[template_begin:template_end])
+    buffer = strip_comments(input_buffer.text[template_begin:template_end])
 
     if not is_variadic:
         return buffer
 
     push_input(buffer)
-    pack_expansions = mark_pack_expansions(params)
+    pack_expansions = mark_pack_expansions(params, ctx)
 
     # Look for out-of-line definitions of member functions or static member
     # variables of variadic classes
@@ -1251,18 +1792,13 @@ def transform_variadic_function(
     pattern = r"template\s*<[^{;]+__PACK_[TV][0-9]+(R)__\s*>\s*::"
     while cpp_search(pattern, pos):
         # Change R to F
-        start = cpp_match_start[1]
-        input_text_list = list(input_text)
-        input_text_list[start] = "F"
-        input_text = "".join(input_text_list)
-        set_input(input_text)
+        cpp_substitute(cpp_match_start[1], 1, "F")
         pos = cpp_match_end[0]
 
-    buffer = input_text
-    pop_input()
+    buffer = pop_input()
 
     # Expand parameter packs
-    buffer = repeat_packs(params, buffer, max_args, pack_expansions)
+    buffer = repeat_packs(params, ctx, buffer, ctx.max_args, pack_expansions)
 
     # Remove empty "template <>" prefixes
     buffer = re.sub(r"\btemplate\s*<\s*>\s*", "", buffer)
@@ -1272,6 +1808,7 @@ def transform_variadic_function(
 
 def transform_variadic_class(
     params: Params,
+    ctx: FileContext,
     template_begin: int,
     template_head_end: int,
     template_end: int,
@@ -1279,13 +1816,13 @@ def transform_variadic_class(
 ) -> str:
     """Transform a variadic class template."""
     if not is_variadic:
-        return noop_template_transform(params, template_begin, template_head_end, template_end)
+        return noop_template_transform(params, ctx, template_begin, template_head_end, template_end)
 
     params.trace(
-        "transformVariadicClass", "TEMPLATE = [%s]", input_text[template_begin:template_end]
+        "transformVariadicClass", "TEMPLATE = [%s]", input_buffer.text[template_begin:template_end]
     )
 
-    template_params = get_template_params(params, template_begin)
+    template_params = get_template_params(params, ctx, template_begin)
 
     cpp_search(r"\G\s*(class|struct|union)\s*([A-Za-z_]\w*)\b(.)?", template_head_end)
     class_or_struct = cpp_match[1]
@@ -1296,7 +1833,7 @@ def transform_variadic_class(
 
     if is_specialization:
         class_hdr_end = find_matching_brace("<", cpp_match_start[3]) + 1
-        buffer = input_text[template_begin:class_hdr_end]
+        buffer = input_buffer.text[template_begin:class_hdr_end]
     else:
         # Modify class declaration to look like a template specialization
         buffer = "template <"
@@ -1315,7 +1852,7 @@ def transform_variadic_class(
             sep = ", "
         buffer += ">"
 
-        buffer += input_text[template_head_end:class_hdr_end]
+        buffer += input_buffer.text[template_head_end:class_hdr_end]
 
         # Put all of the parameters as if they were specialized
         sep = "<"
@@ -1329,19 +1866,19 @@ def transform_variadic_class(
 
     params.trace2("transformVariadicClass", "specialization buffer=[%s]", buffer)
 
-    buffer += transform_forwarding(params, input_text[class_hdr_end:template_end])
+    buffer += transform_forwarding(params, ctx, input_buffer.text[class_hdr_end:template_end])
 
     push_input(buffer)
-    pack_expansions = mark_pack_expansions(params)
-    buffer = input_text
+    pack_expansions = mark_pack_expansions(params, ctx)
+    buffer = input_buffer.text
     pop_input()
 
     output = ""
 
     # Generate forward-reference for the primary template
     class_name_key = class_name or ""
-    if not is_specialization and class_name_key not in class_template_forward_declared:
-        class_template_forward_declared[class_name_key] = True
+    if not is_specialization and class_name_key not in ctx.class_template_forward_declared:
+        ctx.class_template_forward_declared[class_name_key] = True
         output += "template <"
         indent = "          "
         indent_comma = "        , "
@@ -1355,13 +1892,13 @@ def transform_variadic_class(
                     if re.search(r"(class|struct|union)", param_type)
                     else "BSLS_COMPILERFEATURES_NILV"
                 )
-                for i in range(max_args):
-                    output += f"\n#if {variadic_limit} >= {i}\n"
+                for i in range(ctx.max_args):
+                    output += f"\n#if {ctx.variadic_limit} >= {i}\n"
                     sep = re.sub(r"^,\n *$", indent_comma, sep)
                     output += sep
                     sep = indent_comma
                     output += f"{param_type} {param_name}_{i} = {param_nil}"
-                    output += f"\n#endif  // {variadic_limit} >= {i}\n"
+                    output += f"\n#endif  // {ctx.variadic_limit} >= {i}\n"
                 output += sep + f"{param_type} = {param_nil}"
             else:
                 output += sep
@@ -1370,13 +1907,15 @@ def transform_variadic_class(
         output += f">\n{class_or_struct} {class_name};\n\n"
 
     if not is_forward_decl:
-        output += repeat_packs(params, buffer, max_args, pack_expansions)
+        output += repeat_packs(params, ctx, buffer, ctx.max_args, pack_expansions)
 
     params.trace("transformVariadicClass", "OUTPUT = [%s]", output)
     return output
 
 
-def transform_templates(params: Params, buffer: str, transform_function, transform_class) -> str:
+def transform_templates(
+    params: Params, ctx: FileContext, buffer: str, transform_function, transform_class
+) -> str:
     """
     Transforms the specified buffer, calling the specified transform functions
     on each template found.
@@ -1384,20 +1923,20 @@ def transform_templates(params: Params, buffer: str, transform_function, transfo
     params.trace("transformTemplates", "buffer = [%s]", buffer)
 
     # Line and column at start of this segment
-    line_num, _ = line_and_column(input_pos)
+    line_num, _ = line_and_column(input_buffer.pos)
 
     push_input(buffer)
-    output = ""
+    output = []
 
     pos = 0
-    while pos < input_end:
+    while pos < input_buffer.end:
         # Find start of a template
         if not cpp_search(r"[ \t]*\btemplate\s*<", pos):
             break
         template_begin = cpp_match_start[0]
 
         # Copy everything before the template to output
-        output += strip_comments(input_text[pos:template_begin])
+        output.append(strip_comments(input_buffer.text[pos:template_begin]))
 
         # Find end of template parameter list
         pos = find_matching_brace("<", template_begin)
@@ -1438,31 +1977,38 @@ def transform_templates(params: Params, buffer: str, transform_function, transfo
         )
 
         if is_class:
-            output += transform_class(
-                params, template_begin, template_head_end, template_end, is_variadic
+            output.append(
+                transform_class(
+                    params, ctx, template_begin, template_head_end, template_end, is_variadic
+                )
             )
         else:
-            output += transform_function(
-                params, template_begin, template_head_end, template_end, is_variadic
+            output.append(
+                transform_function(
+                    params, ctx, template_begin, template_head_end, template_end, is_variadic
+                )
             )
 
         pos = template_end
 
-    output += strip_comments(input_text[pos:])
+    output.append(strip_comments(input_buffer.text[pos:]))
 
     pop_input()
-    params.trace("transformTemplates", "output = [%s]", output)
-    return output
+    result = "".join(output)
+    params.trace("transformTemplates", "output = [%s]", result)
+    return result
 
 
-def transform_forwarding(params: Params, buffer: str) -> str:
+def transform_forwarding(params: Params, ctx: FileContext, buffer: str) -> str:
     """Transform all uses of perfect forwarding in top-level function templates."""
-    return transform_templates(params, buffer, replace_forwarding, noop_template_transform)
+    return transform_templates(params, ctx, buffer, replace_forwarding, noop_template_transform)
 
 
-def transform_variadics(params: Params, buffer: str) -> str:
+def transform_variadics(params: Params, ctx: FileContext, buffer: str) -> str:
     """Transform all top-level variadic templates into C++03-compatible code."""
-    return transform_templates(params, buffer, transform_variadic_function, transform_variadic_class)
+    return transform_templates(
+        params, ctx, buffer, transform_variadic_function, transform_variadic_class
+    )
 
 
 # ============================================================================
@@ -1472,12 +2018,12 @@ def transform_variadics(params: Params, buffer: str) -> str:
 SIM_CPP11_MACRO = "BSLS_COMPILERFEATURES_SIMULATE_CPP11_FEATURES"
 
 
-def get_args_from_pp_line(params: Params, pp_line: str) -> Tuple[int, str]:
+def get_args_from_pp_line(params: Params, ctx: FileContext, pp_line: str) -> Tuple[int, str]:
     """
     Extract script arguments from a preprocessor directive.
-    Returns (local_max_args, args_comment).
+    Returns (local_max_args, args_comment).  Also sets the maximum number of
+    arguments and the compact mode of the context.
     """
-    global max_args, file_max_args
 
     new_max_args = 0
     local_max_args = 0
@@ -1497,10 +2043,16 @@ def get_args_from_pp_line(params: Params, pp_line: str) -> Tuple[int, str]:
         args_comment += f" $local-var-args={local_max_args}"
 
     # params.max_args_opt overrides new_max_args if both are specified
-    max_args = params.max_args_opt or new_max_args or max_args
-    if new_max_args or max_args != file_max_args:
-        args_comment += f" $var-args={max_args}"
-        file_max_args = max_args
+    ctx.max_args = params.max_args_opt or new_max_args or ctx.max_args
+    if new_max_args or ctx.max_args != ctx.file_max_args:
+        args_comment += f" $var-args={ctx.max_args}"
+        ctx.file_max_args = ctx.max_args
+
+    # Look for // $compact; params.compact adds it
+    ctx.compact = params.compact or bool(re.search(r"/[/*].*\$compact\b", pp_line))
+    if ctx.compact:
+        args_comment += " $compact"
+
     if args_comment:
         args_comment = " //" + args_comment
 
@@ -1566,13 +2118,14 @@ def find_cpp03_region_markers(params: Params) -> Tuple[int, ...]:
     return (if_start, include_start, else_end, endif_start, endif_end)
 
 
-def transform_file(params: Params, command_line: str, initial_data: str, gen_master: bool) -> str:
+def transform_file(
+    params: Params, ctx: FileContext, command_line: str, initial_data: str, gen_master: bool
+) -> str:
     """Transform the initial_data from annotated C++11 into C++03.
 
     ``command_line`` is the minimized command line recorded in generated
     output ("// Command line: ...").
     """
-    global variadic_limit, max_args, file_max_args
 
     gen_expansion = params.inplace or not gen_master
     set_input(initial_data)
@@ -1580,7 +2133,7 @@ def transform_file(params: Params, command_line: str, initial_data: str, gen_mas
     params.trace(
         "transformFile",
         "Inputlen = %d, masterGen = %d, expansionGen = %d",
-        input_end,
+        input_buffer.end,
         gen_master,
         gen_expansion,
     )
@@ -1593,7 +2146,7 @@ def transform_file(params: Params, command_line: str, initial_data: str, gen_mas
 
     generated_code_end = "// }}} END GENERATED CODE"
 
-    output = ""
+    output = []
     pos = 0
 
     sim_variadics_macro = "BSLS_COMPILERFEATURES_SIMULATE_VARIADIC_TEMPLATES"
@@ -1612,16 +2165,17 @@ def transform_file(params: Params, command_line: str, initial_data: str, gen_mas
         if if_type != "ifndef":
             continue
 
-        variadic_limit = variadic_limit_base + "_" + chr(ord("A") + region_count)
+        ctx.variadic_limit = ctx.variadic_limit_base + "_" + chr(ord("A") + region_count)
+        ctx.compact_repeat_limit = {}
         region_count += 1
 
         # Output code before the #if
         end_verbatim = cpp_match_start[0]
-        output += input_text[start_verbatim:end_verbatim]
+        output.append(input_buffer.text[start_verbatim:end_verbatim])
 
         start_cpp11_segment = pos
 
-        local_max_args, args_comment = get_args_from_pp_line(params, cpp_match[0] or "")
+        local_max_args, args_comment = get_args_from_pp_line(params, ctx, cpp_match[0] or "")
 
         # Find matching #else, #elif, or #endif
         if not cpp_find_matching_pp_directive(params, pos):
@@ -1638,85 +2192,85 @@ def transform_file(params: Params, command_line: str, initial_data: str, gen_mas
 
         start_verbatim = pos
 
-        cpp11_segment = input_text[start_cpp11_segment:end_cpp11_segment]
+        cpp11_segment = input_buffer.text[start_cpp11_segment:end_cpp11_segment]
 
         within_if = False
         if gen_master:
-            output += f"#if !{SIM_CPP11_MACRO}{args_comment}\n"
+            output.append(f"#if !{SIM_CPP11_MACRO}{args_comment}\n")
             within_if = True
-            output += cpp11_segment
+            output.append(cpp11_segment)
 
         if params.clean:
-            output += "#else\n"
-            output += generated_code_begin + "\n"
-            output += "#   error sim_cpp11_features.pl has not been run\n"
-            output += generated_code_end + "\n"
-            output += "#endif\n"
+            output.append("#else\n")
+            output.append(generated_code_begin + "\n")
+            output.append("#   error sim_cpp11_features.pl has not been run\n")
+            output.append(generated_code_end + "\n")
+            output.append("#endif\n")
             within_if = False
         elif gen_expansion:
             # Temporarily change max_args
-            saved_max_args = max_args
-            max_args = local_max_args or max_args
+            saved_max_args = ctx.max_args
+            ctx.max_args = local_max_args or ctx.max_args
 
             # Apply the forwarding workaround
-            forwarding_workaround = transform_forwarding(params, cpp11_segment)
+            forwarding_workaround = transform_forwarding(params, ctx, cpp11_segment)
             # Chomp (remove single trailing newline, like Perl's chomp)
             if forwarding_workaround.endswith("\n"):
                 forwarding_workaround = forwarding_workaround[:-1]
 
             # Apply the variadic template simulation
-            variadic_simulation = transform_variadics(params, forwarding_workaround)
+            variadic_simulation = transform_variadics(params, ctx, forwarding_workaround)
             # Chomp (remove single trailing newline)
             if variadic_simulation.endswith("\n"):
                 variadic_simulation = variadic_simulation[:-1]
 
             # Restore max_args
-            max_args = file_max_args
+            ctx.max_args = ctx.file_max_args
 
             # Generate output - check if variadic simulation differs from forwarding
             gen_variadics = variadic_simulation != forwarding_workaround
 
             if gen_variadics:
-                output += "#elif" if within_if else "#if"
-                output += f" {sim_variadics_macro}\n"
+                output.append("#elif" if within_if else "#if")
+                output.append(f" {sim_variadics_macro}\n")
                 within_if = True
 
-                output += f"""{generated_code_begin}
+                output.append(f"""{generated_code_begin}
 // Command line: {command_line}
-#ifndef {variadic_limit_base}
-#define {variadic_limit_base} {saved_max_args}
+#ifndef {ctx.variadic_limit_base}
+#define {ctx.variadic_limit_base} {saved_max_args}
 #endif
-#ifndef {variadic_limit}
-#define {variadic_limit} {variadic_limit_base}
+#ifndef {ctx.variadic_limit}
+#define {ctx.variadic_limit} {ctx.variadic_limit_base}
 #endif
-"""
-                output += variadic_simulation + "\n"
-                output += f"""#else
+""")
+                output.append(variadic_simulation + "\n")
+                output.append(f"""#else
 // The generated code below is a workaround for the absence of perfect
 // forwarding in some compilers.
 {forwarding_workaround}
 {generated_code_end}
-"""
+""")
             else:
                 if within_if:
-                    output += "#else\n"
-                output += f"""{generated_code_begin}
+                    output.append("#else\n")
+                output.append(f"""{generated_code_begin}
 // The generated code below is a workaround for the absence of perfect
 // forwarding in some compilers.
 {forwarding_workaround}
 {generated_code_end}
-"""
+""")
 
         if within_if:
-            output += "#endif\n"
+            output.append("#endif\n")
 
     # If there were no expansion regions found, return empty string
     if region_count == 0:
         return ""
 
     # Output remaining part of output file
-    output += input_text[start_verbatim:input_end]
-    return output
+    output.append(input_buffer.text[start_verbatim:])
+    return "".join(output)
 
 
 # ============================================================================
@@ -1888,7 +2442,7 @@ def get_master_suffix(subs: Dict[str, str]) -> str:
 
 
 def filename_to_boilerplate(
-    params: Params, command_line: str, output_filename: str
+    params: Params, ctx: FileContext, command_line: str, output_filename: str
 ) -> Tuple[str, str]:
     """
     Given a filename, return the prefix and suffix boilerplate text
@@ -1923,8 +2477,8 @@ def filename_to_boilerplate(
         "COMPONENT": component.upper(),
         "commandLine": command_line,
         "timestampComment": params.timestamp_comment,
-        "bottomCopyright": bottom_copyright,
-        "topCopyright": top_copyright,
+        "bottomCopyright": ctx.bottom_copyright,
+        "topCopyright": ctx.top_copyright,
     }
 
     # Determine which boilerplate to use based on filename pattern
@@ -1987,10 +2541,10 @@ def segment_filedata(params: Params, file_data: str) -> Tuple[str, str, str, boo
                     last_include = cpp_match_end[0] + 1
 
         if_start = else_end = last_include
-        endif_start = endif_end = input_end
+        endif_start = endif_end = input_buffer.end
 
         # Find first non-whitespace, non-comment character after #include
-        first_real_code = input_end
+        first_real_code = input_buffer.end
         if cpp_search(r"\S", last_include):
             first_real_code = cpp_match_start[0]
 
@@ -2006,11 +2560,11 @@ def segment_filedata(params: Params, file_data: str) -> Tuple[str, str, str, boo
                 if cpp_find_matching_pp_directive(params, else_end, "endif"):
                     endif_start = endif_end = cpp_match_start[0]
 
-        if endif_start == input_end:
+        if endif_start == input_buffer.end:
             # Move insertion position to be before closing comments/whitespace
             # Use \Z (end-of-string) instead of $ because cpp_search uses
             # re.MULTILINE where $ matches at any line boundary.
-            start_search = max(0, input_end - 1000)
+            start_search = max(0, input_buffer.end - 1000)
             if cpp_search(r"\n\s*\Z", start_search):
                 endif_start = endif_end = cpp_match_start[0] + 1
 
@@ -2060,7 +2614,9 @@ def write_output(
     params.trace("writeOutput", "Writing %d to %s", len(output), output_filename)
 
     if params.verify_no_change:
-        fatal(f"--verify-no-change error: Would modify {output_filename}.  To fix, run\n   {params.get_command_line(output_filename, use_basename=False)}\nand commit the result.")
+        fatal(
+            f"--verify-no-change error: Would modify {output_filename}.  To fix, run\n   {params.get_command_line(output_filename, use_basename=False)}\nand commit the result."
+        )
 
     if output_filename == "-":
         print(output, end="")
@@ -2105,8 +2661,9 @@ def write_master(
     output_filename: str,
     original_file_data: str,
     output: str,
-) -> None:
-    """Write the master output file."""
+) -> str:
+    """Write the master output file.  Return the (new or unchanged) contents
+    of the master file."""
     params.trace("writeMaster", "outputName = %s, outputLen = %d", output_filename, len(output))
 
     if (
@@ -2123,24 +2680,28 @@ def write_master(
 
             # Dump test diff
             os.system(f"diff -c TEST {output_filename}")
-    else:
-        params.trace("writeMaster", "Master is unchanged. No file written.")
 
+        return output
+
+    params.trace("writeMaster", "Master is unchanged. No file written.")
+    return original_file_data
 
-def write_expansion(params: Params, output_filename: str, output: str) -> None:
-    """Write the expansion output file."""
+
+def write_expansion(params: Params, output_filename: str, output: str) -> str:
+    """Write the expansion output file.  Return the (new or unchanged)
+    contents of the expansion file."""
     params.trace("writeExpansion", "outputName = %s, outputLen = %d", output_filename, len(output))
 
     if os.path.exists(output_filename):
         # Use universal newlines so CRLF on disk normalizes to LF, matching
         # the in-memory output (which stripped \r from input).
         with open(output_filename, "r", encoding="latin-1") as f:
-            original_file_data = f.read()
+            existing_data = f.read()
 
         # Normalize volatile metadata so that trivial differences
         # (timestamp, .pl -> .py rename, copyright year) don't trigger
         # a rewrite.
-        original_file_data = _normalize_for_compare(params, original_file_data)
+        original_file_data = _normalize_for_compare(params, existing_data)
         normalized_output = _normalize_for_compare(params, output)
 
         # Replace old copyright with new
@@ -2158,12 +2719,157 @@ def write_expansion(params: Params, output_filename: str, output: str) -> None:
         # Don't modify output file if it's identical to previous version
         if normalized_output == original_file_data:
             params.trace("writeExpansion", "Generated file is unchanged. No file written.")
-            return
-        else:
-            params.trace("writeExpansion", "Generated file is changed. File written.")
+            return existing_data
+
+        params.trace("writeExpansion", "Generated file is changed. File written.")
 
     # Create read-only file with generated output
     write_output(params, output, output_filename, 0o444)
+    return output
+
+
+# ============================================================================
+#                        CONTENT HASHES AND CACHE
+# ============================================================================
+
+# Version of the generated code.  Increment whenever a change of this script
+# changes its output, so that the digests recorded by earlier versions no
+# longer match and cached outputs are not reused.
+TOOL_VERSION = "1"
+
+# The cache directory holds, besides the cached outputs, a stamp per C++03
+# file recording the digest of the inputs it was last generated (or found up
+# to date) from and the digest of its contents.  The generated files
+# themselves carry no digest, so that they change only when their code does.
+STAMP_PREFIX = "stamp-"
+
+
+def _digest(*parts: str) -> str:
+    """Return the hexadecimal digest of the specified strings."""
+    h = hashlib.blake2b(digest_size=12)
+    for part in parts:
+        h.update(part.encode("utf-8", "surrogateescape"))
+        h.update(b"\0")
+    return h.hexdigest()
+
+
+def _strip_timestamps(params: Params, text: str) -> str:
+    """Return the specified text without the volatile part of timestamps."""
+    return re.sub(
+        rf"{re.escape(params.timestamp_prefix)}.*$",
+        params.timestamp_prefix,
+        text,
+        flags=re.MULTILINE,
+    )
+
+
+def input_digest(params: Params, command_line: str, output_filename: str, master: str) -> str:
+    """Return the digest of everything the generated code depends on: the
+    specified contents of the master file, the command line, the output
+    filename and the version of this script."""
+    return _digest(
+        TOOL_VERSION,
+        command_line,
+        str(params.max_args_opt),
+        str(params.compact),
+        os.path.basename(output_filename),
+        _strip_timestamps(params, master),
+    )
+
+
+def output_digest(params: Params, expansion: str) -> str:
+    """Return the digest of the specified C++03 file contents."""
+    return _digest(_strip_timestamps(params, expansion))
+
+
+def _stamp_filename(params: Params, expansion_filename: str) -> str:
+    """Return the name of the stamp of the specified C++03 file."""
+    key = _digest(os.path.abspath(expansion_filename))
+    return os.path.join(params.cache_dir, STAMP_PREFIX + key + ".json")
+
+
+def expansion_is_current(params: Params, expansion_filename: str, in_digest: str) -> bool:
+    """Return ``True`` if the stamp of the specified C++03 file shows that it
+    was generated from inputs having the specified digest and was not
+    modified since.  Return ``False`` if there is no cache."""
+    if not params.cache_dir:
+        return False
+
+    try:
+        with open(_stamp_filename(params, expansion_filename), "r", encoding="utf-8") as f:
+            stamp = json.load(f)
+        with open(expansion_filename, "r", encoding="latin-1") as f:
+            expansion = f.read()
+        return stamp["input"] == in_digest and stamp["output"] == output_digest(params, expansion)
+    except (OSError, ValueError, KeyError, TypeError):
+        return False
+
+
+def _write_cache_file(params: Params, name: str, entry: Dict[str, Optional[str]]) -> None:
+    """Write the specified entry to the specified file of the cache.  Failing
+    to write the cache is not an error."""
+    try:
+        os.makedirs(params.cache_dir, exist_ok=True)
+
+        # Write to a temporary file and rename it, as concurrent runs may
+        # store the same entry.
+        fd, temp_name = tempfile.mkstemp(dir=params.cache_dir, suffix=".tmp")
+        try:
+            with os.fdopen(fd, "w", encoding="utf-8") as f:
+                json.dump(entry, f)
+            os.replace(temp_name, os.path.join(params.cache_dir, name))
+        except BaseException:
+            os.remove(temp_name)
+            raise
+    except OSError as e:
+        params.trace("cache", "Cannot write cache entry %s: %s", name, e.strerror)
+
+
+def stamp_store(params: Params, expansion_filename: str, in_digest: str, expansion: str) -> None:
+    """Record that the specified C++03 file, having the specified contents,
+    is up to date with the inputs having the specified digest."""
+    if not params.cache_dir:
+        return
+
+    entry = {"input": in_digest, "output": output_digest(params, expansion)}
+    _write_cache_file(params, os.path.basename(_stamp_filename(params, expansion_filename)), entry)
+
+
+def cache_load(params: Params, in_digest: str) -> Tuple[Optional[str], Optional[str]]:
+    """Return the master and C++03 outputs cached for the inputs having the
+    specified digest (the C++03 output being ``None`` in ``--inplace`` mode),
+    or ``(None, None)`` if they are not cached."""
+    if not params.cache_dir:
+        return None, None
+
+    try:
+        with open(os.path.join(params.cache_dir, in_digest + ".json"), "r", encoding="utf-8") as f:
+            entry = json.load(f)
+        timestamp = entry["timestamp"]
+        master = entry["master"].replace(timestamp, params.timestamp_comment)
+        expansion = entry["expansion"]
+        if expansion is not None:
+            expansion = expansion.replace(timestamp, params.timestamp_comment)
+    except (OSError, ValueError, KeyError, TypeError, AttributeError):
+        return None, None
+
+    params.trace("cache", "Using cached output %s", in_digest)
+    return master, expansion
+
+
+def cache_store(params: Params, in_digest: str, master: str, expansion: Optional[str]) -> None:
+    """Cache the specified master and C++03 outputs for the inputs having the
+    specified digest.  Failing to write the cache is not an error."""
+    if not params.cache_dir:
+        return
+
+    entry = {"timestamp": params.timestamp_comment, "master": master, "expansion": expansion}
+    _write_cache_file(params, in_digest + ".json", entry)
+
+
+def get_expansion_filename(output_filename: str) -> str:
+    """Return the name of the C++03 file of the specified master file."""
+    return re.sub(r"([^.])(\.[^/\\]*)?$", r"\1_cpp03\2", output_filename)
 
 
 def process_file(
@@ -2174,21 +2880,10 @@ def process_file(
     ``command_line`` is the minimized command line to embed in generated
     output.
     """
-    global file_max_args, max_args, variadic_limit_base
-    global class_template_forward_declared, next_gen_param
-
     params.trace("processFile", "Inputfile = %s, Outputfile = %s", input_filename, output_filename)
 
-    # Reset important globals
-
-    file_max_args = params.default_max_args
-    max_args = params.max_args_opt or file_max_args
-    class_template_forward_declared = {}
-    next_gen_param = 0
-
-    variadic_limit_base = os.path.basename(input_filename)
-    variadic_limit_base = re.sub(r"\..*", "", variadic_limit_base)
-    variadic_limit_base = variadic_limit_base.upper() + "_VARIADIC_LIMIT"
+    ctx = FileContext(params, input_filename)
+    reset_input()
 
     if params.self_test:
         # Read from embedded test data
@@ -2204,90 +2899,621 @@ def process_file(
         rf"{params.timestamp_prefix}.*$", params.timestamp_comment, file_data, flags=re.MULTILINE
     )
 
-    # Check for copyright block
-    global bottom_copyright, top_copyright
-    bottom_copyright = ""
-    top_copyright = ""
-
-    bottom_match = re.search(
-        r"""(\n?
-             //[ ]--+\n
-             //[ ]Copyright[ ]\d+[ ]Bloomberg.*\n
-             (?://[ ].*\n|//\n)+
-             //[ ]-+[ ]END-OF-FILE[ ]-+)\n*$""",
-        file_data,
-        re.VERBOSE,
-    )
-    top_match = re.search(
-        r"""^\n*
-             (
-             //[ ]Copyright[ ](?:\d+|\d+-\d+)[ ]Bloomberg.*\n
-             //[ ]SPDX-License-Identifier:[ ]Apache-2.0.*\n
-             (?://[ ].*\n|//\n)+
-             \n?
-             )""",
-        file_data,
-        re.VERBOSE,
-    )
+    expansion_filename = get_expansion_filename(output_filename)
 
-    if bottom_match:
-        bottom_copyright = bottom_match.group(1)
-        params.debug_print(f"Copyright (bottom of file) is now\n{bottom_copyright}")
-    elif top_match:
-        top_copyright = top_match.group(1)
-        params.debug_print(f"Copyright (top of file) is now\n{top_copyright}")
+    # Skip the transformations if the stamp of the C++03 file shows that it
+    # was generated from this very master file (which is then unchanged as
+    # well), or if the output for this input is cached.
+    use_digest = not params.self_test and not params.force
+    in_digest = input_digest(params, command_line, output_filename, file_data)
+    if (
+        use_digest
+        and not params.inplace
+        and output_filename == input_filename
+        and expansion_is_current(params, expansion_filename, in_digest)
+    ):
+        params.trace("processFile", "%s is up to date. No file written.", expansion_filename)
+        return 0
+
+    master, expansion = cache_load(params, in_digest) if use_digest else (None, None)
+
+    if master is None:
+        # Check for copyright block
+        bottom_match = re.search(
+            r"""(\n?
+                 //[ ]--+\n
+                 //[ ]Copyright[ ]\d+[ ]Bloomberg.*\n
+                 (?://[ ].*\n|//\n)+
+                 //[ ]-+[ ]END-OF-FILE[ ]-+)\n*$""",
+            file_data,
+            re.VERBOSE,
+        )
+        top_match = re.search(
+            r"""^\n*
+                 (
+                 //[ ]Copyright[ ](?:\d+|\d+-\d+)[ ]Bloomberg.*\n
+                 //[ ]SPDX-License-Identifier:[ ]Apache-2.0.*\n
+                 (?://[ ].*\n|//\n)+
+                 \n?
+                 )""",
+            file_data,
+            re.VERBOSE,
+        )
+
+        if bottom_match:
+            ctx.bottom_copyright = bottom_match.group(1)
+            params.debug_print(f"Copyright (bottom of file) is now\n{ctx.bottom_copyright}")
+        elif top_match:
+            ctx.top_copyright = top_match.group(1)
+            params.debug_print(f"Copyright (top of file) is now\n{ctx.top_copyright}")
+        else:
+            fatal("No recognizable copyright block")
+
+        # Find the cut points of the file
+        prologue, unexpanded_code, epilogue, includes_bsl_compilerfeatures = segment_filedata(
+            params, file_data
+        )
+
+        # Generate the main file
+        output = transform_file(params, ctx, command_line, unexpanded_code, True)
+
+        if not output:
+            # There were no expansions in the code
+            master = prologue + unexpanded_code + epilogue
+        elif params.inplace:
+            master = prologue + output + epilogue
+        else:
+            # Write main file with boilerplate
+            boiler_beg, boiler_end = filename_to_boilerplate(
+                params, ctx, command_line, output_filename
+            )
+
+            if not includes_bsl_compilerfeatures:
+                prologue += "#include <bsls_compilerfeatures.h>\n\n"
+
+            master = prologue + boiler_beg + output + boiler_end + epilogue
+
+        master_data = write_master(params, input_filename, output_filename, file_data, master)
+
+        if not params.inplace:
+            # Generate expansion output file
+            if output:
+                output = transform_file(params, ctx, command_line, output, False)
+            else:
+                output = "// No C++03 Expansion\n"
+
+            boiler_beg, boiler_end = filename_to_boilerplate(
+                params, ctx, command_line, expansion_filename
+            )
+            expansion = boiler_beg + output + boiler_end
+
+        if use_digest:
+            cache_store(params, in_digest, master, expansion)
     else:
-        fatal("No recognizable copyright block")
+        master_data = write_master(params, input_filename, output_filename, file_data, master)
 
-    # Find the cut points of the file
-    prologue, unexpanded_code, epilogue, includes_bsl_compilerfeatures = segment_filedata(
-        params, file_data
-    )
+    if expansion is not None:
+        expansion_data = write_expansion(params, expansion_filename, expansion)
 
-    # Generate the main file
-    output = transform_file(params, command_line, unexpanded_code, True)
+        # Record the digest of the master file as left by this run, so that
+        # the next run finds the C++03 file up to date.
+        if use_digest and output_filename == input_filename:
+            stamp_store(
+                params,
+                expansion_filename,
+                input_digest(params, command_line, output_filename, master_data),
+                expansion_data,
+            )
 
-    if not output:
-        # There were no expansions in the code
-        write_master(
-            params,
-            input_filename,
-            output_filename,
-            file_data,
-            prologue + unexpanded_code + epilogue,
+    return 0
+
+
+# ============================================================================
+#                        VARIADIC ARITY ANALYSIS
+# ============================================================================
+
+# '--suggest-var-args' finds the variadic templates of the simulation regions
+# of the input files, counts the arguments with which each of them is used in
+# a corpus of source files, and proposes the smallest '$var-args' and
+# '$local-var-args' limits covering those uses.  Each repetition that is not
+# generated shrinks the C++03 code quadratically.
+
+# Sections generated by '--inplace' (which are not uses written by hand)
+GENERATED_CODE_RE = re.compile(
+    r"// \{\{\{ BEGIN GENERATED CODE.*?// \}\}\} END GENERATED CODE", re.DOTALL
+)
+
+# Name of a function template, at the '(' of its parameter list
+FUNCTION_NAME_RE = re.compile(
+    r"\b(operator\b\s*(?:\(\s*\)|[^\s\w(]+|[\w\s:*&<>]*?)|~?[A-Za-z_]\w*)\s*\("
+)
+
+# Identifiers followed by '(' that are not the name of a function
+NOT_FUNCTION_NAMES = {
+    "decltype",
+    "sizeof",
+    "noexcept",
+    "alignof",
+    "alignas",
+    "throw",
+    "__attribute__",
+    "__declspec",
+}
+
+# Arity of a use forwarding the pack of a template whose limit is unknown
+ARITY_UNKNOWN = 1 << 30
+
+
+class ArityTemplate:
+    """A variadic template of a simulation region, and its uses.
+
+    A use with ``n`` arguments (template arguments of a class template,
+    function arguments of a function template) needs ``n - required``
+    repetitions of the pack, ``required`` being the number of parameters
+    other than the pack that have no default.  ``need`` is the largest number
+    of repetitions needed so far.  ``owner`` is the class qualifying an
+    out-of-line member definition, whose pack is that of the class.  If
+    ``reason`` is set, the uses of the template cannot be counted and the
+    limit of its region is kept.
+    """
+
+    def __init__(
+        self,
+        region: "ArityRegion",
+        name: str,
+        is_class: bool,
+        required: int,
+        begin: int,
+        name_pos: int,
+        end: int,
+        owner: str = "",
+        reason: str = "",
+    ) -> None:
+        self.region = region
+        self.name = name
+        self.is_class = is_class
+        self.required = required
+        self.begin = begin  # Extent of the template in the file
+        self.name_pos = name_pos
+        self.end = end
+        self.owner = owner
+        self.reason = reason
+        self.need = region.limit if reason else 0
+        self.uses = 0
+        self.forwarded = 0  # Uses expanding a pack
+        self.unknown = 0  # Uses expanding a pack not of a simulated template
+        self.max_arity = 0  # Largest use, possibly above the limit
+
+
+class ArityRegion:
+    """A simulation region of a file analyzed by '--suggest-var-args'."""
+
+    def __init__(self, filename: str, index: int, pp_start: int, pp_end: int, limit: int) -> None:
+        self.filename = filename
+        self.letter = chr(ord("A") + index)
+        self.pp_start = pp_start  # Extent of the '#if' line in the file
+        self.pp_end = pp_end
+        self.limit = limit
+        self.templates: List[ArityTemplate] = []
+
+    def proposal(self) -> int:
+        """Return the smallest limit covering the uses of the templates."""
+        return max([1] + [min(t.need, self.limit) for t in self.templates])
+
+
+def split_arguments(start: int, end: int) -> List[str]:
+    """Return the comma-separated arguments between ``start`` and ``end`` in
+    the current (shrouded) input, skipping over nested brackets."""
+    shrouded = input_buffer.shrouded
+    match = input_buffer.brackets(True).match
+    args = []
+    arg_start = pos = start
+    while pos < end:
+        char = shrouded[pos]
+        if char in MATCHING_BRACKETS and match.get(pos, -1) > pos:
+            pos = match[pos]
+            continue
+        if char == ",":
+            args.append(shrouded[arg_start:pos].strip())
+            arg_start = pos + 1
+        pos += 1
+    last = shrouded[arg_start:end].strip()
+    if args or last:
+        args.append(last)
+    return args
+
+
+def describe_variadic_template(
+    params: Params,
+    ctx: FileContext,
+    region: ArityRegion,
+    offset: int,
+    template_begin: int,
+    template_head_end: int,
+    template_end: int,
+    is_class: bool,
+) -> Optional[ArityTemplate]:
+    """Return the description of the variadic template at the specified
+    positions of the current input, which starts at ``offset`` in its file,
+    or ``None`` if it declares neither a class nor a function."""
+    shrouded = input_buffer.shrouded
+    match = input_buffer.brackets(True).match
+
+    def make(name: str, name_pos: int, required: int, owner: str = "", reason: str = ""):
+        return ArityTemplate(
+            region,
+            name,
+            is_class,
+            required,
+            offset + template_begin,
+            offset + name_pos,
+            offset + template_end,
+            owner,
+            reason,
         )
-    elif params.inplace:
-        write_master(
-            params, input_filename, output_filename, file_data, prologue + output + epilogue
+
+    if is_class:
+        found = re.compile(r"\s*(?:class|struct|union)\s*([A-Za-z_]\w*)\b\s*(<)?").match(
+            shrouded, template_head_end
         )
-    else:
-        # Write main file with boilerplate
-        boiler_beg, boiler_end = filename_to_boilerplate(params, command_line, output_filename)
+        if not found:
+            return None
+        required = sum(
+            1
+            for param in get_template_params(params, ctx, template_begin)
+            if "..." not in param[0] and not param[2]
+        )
+        return make(
+            found.group(1),
+            found.start(1),
+            required,
+            reason="partial specialization" if found.group(2) else "",
+        )
+
+    pos = template_head_end
+    while True:
+        found = FUNCTION_NAME_RE.search(shrouded, pos, template_end)
+        if not found:
+            return None
+        paren = found.end() - 1
+        close = match.get(paren, -1)
+        if close < 0:
+            return None
+        name = found.group(1)
+        if name not in NOT_FUNCTION_NAMES and not re.fullmatch(r"[A-Z][A-Z0-9_]*", name):
+            break
+        pos = close
 
-        if not includes_bsl_compilerfeatures:
-            prologue += "#include <bsls_compilerfeatures.h>\n\n"
+    args = split_arguments(paren + 1, close - 1)
+    if args == ["void"]:
+        args = []
+    required = sum(1 for arg in args if "..." not in arg and "=" not in arg)
 
-        write_master(
-            params,
-            input_filename,
-            output_filename,
-            file_data,
-            prologue + boiler_beg + output + boiler_end + epilogue,
+    # Class qualifying an out-of-line member definition
+    qualifier = re.search(
+        r"\b([A-Za-z_]\w*)\s*<[^;{}]*>\s*::\s*$", shrouded[template_head_end : found.start(1)]
+    )
+    owner = qualifier.group(1) if qualifier else ""
+
+    reason = ""
+    if name.startswith("operator"):
+        reason = "operator"
+    elif not any("..." in arg for arg in args) and not owner:
+        reason = "pack not deduced from the arguments"
+    return make(name, found.start(1), required, owner, reason)
+
+
+def collect_arity_regions(params: Params, filename: str, text: str) -> List[ArityRegion]:
+    """Return the simulation regions of the specified text, read from the
+    specified file, and their variadic templates."""
+    ctx = FileContext(params, filename)
+    reset_input()
+    set_input(text)
+
+    regions: List[ArityRegion] = []
+    pos = 0
+    while True:
+        if_type = find_sim_cpp11_directive(pos)
+        if not if_type:
+            break
+        pp_start = cpp_match_start[0]
+        pos = cpp_match_end[0]
+        if if_type != "ifndef":
+            continue
+
+        local_max_args, _ = get_args_from_pp_line(params, ctx, cpp_match[0] or "")
+        region = ArityRegion(filename, len(regions), pp_start, pos, local_max_args or ctx.max_args)
+        regions.append(region)
+
+        if not cpp_find_matching_pp_directive(params, pos):
+            fatal(f"Unmatched #if:\n{display_pos(pp_start)}")
+        segment_end = cpp_match_start[0]
+        region_end = cpp_match_end[0]
+        if cpp_match[1] != "endif":
+            cpp_find_matching_pp_directive(params, region_end, "endif")
+            region_end = cpp_match_end[0]
+
+        def record(is_class: bool, offset: int = pos, region: ArityRegion = region):
+            def transform(
+                params, ctx, template_begin, template_head_end, template_end, is_variadic=False
+            ):
+                if is_variadic:
+                    template = describe_variadic_template(
+                        params,
+                        ctx,
+                        region,
+                        offset,
+                        template_begin,
+                        template_head_end,
+                        template_end,
+                        is_class,
+                    )
+                    if template:
+                        region.templates.append(template)
+                return ""
+
+            return transform
+
+        transform_templates(
+            params, ctx, input_buffer.text[pos:segment_end], record(False), record(True)
         )
+        pos = region_end
+
+    reset_input()
+    return regions
+
+
+def read_source(filename: str) -> str:
+    """Return the contents of the specified file with normalized newlines."""
+    with open(filename, "rb") as f:
+        return f.read().decode("latin-1").replace("\r", "")
+
+
+def arity_corpus(params: Params) -> List[str]:
+    """Return the files scanned for uses of the variadic templates: the input
+    files, and the files of '--usage-file-list' and '--compile-db' (the
+    sources and the header of their component) or, if there are none, the
+    other sources in the directories of the input files."""
+    files = list(params.files)
+    for filename in params.usage_files:
+        files.append(filename)
+
+    if params.compile_db:
+        try:
+            with open(params.compile_db, "r", encoding="utf-8") as f:
+                entries = json.load(f)
+        except (OSError, ValueError) as e:
+            fatal(f"Cannot read compilation database {params.compile_db}: {e}")
+        for entry in entries:
+            source = os.path.join(entry.get("directory", ""), entry["file"])
+            files.append(source)
+            header = re.sub(r"(\.[gtux])?\.(cpp|cc|cxx|c)$", ".h", source)
+            if header != source and os.path.isfile(header):
+                files.append(header)
+
+    if not params.usage_files and not params.compile_db:
+        for directory in sorted({os.path.dirname(f) or "." for f in params.files}):
+            for entry in sorted(os.listdir(directory)):
+                if re.search(r"\.(h|hpp|cpp|cc|cxx)$", entry):
+                    files.append(os.path.join(directory, entry))
+
+    corpus: List[str] = []
+    seen = set()
+    for filename in files:
+        real = os.path.realpath(filename)
+        if real not in seen and not re.search(r"_cpp03(\.[^./]*)?$", filename):
+            seen.add(real)
+            corpus.append(filename)
+    return corpus
+
+
+def scan_arity_uses(
+    text: str, names_re: "re.Pattern[str]", templates: List[ArityTemplate]
+) -> List[Tuple[str, bool, int, int, Optional[ArityTemplate]]]:
+    """Return the uses, in the specified text, of the templates named by
+    ``names_re``: the name, whether the use lists template arguments (else
+    function arguments), the number of arguments that are not pack
+    expansions, the number of pack expansions, and the template of the file
+    enclosing the use (whose pack is expanded).  ``templates`` are the
+    templates of the file, whose declarations are not uses."""
+    # Blank out the generated code, keeping the positions
+    text = GENERATED_CODE_RE.sub(lambda m: re.sub(r"[^\n]", " ", m.group(0)), text)
+    set_input(text)
+    shrouded = input_buffer.shrouded
+    match = input_buffer.brackets(True).match
+    heads = [(t.begin, t.name_pos) for t in templates]
+
+    uses = []
+    for found in names_re.finditer(shrouded):
+        name_pos = found.start(1)
+        if any(begin <= name_pos <= head_end for begin, head_end in heads):
+            continue
 
-    if not params.inplace:
-        # Generate expansion output file
-        output_filename = re.sub(r"([^.])(\.[^/\\]*)?$", r"\1_cpp03\2", output_filename)
+        enclosing = None
+        for template in templates:
+            if template.begin <= name_pos < template.end:
+                enclosing = template
+
+        def record(is_class: bool, open_pos: int) -> int:
+            close = match.get(open_pos, -1)
+            if close < 0:
+                return -1
+            args = split_arguments(open_pos + 1, close - 1)
+            packs = sum(1 for arg in args if arg.endswith("..."))
+            uses.append((found.group(1), is_class, len(args) - packs, packs, enclosing))
+            return close
+
+        pos = found.end()
+        if shrouded.startswith("<", pos):
+            pos = record(True, pos)
+            if pos < 0:
+                continue
+            pos = re.compile(r"\s*").match(shrouded, pos).end()
 
-        if output:
-            output = transform_file(params, command_line, output, False)
+        if shrouded.startswith("(", pos):
+            record(False, pos)
         else:
-            output = "// No C++03 Expansion\n"
+            # Declaration of a variable by a constructor
+            declared = re.compile(r"\s*[A-Za-z_]\w*\s*\(").match(shrouded, pos)
+            if declared:
+                record(False, declared.end() - 1)
+
+    reset_input()
+    return uses
+
+
+def rewrite_args_comment(pp_line: str, var_args: int, local_var_args: int) -> str:
+    """Return the specified '#if' line with its '$var-args' and
+    '$local-var-args' options replaced by the specified ones (none if 0), in
+    the order in which 'get_args_from_pp_line' writes them."""
+    line = pp_line.rstrip("\n")
+    compact = re.search(r"/[/*].*\$compact\b", line)
+    line = re.sub(r"\s*\$(?:(?:local-)?var-args=\d+|compact\b)", "", line)
+    options = []
+    if local_var_args:
+        options.append(f"$local-var-args={local_var_args}")
+    if var_args:
+        options.append(f"$var-args={var_args}")
+    if compact:
+        options.append("$compact")
+    if options:
+        line += (" " if "//" in line else " // ") + " ".join(options)
+    return re.sub(r"\s*//\s*$", "", line) + "\n"
+
+
+def suggest_var_args(params: Params) -> int:
+    """Print the limits proposed for the variadic templates of the input
+    files and, with '--inplace', write them into the input files."""
+    sources: Dict[str, str] = {}
+    regions: Dict[str, List[ArityRegion]] = {}
+    ret = 0
+    for filename in arity_corpus(params):
+        try:
+            text = read_source(filename)
+        except OSError as e:
+            print(f"!! Cannot read {filename}: {e.strerror}", file=sys.stderr)
+            ret = 1 if filename in params.files else ret
+            continue
+        sources[filename] = text
+        if SIM_CPP11_MACRO in text:
+            try:
+                regions[filename] = collect_arity_regions(params, filename, text)
+            except SystemExit:
+                print(f"!! Failed to analyze {filename}", file=sys.stderr)
+                ret = 1 if filename in params.files else ret
+
+    templates = [t for file_regions in regions.values() for r in file_regions for t in r.templates]
+    by_name: Dict[Tuple[str, bool], List[ArityTemplate]] = {}
+    for template in templates:
+        by_name.setdefault((template.name, template.is_class), []).append(template)
+
+    uses = []
+    names = sorted({t.name for t in templates if not t.reason or t.is_class}, key=len, reverse=True)
+    if names:
+        names_re = re.compile(r"\b(" + "|".join(re.escape(n) for n in names) + r")\b\s*")
+        for filename, text in sources.items():
+            file_templates = [t for r in regions.get(filename, []) for t in r.templates]
+            uses += scan_arity_uses(text, names_re, file_templates)
+
+    for name, is_class, args, packs, enclosing in uses:
+        for template in by_name.get((name, is_class), []):
+            template.uses += 1
+            template.forwarded += packs > 0
+            template.unknown += packs > 0 and not enclosing
+
+    # Keep the limit of the templates having no uses in the scanned files,
+    # which does not mean they have none (out-of-line members follow their
+    # class)
+    for template in templates:
+        if not template.uses and not template.owner and not template.reason:
+            template.reason = "no uses found"
+            template.need = template.region.limit
+
+    # Propagate the needs through the forwarded packs until they are stable
+    changed = True
+    while changed:
+        changed = False
+        for name, is_class, args, packs, enclosing in uses:
+            arity = args
+            if packs:
+                arity += packs * (enclosing.need if enclosing else ARITY_UNKNOWN)
+            for template in by_name.get((name, is_class), []):
+                need = arity - template.required
+                if template.reason or need < 0:
+                    continue
+                if arity < ARITY_UNKNOWN:
+                    template.max_arity = max(template.max_arity, need)
+                need = min(need, template.region.limit)
+                if need > template.need:
+                    template.need = need
+                    changed = True
+        for template in templates:
+            for owner in by_name.get((template.owner, True), []):
+                need = min(owner.need, template.region.limit)
+                if need > template.need:
+                    template.need = need
+                    changed = True
+
+    for filename in params.files:
+        file_regions = regions.get(filename)
+        if filename not in sources:
+            continue
+        variadic_regions = [r for r in file_regions or [] if r.templates]
+        if not variadic_regions:
+            print(f"{filename}: no variadic templates")
+            continue
+
+        file_limit = max(r.proposal() for r in variadic_regions)
+        explicit = file_limit != params.default_max_args or bool(
+            re.search(r"(?<!local-)\$var-args=", sources[filename])
+        )
+        copies = sum(r.limit + 1 for r in variadic_regions for t in r.templates)
+        new_copies = sum(r.proposal() + 1 for r in variadic_regions for t in r.templates)
+        print(
+            f"{filename}: $var-args={file_limit}"
+            f" (repetitions of the templates: {copies} -> {new_copies})"
+        )
 
-        boiler_beg, boiler_end = filename_to_boilerplate(params, command_line, output_filename)
-        write_expansion(params, output_filename, boiler_beg + output + boiler_end)
+        text = sources[filename]
+        new_text = []
+        pos = 0
+        for index, region in enumerate(file_regions):
+            pp_line = text[region.pp_start : region.pp_end]
+            local_var_args = 0
+            if region.templates:
+                proposal = region.proposal()
+                local_var_args = proposal if proposal < file_limit else 0
+                line = text.count("\n", 0, region.pp_start) + 1
+                print(f"  region {region.letter}, line {line}: limit {region.limit} -> {proposal}")
+                for template in region.templates:
+                    if template.reason:
+                        detail = f"kept: {template.reason}"
+                    else:
+                        detail = f"{template.uses} uses, {template.forwarded} forwarding a pack"
+                        if template.unknown:
+                            detail += f" ({template.unknown} of unknown size)"
+                        if template.max_arity > region.limit:
+                            detail += ", used beyond the limit"
+                    kind = "class" if template.is_class else "function"
+                    print(f"    {template.name:<32} {kind:<8} {template.need:>3}  {detail}")
+            else:
+                found = re.search(r"\$local-var-args=(\d+)", pp_line)
+                local_var_args = int(found.group(1)) if found else 0
 
-    return 0
+            new_line = rewrite_args_comment(
+                pp_line, file_limit if index == 0 and explicit else 0, local_var_args
+            )
+            new_text += [text[pos : region.pp_start], new_line]
+            pos = region.pp_end
+        new_text.append(text[pos:])
+        new_text = "".join(new_text)
+
+        if params.inplace and new_text != text:
+            with open(filename, "w", encoding="latin-1", newline="") as f:
+                f.write(new_text)
+            print(f"  updated {filename}; regenerate its C++03 file")
+
+    return ret
 
 
 # ============================================================================
@@ -3383,19 +4609,299 @@ class Q
 """
 
 
+# ============================================================================
+#                               WATCH MODE
+# ============================================================================
+
+# Files that may contain simulation regions, and directories not watched
+WATCH_SOURCE_RE = re.compile(r"\.(h|hpp|cpp|cc|cxx)$")
+WATCH_SKIPPED_DIR_RE = re.compile(r"^(\..*|_?build.*|__pycache__)$")
+
+# A simulation region, as found by 'find_sim_cpp11_directive'
+SIM_REGION_RE = re.compile(
+    rf"^[ \t]*\#[ \t]*(?:if[ \t]*![ \t]*(?:defined)?\(?[ \t]*\(?|ifndef[ \t]*){SIM_CPP11_MACRO}\b",
+    re.MULTILINE,
+)
+
+# Time to wait for the other events of a save (e.g. an editor writing a
+# temporary file and renaming it) before processing the changed files
+WATCH_SETTLE_TIME = 0.02
+
+
+def is_watched_source(path: str) -> bool:
+    """Return ``True`` if the specified path is a source that may contain
+    simulation regions (and not a generated C++03 file)."""
+    name = os.path.basename(path)
+    return bool(WATCH_SOURCE_RE.search(name)) and not re.search(r"_cpp03(\.[^./]*)?$", name)
+
+
+def walk_watched_dirs(dirs: Tuple[str, ...]) -> Iterator[Tuple[str, List[str]]]:
+    """Yield each directory under the specified directories and the watched
+    sources it contains."""
+    for top in dirs:
+        for dirpath, dirnames, filenames in os.walk(top):
+            dirnames[:] = sorted(d for d in dirnames if not WATCH_SKIPPED_DIR_RE.match(d))
+            yield dirpath, [
+                os.path.join(dirpath, f) for f in sorted(filenames) if is_watched_source(f)
+            ]
+
+
+class PollingWatcher:
+    """Report the watched sources whose size or modification time changed,
+    by scanning the watched directories periodically."""
+
+    def __init__(self, dirs: Tuple[str, ...], interval: float) -> None:
+        self.dirs = dirs
+        self.interval = interval
+        self.stats = self._scan()
+
+    def _scan(self) -> Dict[str, Tuple[int, int]]:
+        stats = {}
+        for _, sources in walk_watched_dirs(self.dirs):
+            for source in sources:
+                try:
+                    st = os.stat(source)
+                except OSError:
+                    continue
+                stats[source] = (st.st_mtime_ns, st.st_size)
+        return stats
+
+    def wait(self) -> List[str]:
+        """Wait for changes and return the changed (or new) sources."""
+        while True:
+            time.sleep(self.interval)
+            stats = self._scan()
+            changed = [path for path, stat in stats.items() if self.stats.get(path) != stat]
+            self.stats = stats
+            if changed:
+                return changed
+
+    def close(self) -> None:
+        pass
+
+
+class InotifyWatcher:
+    """Report the watched sources written or renamed into the watched
+    directories, using the Linux inotify API (through 'ctypes').  The
+    directories are watched recursively, including those created later."""
+
+    IN_CLOSE_WRITE = 0x00000008
+    IN_MOVED_TO = 0x00000080
+    IN_CREATE = 0x00000100
+    IN_Q_OVERFLOW = 0x00004000
+    IN_ONLYDIR = 0x01000000
+    IN_ISDIR = 0x40000000
+    EVENT_HEADER = struct.Struct("iIII")  # wd, mask, cookie, len
+
+    def __init__(self, dirs: Tuple[str, ...]) -> None:
+        self.dirs = dirs
+        self.libc = ctypes.CDLL(ctypes.util.find_library("c"), use_errno=True)
+        self.fd = self.libc.inotify_init1(os.O_CLOEXEC)
+        if self.fd < 0:
+            raise OSError(ctypes.get_errno(), "inotify_init1 failed")
+        self.paths: Dict[int, str] = {}
+        for top in dirs:
+            self._add_tree(top)
+
+    def _add_tree(self, top: str) -> List[str]:
+        """Watch the specified directory and its subdirectories, and return
+        the sources they contain."""
+        found = []
+        for dirpath, sources in walk_watched_dirs((top,)):
+            mask = self.IN_CLOSE_WRITE | self.IN_MOVED_TO | self.IN_CREATE | self.IN_ONLYDIR
+            wd = self.libc.inotify_add_watch(self.fd, os.fsencode(dirpath), mask)
+            if wd < 0:
+                raise OSError(ctypes.get_errno(), f"Cannot watch {dirpath}")
+            self.paths[wd] = dirpath
+            found += sources
+        return found
+
+    def wait(self) -> List[str]:
+        """Wait for changes and return the changed (or new) sources."""
+        changed: List[str] = []
+        timeout = None
+        while True:
+            ready, _, _ = select.select([self.fd], [], [], timeout)
+            if not ready:
+                return changed
+            data = os.read(self.fd, 65536)
+            pos = 0
+            while pos < len(data):
+                wd, mask, _, length = self.EVENT_HEADER.unpack_from(data, pos)
+                pos += self.EVENT_HEADER.size
+                name = os.fsdecode(data[pos : pos + length].rstrip(b"\0"))
+                pos += length
+                if mask & self.IN_Q_OVERFLOW:
+                    # Events were lost: report every source
+                    changed += [s for _, sources in walk_watched_dirs(self.dirs) for s in sources]
+                    continue
+                path = os.path.join(self.paths.get(wd, ""), name)
+                if mask & self.IN_ISDIR:
+                    if not WATCH_SKIPPED_DIR_RE.match(name):
+                        changed += self._add_tree(path)
+                elif mask & (self.IN_CLOSE_WRITE | self.IN_MOVED_TO) and is_watched_source(name):
+                    changed.append(path)
+            if changed:
+                # Collect the other events of the same save
+                timeout = WATCH_SETTLE_TIME
+
+    def close(self) -> None:
+        os.close(self.fd)
+
+
+def read_watched_source(source: str) -> Optional[str]:
+    """Return the contents of the specified source, or ``None`` if it cannot
+    be read (e.g. because it was removed)."""
+    try:
+        with open(source, "rb") as f:
+            return f.read().decode("latin-1")
+    except OSError:
+        return None
+
+
+def regenerate_source(
+    params: Params, source: str, report_current: bool, depth: int = 0
+) -> Optional[str]:
+    """Regenerate the C++03 file of the specified source if it has
+    simulation regions, and return the contents of the source after the
+    regeneration.  Report a C++03 file that is already up to date only if
+    ``report_current`` is true."""
+    data = read_watched_source(source)
+    if data is None or not SIM_REGION_RE.search(data):
+        return data
+
+    expansion_filename = get_expansion_filename(source)
+
+    def stamp() -> Optional[int]:
+        try:
+            return os.stat(expansion_filename).st_mtime_ns
+        except OSError:
+            return None
+
+    before = stamp()
+    start = time.monotonic()
+    ret, out, err = run_job(params, Job(params.get_command_line(source), source, source))
+    elapsed = (time.monotonic() - start) * 1000
+
+    sys.stdout.write(out)
+    sys.stderr.write(err)
+    if ret:
+        print(f"!! Failed to process {source}", file=sys.stderr)
+    elif stamp() != before:
+        print(f"Generated {expansion_filename} ({elapsed:.0f} ms)")
+    elif report_current:
+        print(f"{expansion_filename} is up to date ({elapsed:.0f} ms)")
+    sys.stdout.flush()
+
+    # The source changed during the regeneration, either because it was
+    # rewritten by the regeneration itself or saved again.  Regenerate it
+    # again: in the first case, this leaves the C++03 file untouched.
+    new_data = read_watched_source(source)
+    if new_data is not None and new_data != data and depth < 2:
+        return regenerate_source(params, source, False, depth + 1)
+    return new_data
+
+
+def watch(params: Params) -> int:
+    """Regenerate the C++03 files of the sources of the watched directories
+    when the sources change, until interrupted."""
+    for top in params.watch_dirs:
+        if not os.path.isdir(top):
+            print(f"!! Cannot watch {top}: not a directory", file=sys.stderr)
+            return 1
+
+    watcher: "PollingWatcher | InotifyWatcher"
+    if params.poll_interval or not sys.platform.startswith("linux"):
+        watcher = PollingWatcher(params.watch_dirs, params.poll_interval or 1.0)
+    else:
+        try:
+            watcher = InotifyWatcher(params.watch_dirs)
+        except (OSError, AttributeError) as e:
+            print(f"Cannot use inotify ({e}), polling instead", file=sys.stderr)
+            watcher = PollingWatcher(params.watch_dirs, 1.0)
+
+    # Contents of each source after its last regeneration, so that the
+    # changes made by the regeneration itself are not processed again
+    contents: Dict[str, Optional[str]] = {}
+
+    # Bring the C++03 files up to date (only those whose code changed are
+    # written)
+    for _, sources in walk_watched_dirs(params.watch_dirs):
+        for source in sources:
+            contents[source] = regenerate_source(params, source, False)
+    print(f"Watching {', '.join(params.watch_dirs)} ({type(watcher).__name__})")
+    sys.stdout.flush()
+
+    try:
+        while True:
+            for source in dict.fromkeys(watcher.wait()):
+                data = read_watched_source(source)
+                if data is not None and data != contents.get(source):
+                    contents[source] = regenerate_source(params, source, True)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        watcher.close()
+
+    return 0
+
+
 # ============================================================================
 #                           MAIN PROGRAM
 # ============================================================================
 
+
+def run_job(params: Params, job: Job) -> Tuple[int, str, str]:
+    """Process the specified job in a worker process of ``--jobs``.
+
+    Return the exit status of the job, and the standard output and error it
+    produced, which are captured so that the parent process reports the
+    output of the jobs in order rather than interleaved.
+    """
+    out = io.StringIO()
+    err = io.StringIO()
+    try:
+        with contextlib.redirect_stdout(out), contextlib.redirect_stderr(err):
+            ret = process_file(params, job.command_line, job.input_filename, job.output_filename)
+    except SystemExit as e:
+        ret = e.code if isinstance(e.code, int) else 1
+    except Exception:
+        traceback.print_exc(file=err)
+        ret = 1
+    return ret, out.getvalue(), err.getvalue()
+
+
 def main() -> int:
     """Main program entry point."""
     params = Params()
 
+    if params.suggest_var_args:
+        return suggest_var_args(params)
+
+    if params.watch_dirs:
+        return watch(params)
+
+    jobs = list(params.iter_jobs())
+    if params.jobs <= 1 or len(jobs) <= 1:
+        ret = 0
+        for job in jobs:
+            ret = process_file(params, job.command_line, job.input_filename, job.output_filename)
+            if ret:
+                break
+
+        return ret
+
+    # Files are independent of each other: process them all in a pool of
+    # worker processes, reporting every failure instead of stopping at the
+    # first one.
     ret = 0
-    for job in params.iter_jobs():
-        ret = process_file(params, job.command_line, job.input_filename, job.output_filename)
-        if ret:
-            break
+    with concurrent.futures.ProcessPoolExecutor(max_workers=min(params.jobs, len(jobs))) as pool:
+        for job, (job_ret, out, err) in zip(jobs, pool.map(run_job, [params] * len(jobs), jobs)):
+            sys.stdout.write(out)
+            sys.stderr.write(err)
+            if job_ret:
+                print(f"!! Failed to process {job.input_filename}", file=sys.stderr)
+                ret = 1
 
     return ret
 
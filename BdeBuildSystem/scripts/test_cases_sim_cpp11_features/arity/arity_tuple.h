@@ -0,0 +1,37 @@
+// arity_tuple.h                                                      -*-C++-*-
+#ifndef INCLUDED_ARITY_TUPLE
+#define INCLUDED_ARITY_TUPLE
+
+#include <bsls_compilerfeatures.h>
+
+// Every template is used: the file limit shrinks to the largest use
+#if !BSLS_COMPILERFEATURES_SIMULATE_CPP11_FEATURES // $var-args=10
+
+template <class... ELEMENTS>
+struct Tuple {
+};
+
+template <class... ELEMENTS>
+Tuple<ELEMENTS...> makeTuple(ELEMENTS&&... elements) {
+    return Tuple<ELEMENTS...>();
+}
+
+#endif
+
+#endif
+
+// ----------------------------------------------------------------------------
+// Copyright 2020 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
@@ -0,0 +1,52 @@
+// arity_widget.h                                                     -*-C++-*-
+#ifndef INCLUDED_ARITY_WIDGET
+#define INCLUDED_ARITY_WIDGET
+
+#include <bsls_compilerfeatures.h>
+
+// Variadic templates whose uses are counted by '--suggest-var-args'
+#if !BSLS_COMPILERFEATURES_SIMULATE_CPP11_FEATURES // $var-args=10
+
+template <class T, class... ARGS>
+void construct(T *address, ARGS&&... args) {
+    new (address) T(std::forward<ARGS>(args)...);
+}
+
+template <class... ARGS>
+void emplace(ARGS&&... args) {
+    int value;
+    construct(&value, std::forward<ARGS>(args)...);
+}
+
+template <class... ARGS>
+void neverCalled(ARGS&&... args) {
+    process(std::forward<ARGS>(args)...);
+}
+
+#endif
+
+#if !BSLS_COMPILERFEATURES_SIMULATE_CPP11_FEATURES // $local-var-args=8
+
+template <class... TYPES>
+class Holder {
+};
+
+#endif
+
+#endif
+
+// ----------------------------------------------------------------------------
+// Copyright 2020 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
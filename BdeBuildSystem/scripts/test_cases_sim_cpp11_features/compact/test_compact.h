@@ -0,0 +1,54 @@
+// test_compact.h                                                     -*-C++-*-
+#ifndef INCLUDED_TEST_COMPACT
+#define INCLUDED_TEST_COMPACT
+
+#include <bsls_compilerfeatures.h>
+
+// Repetitions of variadic templates generated as macro invocations by
+// '--compact' (and copied where they cannot be)
+#if !BSLS_COMPILERFEATURES_SIMULATE_CPP11_FEATURES
+
+template <class T, class... ARGS>
+void construct(T *address, ARGS&&... args)
+{
+    new (address) T(std::forward<ARGS>(args)...);
+}
+
+template <class... TYPES>
+class Holder {
+  public:
+    template <class... ARGS>
+    explicit Holder(ARGS&&... args);
+
+    static const int k_SIZE = sizeof...(TYPES);
+};
+
+#endif
+
+#if !BSLS_COMPILERFEATURES_SIMULATE_CPP11_FEATURES // $local-var-args=3
+
+template <class... ARGS>
+int count(const ARGS&... args)
+{
+    return sizeof...(ARGS);
+}
+
+#endif
+
+#endif
+
+// ----------------------------------------------------------------------------
+// Copyright 2020 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
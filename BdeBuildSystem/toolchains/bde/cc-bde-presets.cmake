@@ -131,3 +131,7 @@ endif()
 if(BDE_BUILD_TARGET_FUZZ)
     message(FATAL_ERROR "Fuzzer is not available for cc.")
 endif()
+
+if(BDE_BUILD_TARGET_PGO)
+    message(FATAL_ERROR "Profile-guided optimization is not available for cc.")
+endif()
@@ -60,3 +60,7 @@ else()
            "/EHsc "
            )
 endif()
+
+if(BDE_BUILD_TARGET_PGO)
+    message(FATAL_ERROR "Profile-guided optimization is not available for cl.")
+endif()
@@ -149,3 +149,37 @@ if(BDE_BUILD_TARGET_FUZZ)
            "-static-libubsan "
            )
 endif()
+
+# Profile-guided optimization.  'GENERATE' instruments the code to write one
+# raw profile per process to BDE_BUILD_TARGET_PGO_DIR, 'USE' optimizes the code
+# using the 'default.profdata' profile (merged from the raw profiles by
+# 'llvm-profdata') in that directory.
+if(BDE_BUILD_TARGET_PGO)
+    if (NOT BDE_BUILD_TARGET_PGO_DIR)
+        set(BDE_BUILD_TARGET_PGO_DIR "${CMAKE_BINARY_DIR}/pgo")
+    endif()
+
+    if (BDE_BUILD_TARGET_PGO STREQUAL "GENERATE")
+        set(COMMON_PGO_FLAGS
+            "-fprofile-instr-generate=${BDE_BUILD_TARGET_PGO_DIR}/%p-%m.profraw ")
+    elseif (BDE_BUILD_TARGET_PGO STREQUAL "USE")
+        set(COMMON_PGO_FLAGS
+            "-fprofile-instr-use=${BDE_BUILD_TARGET_PGO_DIR}/default.profdata -Wno-profile-instr-out-of-date -Wno-profile-instr-unprofiled ")
+    else()
+        message(FATAL_ERROR
+                "Invalid BDE_BUILD_TARGET_PGO: '${BDE_BUILD_TARGET_PGO}' (expected GENERATE or USE).")
+    endif()
+
+    string(CONCAT DEFAULT_CXX_FLAGS
+           "${DEFAULT_CXX_FLAGS} "
+           "${COMMON_PGO_FLAGS} "
+           )
+    string(CONCAT DEFAULT_C_FLAGS
+           "${DEFAULT_C_FLAGS} "
+           "${COMMON_PGO_FLAGS} "
+           )
+    string(CONCAT DEFAULT_EXE_LINKER_FLAGS
+           "${DEFAULT_EXE_LINKER_FLAGS} "
+           "${COMMON_PGO_FLAGS} "
+           )
+endif()
@@ -163,3 +163,40 @@ endif()
 if(BDE_BUILD_TARGET_FUZZ)
     message(FATAL_ERROR "Fuzzer is not available for gcc.")
 endif()
+
+# Profile-guided optimization.  'GENERATE' instruments the code to write the
+# profile data to BDE_BUILD_TARGET_PGO_DIR when the executables exit, 'USE'
+# optimizes the code using the profile data in that directory.  The object
+# file names are recorded relative to the build directory, so that a profile
+# generated in one build directory can be used in another one.
+if(BDE_BUILD_TARGET_PGO)
+    if (NOT BDE_BUILD_TARGET_PGO_DIR)
+        set(BDE_BUILD_TARGET_PGO_DIR "${CMAKE_BINARY_DIR}/pgo")
+    endif()
+
+    if (BDE_BUILD_TARGET_PGO STREQUAL "GENERATE")
+        set(COMMON_PGO_FLAGS
+            "-fprofile-generate=${BDE_BUILD_TARGET_PGO_DIR} -fprofile-update=atomic ")
+    elseif (BDE_BUILD_TARGET_PGO STREQUAL "USE")
+        set(COMMON_PGO_FLAGS
+            "-fprofile-use=${BDE_BUILD_TARGET_PGO_DIR} -fprofile-partial-training -Wno-missing-profile -Wno-error=coverage-mismatch ")
+    else()
+        message(FATAL_ERROR
+                "Invalid BDE_BUILD_TARGET_PGO: '${BDE_BUILD_TARGET_PGO}' (expected GENERATE or USE).")
+    endif()
+
+    string(CONCAT DEFAULT_CXX_FLAGS
+           "${DEFAULT_CXX_FLAGS} "
+           "${COMMON_PGO_FLAGS} "
+           "-fprofile-prefix-path=${CMAKE_BINARY_DIR} "
+           )
+    string(CONCAT DEFAULT_C_FLAGS
+           "${DEFAULT_C_FLAGS} "
+           "${COMMON_PGO_FLAGS} "
+           "-fprofile-prefix-path=${CMAKE_BINARY_DIR} "
+           )
+    string(CONCAT DEFAULT_EXE_LINKER_FLAGS
+           "${DEFAULT_EXE_LINKER_FLAGS} "
+           "${COMMON_PGO_FLAGS} "
+           )
+endif()
@@ -99,3 +99,7 @@ endif()
 if(BDE_BUILD_TARGET_FUZZ)
     message(FATAL_ERROR "Fuzzer is not available for gcc.")
 endif()
+
+if(BDE_BUILD_TARGET_PGO)
+    message(FATAL_ERROR "Profile-guided optimization is not available for this gcc.")
+endif()
@@ -6,7 +6,10 @@ from bbs.ufid.ufid import Ufid
 
 import argparse
 import collections
+import copy
 import errno
+import glob
+import hashlib
 import json
 import os
 import platform
@@ -150,7 +153,7 @@ class Options:
             args.ufid,
             "BDE_CMAKE_UFID",
             "UFID",
-            required="configure" in args.cmd,
+            required="configure" in args.cmd or "pgo" in args.cmd,
         )
 
         self.prefix = replace_path_sep(
@@ -199,6 +202,7 @@ class Options:
         self.compiler = args.compiler if args.compiler else uplid_comp
         self.test_regex = args.regex
         self.wafstyleout = args.wafstyleout
+        self.profile_configure = args.profile_configure
         self.cpp11_verify_no_change = args.cpp11_verify_no_change
         self.recover_sanitizer = args.recover_sanitizer
         self.dump_cmake_flags = args.dump_cmake_flags
@@ -229,6 +233,10 @@ class Options:
 
         self.component = args.component
 
+        self.pgo_stages = args.pgo_stages
+        self.pgo_training = args.pgo_training
+        self.pgo_regex = args.pgo_regex
+
 
 class Platform:
     MsvcVersion = collections.namedtuple("MsvcVersion", ["year", "version"])
@@ -319,7 +327,7 @@ def wrapper():
                   """
     parser = argparse.ArgumentParser(prog="bbs_build", description=description)
     parser.add_argument(
-        "cmd", nargs="+", choices=["configure", "build", "install"]
+        "cmd", nargs="+", choices=["configure", "build", "install", "pgo"]
     )
 
     parser.add_argument(
@@ -405,6 +413,16 @@ def wrapper():
         "by automated build tools.",
     )
 
+    group.add_argument(
+        "--profile-configure",
+        action="store_true",
+        default=False,
+        help="Report the time spent in the BDE CMake functions during "
+        "configuration (written to bbs_configure_profile.txt and, in the "
+        "Chrome trace format, bbs_configure_profile.json in the build "
+        "directory).",
+    )
+
     group.add_argument(
         "--cpp11-verify-no-change",
         action="store_true",
@@ -519,6 +537,38 @@ def wrapper():
         help="Generate XML report when running tests.",
     )
 
+    group = parser.add_argument_group(
+        "pgo",
+        'Options for the "pgo" command (profile-guided optimization), which '
+        'configures and builds the project instead of the "configure" and '
+        '"build" commands',
+    )
+
+    group.add_argument(
+        "--pgo-stages",
+        type=lambda x: x.split(","),
+        default=PGO_STAGES,
+        help="""Comma-separated list of the stages to run: "generate" (build
+                instrumented), "train" (run the training set) and "use"
+                (merge the profiles and build optimized).  Only "use" needs
+                repeating when the sources change (default: all stages).
+             """,
+    )
+
+    group.add_argument(
+        "--pgo-training",
+        choices=["tests", "benchmarks"],
+        default="tests",
+        help="Run the test drivers or the benchmark drivers as the training "
+        "set (default: tests).",
+    )
+
+    group.add_argument(
+        "--pgo-regex",
+        help="Regular expression selecting the test or benchmark drivers of "
+        "the training set (default: all).",
+    )
+
     group = parser.add_argument_group(
         "install", 'Options for the "install" command'
     )
@@ -546,6 +596,16 @@ def wrapper():
         )
     options = Options(args)
 
+    if "pgo" in args.cmd:
+        if "configure" in args.cmd or "build" in args.cmd:
+            raise RuntimeError(
+                "'pgo' cannot be combined with 'configure' or 'build'"
+            )
+        for stage in options.pgo_stages:
+            if stage not in PGO_STAGES:
+                raise RuntimeError(f"Invalid pgo stage: '{stage}'")
+        pgo(options)
+
     if "configure" in args.cmd:
         configure(options)
     elif options.cpp11_verify_no_change:
@@ -638,6 +698,12 @@ def ufid_to_cmake_flags(ufid_str):
     if ufid.is_set("fuzz"):
         cmake_flags.append("-DBDE_BUILD_TARGET_FUZZ=1")
 
+    if ufid.is_set("lto"):
+        cmake_flags.append("-DBDE_BUILD_TARGET_LTO=FULL")
+
+    if ufid.is_set("thinlto"):
+        cmake_flags.append("-DBDE_BUILD_TARGET_LTO=THIN")
+
     if ufid.is_set("aopt"):
         cmake_flags.append("-DBDE_BUILD_TARGET_ASSERT_LEVEL=AOPT")
     if ufid.is_set("adbg"):
@@ -698,6 +764,8 @@ def configure(options):
         "-DCMAKE_EXPORT_COMPILE_COMMANDS=ON",
         "-DBBS_BUILD_SYSTEM=ON",
         "-DBBS_USE_WAFSTYLEOUT=" + ("ON" if options.wafstyleout else "OFF"),
+        "-DBBS_PROFILE_CONFIGURE="
+        + ("ON" if options.profile_configure else "OFF"),
         "-DBBS_CPP11_VERIFY_NO_CHANGE="
         + ("ON" if options.cpp11_verify_no_change else "OFF"),
         "-DCMAKE_INSTALL_PREFIX=" + options.prefix,
@@ -783,6 +851,7 @@ class CacheInfo:
         self.generator = None
         self.multiconfig = False
         self.build_type = None
+        self.cxx_compiler = None
 
         cacheFileName = os.path.join(build_dir, "CMakeCache.txt")
         if not os.path.isfile(cacheFileName):
@@ -801,6 +870,8 @@ class CacheInfo:
                 self.multiconfig = True
             elif line.startswith("CMAKE_BUILD_TYPE:"):
                 self.build_type = line.strip().split("=")[1]
+            elif line.startswith("CMAKE_CXX_COMPILER:"):
+                self.cxx_compiler = line.strip().split("=", 1)[1]
 
 
 def build_targets(target_list, build_dir, extra_args, environ):
@@ -996,6 +1067,192 @@ def build(options):
                 raise
 
 
+PGO_STAGES = ["generate", "train", "use"]
+
+
+class PgoLayout:
+    """Directories of the profile-guided optimization stages, all of which
+    are kept in the 'pgo' directory of the build directory."""
+
+    def __init__(self, build_dir):
+        self.root = os.path.abspath(os.path.join(build_dir, "pgo"))
+        self.instrumented = os.path.join(self.root, "instrumented")
+        self.raw = os.path.join(self.root, "raw")
+        self.profile = os.path.join(self.root, "profile")
+        self.used_hash = os.path.join(self.root, "used_profile.sha1")
+
+
+def pgo_options(options, build_dir, stage, profile_dir):
+    """
+    Return a copy of the specified 'options' configuring the specified
+    'build_dir' for the specified PGO 'stage' ("GENERATE" or "USE") with the
+    specified 'profile_dir'.
+    """
+    rv = copy.copy(options)
+    rv.build_dir = build_dir
+    pgo_flags = [
+        "-DBDE_BUILD_TARGET_PGO=" + stage,
+        "-DBDE_BUILD_TARGET_PGO_DIR:PATH=" + replace_path_sep(profile_dir),
+    ]
+    rv.cmake_flags = ",".join(
+        ([options.cmake_flags] if options.cmake_flags else []) + pgo_flags
+    )
+    return rv
+
+
+def find_llvm_profdata(cache_info):
+    """
+    Return the path to 'llvm-profdata', looked up in the 'LLVM_PROFDATA'
+    environment variable, next to the compiler, and in the 'PATH'.
+    """
+    if os.getenv("LLVM_PROFDATA"):
+        return os.getenv("LLVM_PROFDATA")
+
+    if cache_info.cxx_compiler:
+        compiler = os.path.realpath(cache_info.cxx_compiler)
+        name = os.path.basename(compiler)
+        suffix = name[name.rfind("-") :] if "-" in name else ""
+        for candidate in ["llvm-profdata" + suffix, "llvm-profdata"]:
+            path = os.path.join(os.path.dirname(compiler), candidate)
+            if os.path.isfile(path):
+                return path
+            path = shutil.which(candidate)
+            if path:
+                return path
+
+    path = shutil.which("llvm-profdata")
+    if not path:
+        raise RuntimeError(
+            "Cannot find llvm-profdata (set LLVM_PROFDATA to its path)"
+        )
+    return path
+
+
+def merge_profiles(layout):
+    """
+    Merge the raw profiles of the training run into the profile directory
+    and return the hash of the merged profile.  The 'llvm-profdata' merges the
+    per-process raw profiles of clang.  gcc merges the counters of all the
+    processes into one '.gcda' file per object file, which are copied.
+    """
+    if os.path.isdir(layout.profile):
+        shutil.rmtree(layout.profile)
+
+    raw_profiles = sorted(glob.glob(os.path.join(layout.raw, "*.profraw")))
+    if raw_profiles:
+        os.makedirs(layout.profile)
+        merge_cmd = [
+            find_llvm_profdata(CacheInfo(layout.instrumented)),
+            "merge",
+            "-o",
+            os.path.join(layout.profile, "default.profdata"),
+        ] + raw_profiles
+        print("Merge cmd:")
+        print(" ".join(merge_cmd[:4]) + f" <{len(raw_profiles)} profiles>")
+        subprocess.check_call(merge_cmd)
+    elif glob.glob(os.path.join(layout.raw, "**", "*.gcda"), recursive=True):
+        shutil.copytree(layout.raw, layout.profile)
+    else:
+        raise RuntimeError(
+            f"No profile data found in {layout.raw} (run the 'train' stage)"
+        )
+
+    digest = hashlib.sha1()
+    for root, dirs, files in sorted(os.walk(layout.profile)):
+        for name in sorted(files):
+            path = os.path.join(root, name)
+            digest.update(os.path.relpath(path, layout.profile).encode())
+            with open(path, "rb") as f:
+                digest.update(f.read())
+    return digest.hexdigest()
+
+
+def pgo(options):
+    """
+    Build with profile-guided optimization in three stages:
+
+    1. 'generate': configure and build an instrumented build in
+       '<build_dir>/pgo/instrumented'.
+    2. 'train': run the training set (test or benchmark drivers) of the
+       instrumented build, writing the raw profiles to '<build_dir>/pgo/raw'.
+    3. 'use': merge the raw profiles into '<build_dir>/pgo/profile' and
+       configure and build '<build_dir>' optimized with that profile.
+
+    The outputs of the stages are kept, so that only the 'use' stage needs
+    repeating when the sources change.
+    """
+    layout = PgoLayout(options.build_dir)
+
+    if "generate" in options.pgo_stages:
+        instr_options = pgo_options(
+            options, layout.instrumented, "GENERATE", layout.raw
+        )
+        if options.pgo_regex:
+            instr_options.test_regex = options.pgo_regex
+        configure(instr_options)
+
+        if options.pgo_training == "benchmarks":
+            instr_options.targets = ["all", "all.b"]
+            instr_options.tests = None
+        else:
+            instr_options.targets = None
+            instr_options.tests = "build"
+        instr_options.dependers_of = None
+        build(instr_options)
+
+    if "train" in options.pgo_stages:
+        cache_info = CacheInfo(layout.instrumented)
+
+        # Profiles of an earlier training run would be merged with this one.
+        if os.path.isdir(layout.raw):
+            shutil.rmtree(layout.raw)
+        os.makedirs(layout.raw)
+
+        train_cmd = [
+            "ctest",
+            "--no-label-summary",
+            Platform.ctest_jobs_arg(options),
+            "-L" if options.pgo_training == "benchmarks" else "-LE",
+            "benchmark",
+        ]
+        if cache_info.multiconfig:
+            train_cmd += ["-C", buildType(options, cache_info)]
+        if options.timeout > 0:
+            train_cmd += ["--timeout", str(options.timeout)]
+        if options.pgo_regex:
+            train_cmd += ["-R", options.pgo_regex]
+
+        print("Training cmd:")
+        print(" ".join(train_cmd))
+        if subprocess.call(train_cmd, cwd=layout.instrumented) != 0:
+            # The profile of a failing driver is still representative.
+            print("Warning: some drivers of the training set failed")
+
+    if "use" in options.pgo_stages:
+        profile_hash = merge_profiles(layout)
+
+        use_options = pgo_options(
+            options, options.build_dir, "USE", layout.profile
+        )
+        # Cleaning the build directory would remove the earlier stages.
+        use_options.clean = False
+        configure(use_options)
+
+        # The build system does not track the profile, so the objects built
+        # with an earlier profile are removed.
+        used_hash = None
+        if os.path.isfile(layout.used_hash):
+            with open(layout.used_hash) as f:
+                used_hash = f.read().strip()
+        if used_hash and used_hash != profile_hash:
+            print("The profile changed, rebuilding everything")
+            build_targets(["clean"], options.build_dir, [], os.environ)
+
+        build(use_options)
+        with open(layout.used_hash, "w") as f:
+            f.write(profile_hash + "\n")
+
+
 def install(options):
     """Install"""
     if not options.install_dir:
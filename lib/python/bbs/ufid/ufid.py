@@ -48,6 +48,11 @@ class Ufid():
         "tsan": (MIDDLE + 32, "Enable thread sanitizer"),
         "ubsan": (MIDDLE + 33, "Enable undefined behavior sanitizer"),
         "fuzz": (MIDDLE + 34, "Enable fuzz testing"),
+        "lto": (MIDDLE + 40, "Enable link-time optimization"),
+        "thinlto": (
+            MIDDLE + 41,
+            "Enable thin (incremental) link-time optimization",
+        ),
         "stlport": (BACK + 0, "Build with STLPort on Sun"),
         "pic": (BACK + 1, "Build static PIC libraries"),
         "cpp03": (BACK + 10, "Build with support for C++03 features"),
@@ -80,6 +85,9 @@ class Ufid():
         if len(self.flags.intersection({ "cpp03", "cpp11", "cpp14", "cpp17", "cpp20", "cpp23", "cpp26"})) > 1:
             raise blderror.InvalidUfidError("Multiple cpp standards in ufid")
 
+        if len(self.flags.intersection({ "lto", "thinlto"})) > 1:
+            raise blderror.InvalidUfidError("Multiple LTO modes in ufid")
+
     @classmethod
     def from_str(cls, config_str):
         flags = []
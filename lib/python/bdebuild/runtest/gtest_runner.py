@@ -0,0 +1,383 @@
+import os
+import shutil
+import subprocess
+import tempfile
+import threading
+import time
+import xml.etree.ElementTree as ET
+
+try:
+    import queue
+except ImportError:
+    import Queue as queue
+
+
+def list_tests(cmd_prefix, test_path, timeout):
+    """Return the names of the enabled tests of a gtest driver.
+
+    Args:
+        cmd_prefix (list): Command (e.g. valgrind) to prefix the driver with.
+        test_path (str): Path to the gtest driver.
+        timeout (int): Timeout in seconds.
+
+    Returns:
+        A list of full test names ("Suite.Test") in the order reported by
+        ``--gtest_list_tests``.
+    """
+    out = subprocess.check_output(
+        cmd_prefix + [test_path, "--gtest_list_tests"],
+        stderr=subprocess.STDOUT,
+        timeout=timeout,
+        universal_newlines=True,
+    )
+
+    # The output looks like:
+    #
+    #   Suite.
+    #     Test1
+    #     Test2  # GetParam() = 1
+    #   Instance/TypedSuite/0.  # TypeParam = int
+    #     Test1
+    names = []
+    suite = None
+    for line in out.splitlines():
+        if not line.strip():
+            continue
+        name = line.split("#", 1)[0].strip()
+        if not line.startswith(" "):
+            suite = name if name.endswith(".") else None
+        elif suite:
+            if "DISABLED_" not in suite and not name.startswith("DISABLED_"):
+                names.append(suite + name)
+    return names
+
+
+# Maximum length of the '--gtest_filter' of a batch, well below the command line
+# length limit of Windows.
+MAX_FILTER_LENGTH = 8000
+
+# Number of batches per job when the batch size is not specified, so that a
+# slow batch can be balanced by the other jobs.
+BATCHES_PER_JOB = 4
+
+
+def make_batches(names, num_jobs, batch_size):
+    """Split the tests of a gtest driver into batches run by one process each.
+
+    Args:
+        names (list): Full names of the tests, in the order of the driver.
+        num_jobs (int): Number of jobs running the batches.
+        batch_size (int): Maximum number of tests in a batch, or 0 to make
+            about ``BATCHES_PER_JOB`` batches per job.
+
+    Returns:
+        A list of lists of consecutive test names, so that the tests of a
+        suite mostly share the setup of their fixture.  The ``--gtest_filter``
+        of a batch is at most ``MAX_FILTER_LENGTH`` characters long.
+    """
+    if batch_size <= 0:
+        num_batches = max(num_jobs, 1) * BATCHES_PER_JOB
+        batch_size = max((len(names) + num_batches - 1) // num_batches, 1)
+
+    batches = []
+    batch = []
+    length = 0
+    for name in names:
+        if batch and (
+            len(batch) >= batch_size
+            or length + len(name) + 1 > MAX_FILTER_LENGTH
+        ):
+            batches.append(batch)
+            batch = []
+            length = 0
+        batch.append(name)
+        length += len(name) + 1
+    if batch:
+        batches.append(batch)
+    return batches
+
+
+class _Status(object):
+    """Status of the gtest run, shared by the worker threads.
+
+    Attributes:
+        is_success (bool): Whether all tests have passed.
+        is_done (bool): True when the run has been terminated.
+    """
+
+    def __init__(self, batches):
+        self._queue = queue.Queue()
+        for index, batch in enumerate(batches):
+            self._queue.put((index, batch))
+        self.is_success = True
+        self.is_done = False
+
+    def next_test(self):
+        """Return the next '(index, batch)' to run or None if there is
+        none."""
+        if self.is_done:
+            return None
+        try:
+            return self._queue.get_nowait()
+        except queue.Empty:
+            return None
+
+    def set_failure(self):
+        self.is_success = False
+
+
+class _Worker(threading.Thread):
+    """Worker thread running one batch of tests at a time using
+    ``--gtest_filter``."""
+
+    def __init__(self, ctx, status, xml_dir, deadline):
+        """Initialize a worker.
+
+        Args:
+            ctx (Context): Runner context.
+            status (_Status): Runner status.
+            xml_dir (str): Directory for the XML output of each test.
+            deadline (float): Time at which the run times out.
+        """
+        threading.Thread.__init__(self)
+        self._ctx = ctx
+        self._status = status
+        self._xml_dir = xml_dir
+        self._deadline = deadline
+        self._proc = None
+
+    def run(self):
+        options = self._ctx.options
+        while True:
+            test = self._status.next_test()
+            if test is None:
+                return
+            index, batch = test
+            if len(batch) == 1:
+                name = batch[0]
+            else:
+                name = "%s (+%d)" % (batch[0], len(batch) - 1)
+
+            xml_path = os.path.join(self._xml_dir, "%05d.xml" % index)
+            cmd = _cmd_prefix(options) + [
+                options.test_path,
+                "--gtest_filter=" + ":".join(batch),
+                "--gtest_output=xml:" + xml_path,
+            ]
+
+            self._ctx.log.debug("TEST %s: START" % name)
+            start = time.time()
+            try:
+                self._proc = subprocess.Popen(
+                    cmd,
+                    stdout=subprocess.PIPE,
+                    stderr=subprocess.STDOUT,
+                    universal_newlines=True,
+                )
+                out, _ = self._proc.communicate(
+                    timeout=max(self._deadline - start, 0)
+                )
+                rc = self._proc.returncode
+            except subprocess.TimeoutExpired:
+                self._proc.kill()
+                self._proc.communicate()
+                self._status.set_failure()
+                self._status.is_done = True
+                self._ctx.log.info(
+                    "TEST %s: TIMEOUT (after %ds)" % (name, options.timeout)
+                )
+                return
+            except Exception as e:
+                self._status.set_failure()
+                self._ctx.log.info("TEST %s: PYTHON EXCEPTION (%s)" % (name, e))
+                return
+
+            elapsed = time.time() - start
+            if rc == 0:
+                if options.is_verbose and not options.log_errors_only:
+                    self._ctx.log.info(
+                        "TEST %s: SUCCESS (%.3fs)\n%s" % (name, elapsed, out)
+                    )
+                else:
+                    self._ctx.log.info("TEST %s: SUCCESS" % name)
+            else:
+                self._status.set_failure()
+                self._ctx.log.info(
+                    "TEST %s: FAILURE (rc %s)\n%s" % (name, rc, out)
+                )
+
+
+def _cmd_prefix(options):
+    if not options.valgrind_tool:
+        return []
+
+    cmd = [
+        "valgrind",
+        "--error-exitcode=1",
+        "--tool=%s" % options.valgrind_tool,
+    ]
+    if options.valgrind_tool == "memcheck":
+        cmd += ["--leak-check=full"]
+    return cmd
+
+
+def merge_xml_reports(reports, name):
+    """Merge gtest XML reports into a single ``testsuites`` element.
+
+    Args:
+        reports (list): Pairs of the path to the XML report of a batch and
+            the names of the tests of the batch.  If a report is missing or
+            unreadable (e.g., the batch crashed before writing it) a failed
+            test case is reported for each test of its batch.
+        name (str): Name of the merged report.
+
+    Returns:
+        ElementTree of the merged report.
+    """
+    counters = ("tests", "failures", "disabled", "skipped", "errors")
+    root = ET.Element("testsuites")
+    root.set("name", name)
+    suites = {}
+
+    def get_suite(suite_name):
+        merged = suites.get(suite_name)
+        if merged is None:
+            merged = ET.SubElement(root, "testsuite")
+            merged.set("name", suite_name)
+            for counter in counters:
+                merged.set(counter, "0")
+            merged.set("time", "0")
+            suites[suite_name] = merged
+        return merged
+
+    def add(merged, counter, value):
+        merged.set(counter, str(int(merged.get(counter)) + int(value)))
+
+    for path, batch in reports:
+        try:
+            report = ET.parse(path).getroot()
+        except (OSError, ET.ParseError):
+            report = None
+
+        if report is None:
+            for test_name in batch:
+                suite_name, _, case_name = test_name.rpartition(".")
+                merged = get_suite(suite_name)
+                add(merged, "tests", 1)
+                add(merged, "failures", 1)
+                testcase = ET.SubElement(merged, "testcase")
+                testcase.set("name", case_name)
+                testcase.set("classname", suite_name)
+                testcase.set("time", "0")
+                failure = ET.SubElement(testcase, "failure")
+                failure.set(
+                    "message", "The test process exited without a report"
+                )
+            continue
+
+        for suite in report.findall("testsuite"):
+            merged = get_suite(suite.get("name"))
+            for counter in counters:
+                add(merged, counter, suite.get(counter, "0"))
+            merged.set(
+                "time",
+                "%.3f"
+                % (float(merged.get("time")) + float(suite.get("time", "0"))),
+            )
+            for testcase in suite.findall("testcase"):
+                merged.append(testcase)
+
+    for counter in counters + ("time",):
+        if counter == "time":
+            total = sum(float(s.get("time")) for s in suites.values())
+            root.set("time", "%.3f" % total)
+        else:
+            total = sum(int(s.get(counter)) for s in suites.values())
+            root.set(counter, str(total))
+    return ET.ElementTree(root)
+
+
+class GtestRunner(object):
+    """Run the tests of a googletest driver in parallel.
+
+    The tests are enumerated with ``--gtest_list_tests`` and run in batches of
+    consecutive tests, one process per batch with ``--gtest_filter``, by a
+    pool of worker threads, so that the slow tests of a driver are spread
+    across the workers without paying the process startup for every test.  If
+    a junit file is requested, the XML reports of all the batches are merged
+    into it.
+    """
+
+    def __init__(self, ctx):
+        """Initialize a gtest runner object.
+
+        Args:
+            ctx (Context): Runner context.
+        """
+        self._ctx = ctx
+
+    def start(self):
+        """Run the tests of the driver.
+
+        Returns:
+            True if all tests passed, and False otherwise.
+        """
+        options = self._ctx.options
+        deadline = time.time() + options.timeout
+
+        try:
+            names = list_tests(
+                _cmd_prefix(options), options.test_path, options.timeout
+            )
+        except Exception as e:
+            self._ctx.log.info("FAILED TO LIST TESTS (%s)" % e)
+            return False
+
+        batches = make_batches(
+            names, options.num_jobs, options.gtest_batch_size
+        )
+        self._ctx.log.info(
+            "TEST START (%d tests in %d batches)" % (len(names), len(batches))
+        )
+
+        xml_dir = tempfile.mkdtemp()
+        try:
+            status = _Status(batches)
+            workers = [
+                _Worker(self._ctx, status, xml_dir, deadline)
+                for j in range(max(min(options.num_jobs, len(batches)), 1))
+            ]
+            for worker in workers:
+                worker.start()
+            for worker in workers:
+                worker.join()
+
+            if options.junit_file_path:
+                reports = [
+                    (os.path.join(xml_dir, "%05d.xml" % index), batch)
+                    for index, batch in enumerate(batches)
+                ]
+                merge_xml_reports(reports, options.component_name).write(
+                    options.junit_file_path
+                )
+        finally:
+            shutil.rmtree(xml_dir, ignore_errors=True)
+
+        return status.is_success
+
+
+# -----------------------------------------------------------------------------
+# Copyright 2025 Bloomberg Finance L.P.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ----------------------------- END-OF-FILE -----------------------------------
@@ -13,6 +13,7 @@ from bdebuild.runtest import context
 from bdebuild.runtest import policy
 from bdebuild.runtest import log
 from bdebuild.runtest import runner
+from bdebuild.runtest import gtest_runner
 
 
 def main():
@@ -40,7 +41,10 @@ def main():
 
     ctx = make_context_from_options(options, args)
 
-    test_runner = runner.Runner(ctx)
+    if options.gtest:
+        test_runner = gtest_runner.GtestRunner(ctx)
+    else:
+        test_runner = runner.Runner(ctx)
 
     exit_code = 0
 
@@ -125,6 +129,20 @@ def get_cmdline_options():
         default=None,
         help='(default: "ABI_BITS" environment variable)',
     )
+    parser.add_option(
+        "--gtest",
+        action="store_true",
+        help="the test driver is a googletest driver -- run its tests "
+        "in batches across the jobs and merge their XML reports into the "
+        "junit xml file",
+    )
+    parser.add_option(
+        "--gtest-batch-size",
+        type="int",
+        default=0,
+        help="maximum number of googletest tests run by one process of the "
+        "driver (default: about 4 batches per job)",
+    )
     parser.add_option(
         "--log-errors-only",
         action="store_true",
@@ -160,7 +178,8 @@ def make_context_from_options(options, args):
         valgrind_tool=valgrind_tool,
         filter_host_type=options.filter_host_type,
         filter_abi_bits=options.filter_abi_bits,
-        log_errors_only=options.log_errors_only
+        log_errors_only=options.log_errors_only,
+        gtest_batch_size=options.gtest_batch_size,
     )
     test_logger = log.Log(test_options)
     test_policy = policy.Policy(test_options)
@@ -21,6 +21,8 @@ class Options(object):
         filter_abi_bits (str): Override abi_bits filter for test policy.
         filter_host_type (str): Override host_type filter for test policy.
         log_errors_only(bool): If True, only log test cases that failed.
+        gtest_batch_size (int): Maximum number of googletest tests run by one
+            process of the driver, 0 for the default.
 
     """
 
@@ -40,6 +42,7 @@ class Options(object):
         self.filter_abi_bits = kw["filter_abi_bits"]
         self.filter_host_type = kw["filter_host_type"]
         self.log_errors_only = kw.get("log_errors_only")
+        self.gtest_batch_size = kw.get("gtest_batch_size", 0)
 
 
 # -----------------------------------------------------------------------------